@@ -0,0 +1,481 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "alloyBatch.h"
+#include "brownHamModel.h"
+#include "histogram.h"
+#include "sampling.h"
+#include "common.h"
+
+
+#define	kAlloyBatchMaximumLineLength	(4096)
+
+static const char * const	kAlloySpecificationColumnNames[kAlloySpecificationColumnMax] = {
+					[kAlloySpecificationColumnGammaUniformMin]			= "gammaMin",
+					[kAlloySpecificationColumnGammaUniformMax]			= "gammaMax",
+					[kAlloySpecificationColumnPhiUniformMin]			= "phiMin",
+					[kAlloySpecificationColumnPhiUniformMax]			= "phiMax",
+					[kAlloySpecificationColumnRsFirstGaussianMean]			= "RsMean1",
+					[kAlloySpecificationColumnRsFirstGaussianStandardDeviation]	= "RsStdDev1",
+					[kAlloySpecificationColumnRsSecondGaussianMean]			= "RsMean2",
+					[kAlloySpecificationColumnRsSecondGaussianStandardDeviation]	= "RsStdDev2",
+					[kAlloySpecificationColumnRsFirstGaussianWeight]		= "RsWeight1",
+					[kAlloySpecificationColumnGUniformMin]				= "GMin",
+					[kAlloySpecificationColumnGUniformMax]				= "GMax",
+					[kAlloySpecificationColumnB]					= "b",
+					[kAlloySpecificationColumnMUniformMin]				= "MMin",
+					[kAlloySpecificationColumnMUniformMax]				= "MMax",
+				};
+
+/*
+ *	The base samples shared by all specifications: one uniform per uniform input,
+ *	and a component-selection uniform plus a standard normal for `Rs`.
+ */
+typedef enum
+{
+	kAlloyBaseSampleGamma	= 0,
+	kAlloyBaseSamplePhi,
+	kAlloyBaseSampleRsComponent,
+	kAlloyBaseSampleRsNormal,
+	kAlloyBaseSampleG,
+	kAlloyBaseSampleM,
+	kAlloyBaseSampleMax,
+} AlloyBaseSample;
+
+/*
+ *	The (min, max) columns of the uniform inputs.
+ */
+static const AlloySpecificationColumn	kAlloySpecificationUniformColumns[][2] = {
+						{kAlloySpecificationColumnGammaUniformMin, kAlloySpecificationColumnGammaUniformMax},
+						{kAlloySpecificationColumnPhiUniformMin, kAlloySpecificationColumnPhiUniformMax},
+						{kAlloySpecificationColumnGUniformMin, kAlloySpecificationColumnGUniformMax},
+						{kAlloySpecificationColumnMUniformMin, kAlloySpecificationColumnMUniformMax},
+					};
+
+static void
+trimLineEnding(char *  line)
+{
+	line[strcspn(line, "\r\n")] = '\0';
+
+	return;
+}
+
+static CommonConstantReturnType
+checkAlloySpecificationHeader(char *  line)
+{
+	char *	cursor = line;
+
+	trimLineEnding(line);
+	if (strncmp(cursor, "name,", 5) != 0)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+	cursor += 5;
+
+	for (size_t j = 0; j < kAlloySpecificationColumnMax; j++)
+	{
+		size_t	length = strlen(kAlloySpecificationColumnNames[j]);
+
+		if ((strncmp(cursor, kAlloySpecificationColumnNames[j], length) != 0) ||
+			(cursor[length] != ((j + 1 < kAlloySpecificationColumnMax) ? ',' : '\0')))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		cursor += length + 1;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Check a specification as `-U` checks the distributions it stands for: uniforms
+ *	with min < max, positive standard deviations, a component weight in [0, 1], and
+ *	positive `G` and `b`. Print the first violation.
+ */
+static CommonConstantReturnType
+checkAlloySpecification(const AlloySpecificationTable *  table, size_t row, size_t lineNumber, const char *  path)
+{
+	double * const *	c = table->columns;
+
+	for (size_t k = 0; k < sizeof(kAlloySpecificationUniformColumns) / sizeof(kAlloySpecificationUniformColumns[0]); k++)
+	{
+		AlloySpecificationColumn	minColumn = kAlloySpecificationUniformColumns[k][0];
+		AlloySpecificationColumn	maxColumn = kAlloySpecificationUniformColumns[k][1];
+
+		if (!(c[minColumn][row] < c[maxColumn][row]))
+		{
+			fprintf(stderr, "Error: `%s` must be less than `%s` on line %zu of \"%s\".\n",
+				kAlloySpecificationColumnNames[minColumn], kAlloySpecificationColumnNames[maxColumn], lineNumber, path);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (!(c[kAlloySpecificationColumnRsFirstGaussianStandardDeviation][row] > 0) ||
+		!(c[kAlloySpecificationColumnRsSecondGaussianStandardDeviation][row] > 0))
+	{
+		fprintf(stderr, "Error: `RsStdDev1` and `RsStdDev2` must be positive on line %zu of \"%s\".\n", lineNumber, path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (!(c[kAlloySpecificationColumnRsFirstGaussianWeight][row] >= 0) || !(c[kAlloySpecificationColumnRsFirstGaussianWeight][row] <= 1))
+	{
+		fprintf(stderr, "Error: `RsWeight1` must lie in [0, 1] on line %zu of \"%s\".\n", lineNumber, path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (!(c[kAlloySpecificationColumnGUniformMin][row] > 0) || !(c[kAlloySpecificationColumnB][row] > 0))
+	{
+		fprintf(stderr, "Error: `GMin` and `b` must be positive on line %zu of \"%s\".\n", lineNumber, path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+readAlloySpecificationTableFromCSV(const char *  path, AlloySpecificationTable *  table)
+{
+	FILE *	file = fopen(path, "r");
+	char	line[kAlloyBatchMaximumLineLength];
+	size_t	capacity = 64;
+	size_t	lineNumber = 1;
+
+	memset(table, 0, sizeof(AlloySpecificationTable));
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open alloy specification file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((fgets(line, sizeof(line), file) == NULL) || (checkAlloySpecificationHeader(line) != kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: The header of \"%s\" must be `name", path);
+		for (size_t j = 0; j < kAlloySpecificationColumnMax; j++)
+		{
+			fprintf(stderr, ",%s", kAlloySpecificationColumnNames[j]);
+		}
+		fprintf(stderr, "`.\n");
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	table->names = checkedMalloc(capacity * sizeof(*table->names), __FILE__, __LINE__);
+	for (size_t j = 0; j < kAlloySpecificationColumnMax; j++)
+	{
+		table->columns[j] = (double *) checkedMalloc(capacity * sizeof(double), __FILE__, __LINE__);
+	}
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		size_t	row = table->numberOfSpecifications;
+		char *	cursor = line;
+		size_t	nameLength;
+
+		lineNumber++;
+		trimLineEnding(line);
+		if ((line[0] == '\0') || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		if (row == capacity)
+		{
+			bool	isOutOfMemory;
+
+			capacity *= 2;
+			table->names = realloc(table->names, capacity * sizeof(*table->names));
+			isOutOfMemory = (table->names == NULL);
+			for (size_t j = 0; j < kAlloySpecificationColumnMax; j++)
+			{
+				table->columns[j] = (double *) realloc(table->columns[j], capacity * sizeof(double));
+				isOutOfMemory = isOutOfMemory || (table->columns[j] == NULL);
+			}
+
+			if (isOutOfMemory)
+			{
+				fprintf(stderr, "Error: Out of memory while reading \"%s\".\n", path);
+				fclose(file);
+
+				return kCommonConstantReturnTypeError;
+			}
+		}
+
+		nameLength = strcspn(cursor, ",");
+		if ((cursor[nameLength] != ',') || (nameLength >= kAlloySpecificationMaximumNameLength))
+		{
+			fprintf(stderr, "Error: Malformed alloy specification on line %zu of \"%s\".\n", lineNumber, path);
+			fclose(file);
+
+			return kCommonConstantReturnTypeError;
+		}
+		memcpy(table->names[row], cursor, nameLength);
+		table->names[row][nameLength] = '\0';
+		cursor += nameLength + 1;
+
+		for (size_t j = 0; j < kAlloySpecificationColumnMax; j++)
+		{
+			char *	end;
+			char	expected = (j + 1 < kAlloySpecificationColumnMax) ? ',' : '\0';
+
+			errno = 0;
+			table->columns[j][row] = strtod(cursor, &end);
+			if ((errno != 0) || (end == cursor) || (*end != expected) || !isfinite(table->columns[j][row]))
+			{
+				fprintf(stderr, "Error: Malformed value of `%s` on line %zu of \"%s\".\n", kAlloySpecificationColumnNames[j], lineNumber, path);
+				fclose(file);
+
+				return kCommonConstantReturnTypeError;
+			}
+			cursor = end + 1;
+		}
+
+		if (checkAlloySpecification(table, row, lineNumber, path) != kCommonConstantReturnTypeSuccess)
+		{
+			fclose(file);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		table->numberOfSpecifications++;
+	}
+
+	fclose(file);
+
+	if (table->numberOfSpecifications == 0)
+	{
+		fprintf(stderr, "Error: No alloy specifications in \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+alloySpecificationTableFree(AlloySpecificationTable *  table)
+{
+	free(table->names);
+	for (size_t j = 0; j < kAlloySpecificationColumnMax; j++)
+	{
+		free(table->columns[j]);
+	}
+	memset(table, 0, sizeof(AlloySpecificationTable));
+
+	return;
+}
+
+/*
+ *	Evaluate every specification on sample `i` of the shared base samples. The
+ *	loop runs across specifications, so it vectorizes over the table columns.
+ */
+static void
+evaluateAlloySpecifications(
+	const AlloySpecificationTable *	table,
+	double				baseSamples[kAlloyBaseSampleMax][kInputSampleBlockSize],
+	size_t				i,
+	double *  restrict		outputs)
+{
+	double * const *	c = table->columns;
+	double			uGamma = baseSamples[kAlloyBaseSampleGamma][i];
+	double			uPhi = baseSamples[kAlloyBaseSamplePhi][i];
+	double			uRsComponent = baseSamples[kAlloyBaseSampleRsComponent][i];
+	double			zRs = baseSamples[kAlloyBaseSampleRsNormal][i];
+	double			uG = baseSamples[kAlloyBaseSampleG][i];
+	double			uM = baseSamples[kAlloyBaseSampleM][i];
+
+	#pragma omp simd
+	for (size_t s = 0; s < table->numberOfSpecifications; s++)
+	{
+		double	gamma = c[kAlloySpecificationColumnGammaUniformMin][s] + (c[kAlloySpecificationColumnGammaUniformMax][s] - c[kAlloySpecificationColumnGammaUniformMin][s]) * uGamma;
+		double	phi = c[kAlloySpecificationColumnPhiUniformMin][s] + (c[kAlloySpecificationColumnPhiUniformMax][s] - c[kAlloySpecificationColumnPhiUniformMin][s]) * uPhi;
+		double	RsFirst = c[kAlloySpecificationColumnRsFirstGaussianMean][s] + c[kAlloySpecificationColumnRsFirstGaussianStandardDeviation][s] * zRs;
+		double	RsSecond = c[kAlloySpecificationColumnRsSecondGaussianMean][s] + c[kAlloySpecificationColumnRsSecondGaussianStandardDeviation][s] * zRs;
+		double	Rs = (uRsComponent < c[kAlloySpecificationColumnRsFirstGaussianWeight][s]) ? RsFirst : RsSecond;
+		double	G = c[kAlloySpecificationColumnGUniformMin][s] + (c[kAlloySpecificationColumnGUniformMax][s] - c[kAlloySpecificationColumnGUniformMin][s]) * uG;
+		double	M = c[kAlloySpecificationColumnMUniformMin][s] + (c[kAlloySpecificationColumnMUniformMax][s] - c[kAlloySpecificationColumnMUniformMin][s]) * uM;
+
+		outputs[s] = computeBrownHamModelOutput(gamma, phi, Rs, G, c[kAlloySpecificationColumnB][s], M);
+	}
+
+	return;
+}
+
+static void
+printAlloyBatchTable(
+	const AlloySpecificationTable *	table,
+	const StreamingHistogram *	histograms,
+	FILE *				stream,
+	bool				isCSV)
+{
+	streamingHistogramPrintSummaryHeader(stream, "name", isCSV);
+	for (size_t s = 0; s < table->numberOfSpecifications; s++)
+	{
+		streamingHistogramPrintSummaryRow(stream, table->names[s], &histograms[s], isCSV);
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+runAlloyBatch(const CommandLineArguments *  arguments)
+{
+	AlloySpecificationTable	table;
+	size_t			numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	size_t			numberOfBlocks = (numberOfSamples + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+	size_t			numberOfThreads = 1;
+	size_t			numberOfSpecifications;
+	StreamingHistogram *	histograms;
+	clock_t			start = clock();
+	double			cpuTimeUsedInSeconds;
+
+	if (readAlloySpecificationTableFromCSV(arguments->alloySpecificationsFilePath, &table) != kCommonConstantReturnTypeSuccess)
+	{
+		alloySpecificationTableFree(&table);
+
+		return kCommonConstantReturnTypeError;
+	}
+	numberOfSpecifications = table.numberOfSpecifications;
+
+#ifdef _OPENMP
+	numberOfThreads = (size_t) omp_get_max_threads();
+#endif
+
+	/*
+	 *	One histogram per specification and thread. Thread `t` owns the row
+	 *	starting at `histograms[t * numberOfSpecifications]`.
+	 */
+	histograms = (StreamingHistogram *) checkedMalloc(
+							numberOfThreads * numberOfSpecifications * sizeof(StreamingHistogram),
+							__FILE__,
+							__LINE__);
+	for (size_t i = 0; i < numberOfThreads * numberOfSpecifications; i++)
+	{
+		streamingHistogramInit(&histograms[i]);
+	}
+
+	#pragma omp parallel
+	{
+		size_t				threadIndex = 0;
+		StreamingHistogram *		threadHistograms;
+		double (*			baseSamples)[kInputSampleBlockSize];
+		double *			outputs;
+		SamplerRandomNumberGenerator	generator;
+
+#ifdef _OPENMP
+		threadIndex = (size_t) omp_get_thread_num();
+#endif
+		threadHistograms = &histograms[threadIndex * numberOfSpecifications];
+		baseSamples = checkedMalloc(kAlloyBaseSampleMax * sizeof(*baseSamples), __FILE__, __LINE__);
+		outputs = (double *) checkedMalloc(kInputSampleBlockSize * numberOfSpecifications * sizeof(double), __FILE__, __LINE__);
+
+		#pragma omp for schedule(static)
+		for (size_t blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+		{
+			size_t	first = blockIndex * kInputSampleBlockSize;
+			size_t	count = (numberOfSamples - first < kInputSampleBlockSize) ? (numberOfSamples - first) : kInputSampleBlockSize;
+
+			/*
+			 *	Draw the base samples once, for all specifications.
+			 */
+			samplerRandomNumberGeneratorInit(&generator, arguments->seed, blockIndex);
+			samplerFillUniforms(&generator, baseSamples[kAlloyBaseSampleGamma], count);
+			samplerFillUniforms(&generator, baseSamples[kAlloyBaseSamplePhi], count);
+			samplerFillUniforms(&generator, baseSamples[kAlloyBaseSampleRsComponent], count);
+			samplerFillStandardNormals(&generator, baseSamples[kAlloyBaseSampleRsNormal], count);
+			samplerFillUniforms(&generator, baseSamples[kAlloyBaseSampleG], count);
+			samplerFillUniforms(&generator, baseSamples[kAlloyBaseSampleM], count);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				evaluateAlloySpecifications(&table, baseSamples, i, &outputs[i * numberOfSpecifications]);
+			}
+
+			for (size_t s = 0; s < numberOfSpecifications; s++)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					streamingHistogramAdd(&threadHistograms[s], outputs[i * numberOfSpecifications + s]);
+				}
+			}
+		}
+
+		free(outputs);
+		free(baseSamples);
+	}
+
+	for (size_t t = 1; t < numberOfThreads; t++)
+	{
+		for (size_t s = 0; s < numberOfSpecifications; s++)
+		{
+			streamingHistogramMerge(&histograms[s], &histograms[t * numberOfSpecifications + s]);
+		}
+	}
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	if (arguments->common.isWriteToFileEnabled)
+	{
+		FILE *	file = fopen(arguments->common.outputFilePath, "w");
+
+		if (file == NULL)
+		{
+			fprintf(stderr, "Error: Could not write to output CSV file \"%s\".\n", arguments->common.outputFilePath);
+			free(histograms);
+			alloySpecificationTableFree(&table);
+
+			return kCommonConstantReturnTypeError;
+		}
+		printAlloyBatchTable(&table, histograms, file, true);
+		fclose(file);
+	}
+	else
+	{
+		printAlloyBatchTable(&table, histograms, stdout, false);
+	}
+
+	if (arguments->common.isTimingEnabled)
+	{
+		printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+	}
+
+	free(histograms);
+	alloySpecificationTableFree(&table);
+
+	return kCommonConstantReturnTypeSuccess;
+}
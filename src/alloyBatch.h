@@ -0,0 +1,95 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+
+
+#define	kAlloySpecificationMaximumNameLength	(64)
+
+/*
+ *	Columns of an alloy specification table, in the order they appear in the CSV header.
+ */
+typedef enum
+{
+	kAlloySpecificationColumnGammaUniformMin	= 0,
+	kAlloySpecificationColumnGammaUniformMax,
+	kAlloySpecificationColumnPhiUniformMin,
+	kAlloySpecificationColumnPhiUniformMax,
+	kAlloySpecificationColumnRsFirstGaussianMean,
+	kAlloySpecificationColumnRsFirstGaussianStandardDeviation,
+	kAlloySpecificationColumnRsSecondGaussianMean,
+	kAlloySpecificationColumnRsSecondGaussianStandardDeviation,
+	kAlloySpecificationColumnRsFirstGaussianWeight,
+	kAlloySpecificationColumnGUniformMin,
+	kAlloySpecificationColumnGUniformMax,
+	kAlloySpecificationColumnB,
+	kAlloySpecificationColumnMUniformMin,
+	kAlloySpecificationColumnMUniformMax,
+	kAlloySpecificationColumnMax,
+} AlloySpecificationColumn;
+
+/*
+ *	Table of alloy specifications, stored column-wise so that the kernel loop
+ *	over specifications vectorizes.
+ */
+typedef struct AlloySpecificationTable
+{
+	size_t		numberOfSpecifications;
+	char		(*names)[kAlloySpecificationMaximumNameLength];
+	double *	columns[kAlloySpecificationColumnMax];
+} AlloySpecificationTable;
+
+/**
+ *	@brief	Read a table of alloy specifications from a CSV file. The first line is a header
+ *		of `name` followed by the `AlloySpecificationColumn` names (see `README.md`), and each
+ *		next line is one specification. Lines starting with `#` are ignored.
+ *
+ *	@param	path	: Path to the CSV file.
+ *	@param	table	: Pointer to the table to fill.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	readAlloySpecificationTableFromCSV(const char *  path, AlloySpecificationTable *  table);
+
+/**
+ *	@brief	Free an alloy specification table.
+ *
+ *	@param	table	: Pointer to the table.
+ */
+void	alloySpecificationTableFree(AlloySpecificationTable *  table);
+
+/**
+ *	@brief	Evaluate all alloy specifications over one shared stream of base samples and
+ *		write per-specification statistics as a table (to the output file if one is
+ *		given, else to stdout).
+ *
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runAlloyBatch(const CommandLineArguments *  arguments);
@@ -0,0 +1,486 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "brownHamLibrary.h"
+#include "brownHamModel.h"
+#include "sampling.h"
+#include "histogram.h"
+
+
+_Static_assert(kBrownHamLibraryBlockSize == kInputSampleBlockSize, "The library block size must match the sampler block size.");
+_Static_assert(kBrownHamLibraryMaximumMixtureComponents <= kInputDistributionMaximumMixtureComponents, "The sampler must support the components of the library distributions.");
+_Static_assert(kBrownHamInputIndexMax <= kInputSamplerMaximumDimensions, "The sampler must support every input.");
+_Static_assert(kBrownHamLibraryDefaultSeed == kSamplerDefaultSeed, "The library default seed must match the sampler default seed.");
+
+struct BrownHamSampler
+{
+	uint64_t	seed;
+	InputSampler	sampler;
+};
+
+struct BrownHamWorkspace
+{
+	InputSampleBlock	block;
+	double			outputs[kInputSampleBlockSize];
+};
+
+struct BrownHamAccumulator
+{
+	StreamingHistogram	histogram;
+};
+
+/*
+ *	Check that caller-provided storage can hold an object of `requiredSize` bytes.
+ */
+static BrownHamStatus
+checkStorage(const void *  storage, size_t storageSize, size_t requiredSize, const void *  object)
+{
+	if ((storage == NULL) || (object == NULL))
+	{
+		return kBrownHamStatusInvalidArgument;
+	}
+
+	if (storageSize < requiredSize)
+	{
+		return kBrownHamStatusStorageTooSmall;
+	}
+
+	if (((uintptr_t) storage % kBrownHamLibraryStorageAlignment) != 0)
+	{
+		return kBrownHamStatusStorageMisaligned;
+	}
+
+	return kBrownHamStatusSuccess;
+}
+
+/*
+ *	Convert a public distribution to the sampler's, with the checks that `-U` applies.
+ */
+static BrownHamStatus
+convertDistribution(const BrownHamDistribution *  source, InputDistribution *  destination)
+{
+	double	totalWeight = 0.0;
+
+	memset(destination, 0, sizeof(InputDistribution));
+
+	if (source->isTruncated && !(source->truncationLower < source->truncationUpper))
+	{
+		return kBrownHamStatusInvalidDistribution;
+	}
+
+	switch (source->kind)
+	{
+		case kBrownHamDistributionKindConstant:
+			destination->kind = kInputDistributionKindConstant;
+			destination->value = source->value;
+			if (!isfinite(source->value) ||
+				(source->isTruncated && ((source->value < source->truncationLower) || (source->value > source->truncationUpper))))
+			{
+				return kBrownHamStatusInvalidDistribution;
+			}
+
+			return kBrownHamStatusSuccess;
+
+		case kBrownHamDistributionKindUniform:
+			destination->kind = kInputDistributionKindUniform;
+			destination->min = source->isTruncated ? fmax(source->min, source->truncationLower) : source->min;
+			destination->max = source->isTruncated ? fmin(source->max, source->truncationUpper) : source->max;
+			if (!isfinite(destination->min) || !isfinite(destination->max) || !(destination->min < destination->max))
+			{
+				return kBrownHamStatusInvalidDistribution;
+			}
+
+			return kBrownHamStatusSuccess;
+
+		case kBrownHamDistributionKindGaussianMixture:
+			if ((source->numberOfComponents == 0) || (source->numberOfComponents > kBrownHamLibraryMaximumMixtureComponents))
+			{
+				return kBrownHamStatusInvalidDistribution;
+			}
+
+			destination->kind = kInputDistributionKindGaussianMixture;
+			destination->numberOfComponents = source->numberOfComponents;
+			for (size_t k = 0; k < source->numberOfComponents; k++)
+			{
+				destination->weights[k] = source->weights[k];
+				destination->means[k] = source->means[k];
+				destination->standardDeviations[k] = source->standardDeviations[k];
+				totalWeight += source->weights[k];
+
+				if (!(source->weights[k] > 0) || !isfinite(source->means[k]) ||
+					!(source->standardDeviations[k] > 0) || !isfinite(source->standardDeviations[k]))
+				{
+					return kBrownHamStatusInvalidDistribution;
+				}
+			}
+
+			if (fabs(totalWeight - 1.0) > 1E-9)
+			{
+				return kBrownHamStatusInvalidDistribution;
+			}
+
+			if (source->isTruncated)
+			{
+				destination->truncationLower = source->truncationLower;
+				destination->truncationUpper = source->truncationUpper;
+				if (!(inputDistributionGetTruncatedMass(destination) > 0.0))
+				{
+					return kBrownHamStatusInvalidDistribution;
+				}
+				destination->isTruncated = true;
+			}
+
+			return kBrownHamStatusSuccess;
+	}
+
+	return kBrownHamStatusInvalidDistribution;
+}
+
+/*
+ *	Check that a correlation matrix is symmetric with a unit diagonal and positive
+ *	definite, so that `inputSamplerInit()` does not fail on it.
+ */
+static BrownHamStatus
+checkCorrelationMatrix(const double *  correlationMatrix)
+{
+	double	factor[kBrownHamInputIndexMax * kBrownHamInputIndexMax];
+
+	for (size_t i = 0; i < kBrownHamInputIndexMax; i++)
+	{
+		if (correlationMatrix[i * kBrownHamInputIndexMax + i] != 1.0)
+		{
+			return kBrownHamStatusInvalidCorrelation;
+		}
+
+		for (size_t j = 0; j < i; j++)
+		{
+			double	correlation = correlationMatrix[i * kBrownHamInputIndexMax + j];
+
+			if (!(fabs(correlation) < 1.0) || (correlation != correlationMatrix[j * kBrownHamInputIndexMax + i]))
+			{
+				return kBrownHamStatusInvalidCorrelation;
+			}
+		}
+	}
+
+	if (choleskyDecompose(correlationMatrix, factor, kBrownHamInputIndexMax) != kCommonConstantReturnTypeSuccess)
+	{
+		return kBrownHamStatusInvalidCorrelation;
+	}
+
+	return kBrownHamStatusSuccess;
+}
+
+uint32_t
+brownHamLibraryGetAbiVersion(void)
+{
+	return kBrownHamLibraryAbiVersion;
+}
+
+const char *
+brownHamStatusGetDescription(BrownHamStatus status)
+{
+	switch (status)
+	{
+		case kBrownHamStatusSuccess:
+			return "Success.";
+
+		case kBrownHamStatusInvalidArgument:
+			return "Invalid argument.";
+
+		case kBrownHamStatusInvalidDistribution:
+			return "Invalid input distribution.";
+
+		case kBrownHamStatusInvalidCorrelation:
+			return "The correlation matrix is not a symmetric positive-definite matrix with a unit diagonal.";
+
+		case kBrownHamStatusStorageTooSmall:
+			return "The storage is too small.";
+
+		case kBrownHamStatusStorageMisaligned:
+			return "The storage is not aligned to kBrownHamLibraryStorageAlignment bytes.";
+	}
+
+	return "Unknown status.";
+}
+
+double
+brownHamEvaluate(double gamma, double phi, double Rs, double G, double b, double M)
+{
+	return computeBrownHamModelOutput(gamma, phi, Rs, G, b, M);
+}
+
+void
+brownHamEvaluateBatch(
+	const double *	gamma,
+	const double *	phi,
+	const double *	Rs,
+	const double *	G,
+	const double *	b,
+	const double *	M,
+	double *	sigmaCMpa,
+	size_t		count)
+{
+	computeBrownHamModelOutputBatch(gamma, phi, Rs, G, b, M, sigmaCMpa, count);
+
+	return;
+}
+
+size_t
+brownHamEvaluateRegimeSwitchingBatch(
+	const double *	gamma,
+	const double *	phi,
+	const double *	Rs,
+	const double *	G,
+	const double *	b,
+	const double *	M,
+	double *	sigmaCMpa,
+	size_t		count)
+{
+	return computeBrownHamModelRegimeSwitchingOutputBatch(gamma, phi, Rs, G, b, M, sigmaCMpa, count);
+}
+
+size_t
+brownHamSamplerGetStorageSize(void)
+{
+	return sizeof(BrownHamSampler);
+}
+
+BrownHamStatus
+brownHamSamplerInit(
+	void *				storage,
+	size_t				storageSize,
+	const BrownHamDistribution *	distributions,
+	const double *			correlationMatrix,
+	uint64_t			seed,
+	BrownHamSampler **		sampler)
+{
+	InputDistribution	converted[kBrownHamInputIndexMax];
+	BrownHamSampler *	initialized = (BrownHamSampler *) storage;
+	BrownHamStatus		status = checkStorage(storage, storageSize, sizeof(BrownHamSampler), sampler);
+
+	if (status != kBrownHamStatusSuccess)
+	{
+		return status;
+	}
+
+	if (distributions == NULL)
+	{
+		return kBrownHamStatusInvalidArgument;
+	}
+
+	for (size_t d = 0; d < kBrownHamInputIndexMax; d++)
+	{
+		status = convertDistribution(&distributions[d], &converted[d]);
+		if (status != kBrownHamStatusSuccess)
+		{
+			return status;
+		}
+	}
+
+	if (correlationMatrix != NULL)
+	{
+		status = checkCorrelationMatrix(correlationMatrix);
+		if (status != kBrownHamStatusSuccess)
+		{
+			return status;
+		}
+	}
+
+	initialized->seed = seed;
+	if (inputSamplerInit(&initialized->sampler, converted, kBrownHamInputIndexMax, correlationMatrix) != kCommonConstantReturnTypeSuccess)
+	{
+		return kBrownHamStatusInvalidCorrelation;
+	}
+	*sampler = initialized;
+
+	return kBrownHamStatusSuccess;
+}
+
+size_t
+brownHamWorkspaceGetStorageSize(void)
+{
+	return sizeof(BrownHamWorkspace);
+}
+
+BrownHamStatus
+brownHamWorkspaceInit(void *  storage, size_t storageSize, BrownHamWorkspace **  workspace)
+{
+	BrownHamStatus	status = checkStorage(storage, storageSize, sizeof(BrownHamWorkspace), workspace);
+
+	if (status != kBrownHamStatusSuccess)
+	{
+		return status;
+	}
+
+	*workspace = (BrownHamWorkspace *) storage;
+
+	return kBrownHamStatusSuccess;
+}
+
+BrownHamStatus
+brownHamSamplerDrawBlock(
+	const BrownHamSampler *	sampler,
+	BrownHamWorkspace *	workspace,
+	uint64_t		blockIndex,
+	size_t			count,
+	double * const *	inputs)
+{
+	SamplerRandomNumberGenerator	generator;
+
+	if ((sampler == NULL) || (workspace == NULL) || (inputs == NULL) || (count > kBrownHamLibraryBlockSize))
+	{
+		return kBrownHamStatusInvalidArgument;
+	}
+
+	samplerRandomNumberGeneratorInit(&generator, sampler->seed, blockIndex);
+	inputSamplerFillBlock(&sampler->sampler, &generator, &workspace->block, count);
+	for (size_t d = 0; d < kBrownHamInputIndexMax; d++)
+	{
+		if (inputs[d] != NULL)
+		{
+			memcpy(inputs[d], workspace->block.values[d], count * sizeof(double));
+		}
+	}
+
+	return kBrownHamStatusSuccess;
+}
+
+BrownHamStatus
+brownHamSamplerEvaluateBlock(
+	const BrownHamSampler *	sampler,
+	BrownHamWorkspace *	workspace,
+	uint64_t		blockIndex,
+	size_t			count,
+	double *		sigmaCMpa)
+{
+	SamplerRandomNumberGenerator	generator;
+	double (*			values)[kInputSampleBlockSize];
+
+	if ((sampler == NULL) || (workspace == NULL) || (sigmaCMpa == NULL) || (count > kBrownHamLibraryBlockSize))
+	{
+		return kBrownHamStatusInvalidArgument;
+	}
+
+	values = workspace->block.values;
+	samplerRandomNumberGeneratorInit(&generator, sampler->seed, blockIndex);
+	inputSamplerFillBlock(&sampler->sampler, &generator, &workspace->block, count);
+	computeBrownHamModelOutputBatch(
+		values[kBrownHamInputIndexGamma],
+		values[kBrownHamInputIndexPhi],
+		values[kBrownHamInputIndexRs],
+		values[kBrownHamInputIndexG],
+		values[kBrownHamInputIndexB],
+		values[kBrownHamInputIndexM],
+		sigmaCMpa,
+		count);
+
+	return kBrownHamStatusSuccess;
+}
+
+BrownHamStatus
+brownHamSamplerAccumulate(
+	const BrownHamSampler *		sampler,
+	BrownHamWorkspace *		workspace,
+	uint64_t			firstBlockIndex,
+	uint64_t			numberOfSamples,
+	BrownHamAccumulator *		accumulator)
+{
+	if ((sampler == NULL) || (workspace == NULL) || (accumulator == NULL))
+	{
+		return kBrownHamStatusInvalidArgument;
+	}
+
+	for (uint64_t blockIndex = firstBlockIndex; numberOfSamples > 0; blockIndex++)
+	{
+		size_t	count = (numberOfSamples < kBrownHamLibraryBlockSize) ? (size_t) numberOfSamples : kBrownHamLibraryBlockSize;
+
+		brownHamSamplerEvaluateBlock(sampler, workspace, blockIndex, count, workspace->outputs);
+		streamingHistogramAddArray(&accumulator->histogram, workspace->outputs, count);
+		numberOfSamples -= count;
+	}
+
+	return kBrownHamStatusSuccess;
+}
+
+size_t
+brownHamAccumulatorGetStorageSize(void)
+{
+	return sizeof(BrownHamAccumulator);
+}
+
+BrownHamStatus
+brownHamAccumulatorInit(void *  storage, size_t storageSize, BrownHamAccumulator **  accumulator)
+{
+	BrownHamStatus	status = checkStorage(storage, storageSize, sizeof(BrownHamAccumulator), accumulator);
+
+	if (status != kBrownHamStatusSuccess)
+	{
+		return status;
+	}
+
+	*accumulator = (BrownHamAccumulator *) storage;
+	streamingHistogramInit(&(*accumulator)->histogram);
+
+	return kBrownHamStatusSuccess;
+}
+
+void
+brownHamAccumulatorAdd(BrownHamAccumulator *  accumulator, const double *  values, size_t count)
+{
+	streamingHistogramAddArray(&accumulator->histogram, values, count);
+
+	return;
+}
+
+void
+brownHamAccumulatorMerge(BrownHamAccumulator *  destination, const BrownHamAccumulator *  source)
+{
+	streamingHistogramMerge(&destination->histogram, &source->histogram);
+
+	return;
+}
+
+void
+brownHamAccumulatorGetSummary(const BrownHamAccumulator *  accumulator, BrownHamSummary *  summary)
+{
+	const StreamingHistogram *	histogram = &accumulator->histogram;
+
+	summary->count = histogram->count;
+	summary->nonFiniteCount = histogram->nonFiniteCount;
+	summary->mean = (histogram->count > 0) ? histogram->mean : NAN;
+	summary->variance = streamingHistogramVariance(histogram);
+	summary->min = (histogram->count > 0) ? histogram->min : NAN;
+	summary->max = (histogram->count > 0) ? histogram->max : NAN;
+
+	return;
+}
+
+double
+brownHamAccumulatorGetQuantile(const BrownHamAccumulator *  accumulator, double probability)
+{
+	return streamingHistogramQuantile(&accumulator->histogram, probability);
+}
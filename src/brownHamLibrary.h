@@ -0,0 +1,361 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*
+ *	Embeddable interface to the Brown and Ham model, its native sampler, and its
+ *	streaming statistics. This header does not depend on the rest of the tree.
+ *
+ *	The public structures below are frozen for a given ABI version. The sampler,
+ *	workspace, and accumulator are opaque: the caller gets their sizes from the
+ *	library, provides suitably aligned storage for them, and the library never
+ *	allocates. A sampler is read-only once initialized, so threads can share it;
+ *	each thread needs its own workspace and accumulator, and accumulators merge.
+ */
+#define	kBrownHamLibraryAbiVersion			(1)
+#define	kBrownHamLibraryStorageAlignment		(64)
+#define	kBrownHamLibraryBlockSize			(1024)
+#define	kBrownHamLibraryMaximumMixtureComponents	(8)
+#define	kBrownHamLibraryDefaultSeed			(UINT64_C(0x5EED0BA5E5EED0B5))
+
+/*
+ *	The library is built with `-fvisibility=hidden`, so that only the functions
+ *	declared here, which carry this attribute, are exported from a shared object.
+ */
+#if defined(__GNUC__)
+#define	BROWNHAM_EXPORT					__attribute__((visibility("default")))
+#else
+#define	BROWNHAM_EXPORT
+#endif
+
+typedef enum
+{
+	kBrownHamStatusSuccess		= 0,
+	kBrownHamStatusInvalidArgument,
+	kBrownHamStatusInvalidDistribution,
+	kBrownHamStatusInvalidCorrelation,
+	kBrownHamStatusStorageTooSmall,
+	kBrownHamStatusStorageMisaligned,
+} BrownHamStatus;
+
+/*
+ *	The inputs, in the order in which the application samples them.
+ */
+typedef enum
+{
+	kBrownHamInputIndexB		= 0,
+	kBrownHamInputIndexG,
+	kBrownHamInputIndexGamma,
+	kBrownHamInputIndexM,
+	kBrownHamInputIndexPhi,
+	kBrownHamInputIndexRs,
+	kBrownHamInputIndexMax,
+} BrownHamInputIndex;
+
+typedef enum
+{
+	kBrownHamDistributionKindConstant	= 0,
+	kBrownHamDistributionKindUniform,
+	kBrownHamDistributionKindGaussianMixture,
+} BrownHamDistributionKind;
+
+/*
+ *	One input distribution: the `value` of a constant, the `min` and `max` of a
+ *	uniform, or the weights, means, and standard deviations of the components of a
+ *	Gaussian mixture. With `isTruncated` set, the distribution is restricted to
+ *	`[truncationLower, truncationUpper]` as with `-U truncated:...`.
+ */
+typedef struct BrownHamDistribution
+{
+	uint32_t	kind;
+	uint32_t	numberOfComponents;
+	double		value;
+	double		min;
+	double		max;
+	double		weights[kBrownHamLibraryMaximumMixtureComponents];
+	double		means[kBrownHamLibraryMaximumMixtureComponents];
+	double		standardDeviations[kBrownHamLibraryMaximumMixtureComponents];
+	uint32_t	isTruncated;
+	uint32_t	reserved;
+	double		truncationLower;
+	double		truncationUpper;
+} BrownHamDistribution;
+
+/*
+ *	Summary of the samples added to an accumulator. Non-finite samples are only counted.
+ */
+typedef struct BrownHamSummary
+{
+	uint64_t	count;
+	uint64_t	nonFiniteCount;
+	double		mean;
+	double		variance;
+	double		min;
+	double		max;
+} BrownHamSummary;
+
+typedef struct BrownHamSampler		BrownHamSampler;
+typedef struct BrownHamWorkspace	BrownHamWorkspace;
+typedef struct BrownHamAccumulator	BrownHamAccumulator;
+
+/**
+ *	@brief	Get the ABI version of the library, to compare with `kBrownHamLibraryAbiVersion`.
+ *
+ *	@return		: The ABI version the library was built with.
+ */
+BROWNHAM_EXPORT uint32_t	brownHamLibraryGetAbiVersion(void);
+
+/**
+ *	@brief	Get a description of a status code.
+ *
+ *	@param	status	: The status code.
+ *	@return		: A static string.
+ */
+BROWNHAM_EXPORT const char *	brownHamStatusGetDescription(BrownHamStatus status);
+
+/**
+ *	@brief	Compute the output of the precipitate dislocation model from Brown and Ham.
+ *
+ *	@param	gamma	: `gamma` variable.
+ *	@param	phi	: `phi` variable.
+ *	@param	Rs	: `Rs` variable.
+ *	@param	G	: `G` variable.
+ *	@param	b	: `b` variable.
+ *	@param	M	: `M` variable.
+ *	@return		: The cutting stress `σc` in MPa.
+ */
+BROWNHAM_EXPORT double	brownHamEvaluate(double gamma, double phi, double Rs, double G, double b, double M);
+
+/**
+ *	@brief	Compute the output of the model for a batch of inputs given as structure-of-arrays.
+ *
+ *	@param	gamma		: Array of `gamma` values.
+ *	@param	phi		: Array of `phi` values.
+ *	@param	Rs		: Array of `Rs` values.
+ *	@param	G		: Array of `G` values.
+ *	@param	b		: Array of `b` values.
+ *	@param	M		: Array of `M` values.
+ *	@param	sigmaCMpa	: Array to store the outputs, which must not overlap the inputs.
+ *	@param	count		: Number of elements in each array.
+ */
+BROWNHAM_EXPORT void	brownHamEvaluateBatch(
+		const double *	gamma,
+		const double *	phi,
+		const double *	Rs,
+		const double *	G,
+		const double *	b,
+		const double *	M,
+		double *	sigmaCMpa,
+		size_t		count);
+
+/**
+ *	@brief	Compute the output of the model for a batch of inputs, taking the strongly coupled
+ *		pair expression where it applies, as with `-w`.
+ *
+ *	@param	gamma		: Array of `gamma` values.
+ *	@param	phi		: Array of `phi` values.
+ *	@param	Rs		: Array of `Rs` values.
+ *	@param	G		: Array of `G` values.
+ *	@param	b		: Array of `b` values.
+ *	@param	M		: Array of `M` values.
+ *	@param	sigmaCMpa	: Array to store the outputs, which must not overlap the inputs.
+ *	@param	count		: Number of elements in each array.
+ *	@return			: The number of samples in the strongly coupled regime.
+ */
+BROWNHAM_EXPORT size_t	brownHamEvaluateRegimeSwitchingBatch(
+		const double *	gamma,
+		const double *	phi,
+		const double *	Rs,
+		const double *	G,
+		const double *	b,
+		const double *	M,
+		double *	sigmaCMpa,
+		size_t		count);
+
+/**
+ *	@brief	Get the size of the storage of a sampler.
+ *
+ *	@return		: The size in bytes.
+ */
+BROWNHAM_EXPORT size_t	brownHamSamplerGetStorageSize(void);
+
+/**
+ *	@brief	Initialize a sampler of the inputs in caller-provided storage.
+ *
+ *	@param	storage			: Storage aligned to `kBrownHamLibraryStorageAlignment` bytes.
+ *	@param	storageSize		: Size of `storage` in bytes.
+ *	@param	distributions		: Array of `kBrownHamInputIndexMax` distributions, indexed by `BrownHamInputIndex`.
+ *	@param	correlationMatrix	: Row-major `kBrownHamInputIndexMax`×`kBrownHamInputIndexMax` Gaussian-copula
+ *					  correlation matrix, or NULL for independent inputs.
+ *	@param	seed			: Seed of the run.
+ *	@param	sampler			: Pointer to store the sampler, which lives in `storage`.
+ *	@return				: `kBrownHamStatusSuccess` if successful, else the reason for the failure.
+ */
+BROWNHAM_EXPORT BrownHamStatus	brownHamSamplerInit(
+			void *				storage,
+			size_t				storageSize,
+			const BrownHamDistribution *	distributions,
+			const double *			correlationMatrix,
+			uint64_t			seed,
+			BrownHamSampler **		sampler);
+
+/**
+ *	@brief	Get the size of the storage of a workspace.
+ *
+ *	@return		: The size in bytes.
+ */
+BROWNHAM_EXPORT size_t	brownHamWorkspaceGetStorageSize(void);
+
+/**
+ *	@brief	Initialize a workspace, the scratch space for drawing one block of samples, in
+ *		caller-provided storage.
+ *
+ *	@param	storage		: Storage aligned to `kBrownHamLibraryStorageAlignment` bytes.
+ *	@param	storageSize	: Size of `storage` in bytes.
+ *	@param	workspace	: Pointer to store the workspace, which lives in `storage`.
+ *	@return			: `kBrownHamStatusSuccess` if successful, else the reason for the failure.
+ */
+BROWNHAM_EXPORT BrownHamStatus	brownHamWorkspaceInit(void *  storage, size_t storageSize, BrownHamWorkspace **  workspace);
+
+/**
+ *	@brief	Draw a block of input samples. Block `i` holds samples `i * kBrownHamLibraryBlockSize`
+ *		onwards of the run, which are those the application draws with the same seed and
+ *		distributions, whichever thread draws it.
+ *
+ *	@param	sampler		: Pointer to the sampler.
+ *	@param	workspace	: Pointer to the workspace of the calling thread.
+ *	@param	blockIndex	: Index of the block.
+ *	@param	count		: Number of samples (at most `kBrownHamLibraryBlockSize`).
+ *	@param	inputs		: Array of `kBrownHamInputIndexMax` arrays of `count` elements to store the
+ *				  samples of each input, indexed by `BrownHamInputIndex`. Entries can be NULL.
+ *	@return			: `kBrownHamStatusSuccess` if successful, else `kBrownHamStatusInvalidArgument`.
+ */
+BROWNHAM_EXPORT BrownHamStatus	brownHamSamplerDrawBlock(
+			const BrownHamSampler *	sampler,
+			BrownHamWorkspace *	workspace,
+			uint64_t		blockIndex,
+			size_t			count,
+			double * const *	inputs);
+
+/**
+ *	@brief	Draw a block of input samples and compute the output of the model for each.
+ *
+ *	@param	sampler		: Pointer to the sampler.
+ *	@param	workspace	: Pointer to the workspace of the calling thread.
+ *	@param	blockIndex	: Index of the block.
+ *	@param	count		: Number of samples (at most `kBrownHamLibraryBlockSize`).
+ *	@param	sigmaCMpa	: Array of `count` elements to store the outputs.
+ *	@return			: `kBrownHamStatusSuccess` if successful, else `kBrownHamStatusInvalidArgument`.
+ */
+BROWNHAM_EXPORT BrownHamStatus	brownHamSamplerEvaluateBlock(
+			const BrownHamSampler *	sampler,
+			BrownHamWorkspace *	workspace,
+			uint64_t		blockIndex,
+			size_t			count,
+			double *		sigmaCMpa);
+
+/**
+ *	@brief	Draw `numberOfSamples` samples from block `firstBlockIndex` onwards, compute the
+ *		output of the model for each, and add the outputs to an accumulator, one block at
+ *		a time.
+ *
+ *	@param	sampler			: Pointer to the sampler.
+ *	@param	workspace		: Pointer to the workspace of the calling thread.
+ *	@param	firstBlockIndex		: Index of the first block.
+ *	@param	numberOfSamples		: Number of samples.
+ *	@param	accumulator		: Pointer to the accumulator of the calling thread.
+ *	@return				: `kBrownHamStatusSuccess` if successful, else `kBrownHamStatusInvalidArgument`.
+ */
+BROWNHAM_EXPORT BrownHamStatus	brownHamSamplerAccumulate(
+			const BrownHamSampler *		sampler,
+			BrownHamWorkspace *		workspace,
+			uint64_t			firstBlockIndex,
+			uint64_t			numberOfSamples,
+			BrownHamAccumulator *		accumulator);
+
+/**
+ *	@brief	Get the size of the storage of an accumulator.
+ *
+ *	@return		: The size in bytes.
+ */
+BROWNHAM_EXPORT size_t	brownHamAccumulatorGetStorageSize(void);
+
+/**
+ *	@brief	Initialize an empty accumulator of running moments and a fixed-size histogram for
+ *		quantiles in caller-provided storage.
+ *
+ *	@param	storage		: Storage aligned to `kBrownHamLibraryStorageAlignment` bytes.
+ *	@param	storageSize	: Size of `storage` in bytes.
+ *	@param	accumulator	: Pointer to store the accumulator, which lives in `storage`.
+ *	@return			: `kBrownHamStatusSuccess` if successful, else the reason for the failure.
+ */
+BROWNHAM_EXPORT BrownHamStatus	brownHamAccumulatorInit(void *  storage, size_t storageSize, BrownHamAccumulator **  accumulator);
+
+/**
+ *	@brief	Add an array of samples to an accumulator.
+ *
+ *	@param	accumulator	: Pointer to the accumulator.
+ *	@param	values		: Array of samples.
+ *	@param	count		: Number of samples in `values`.
+ */
+BROWNHAM_EXPORT void	brownHamAccumulatorAdd(BrownHamAccumulator *  accumulator, const double *  values, size_t count);
+
+/**
+ *	@brief	Merge one accumulator into another (e.g., per-thread accumulators after a parallel run).
+ *
+ *	@param	destination	: Pointer to the accumulator to merge into.
+ *	@param	source		: Pointer to the accumulator to merge from.
+ */
+BROWNHAM_EXPORT void	brownHamAccumulatorMerge(BrownHamAccumulator *  destination, const BrownHamAccumulator *  source);
+
+/**
+ *	@brief	Get the summary of the samples added to an accumulator.
+ *
+ *	@param	accumulator	: Pointer to the accumulator.
+ *	@param	summary		: Pointer to store the summary.
+ */
+BROWNHAM_EXPORT void	brownHamAccumulatorGetSummary(const BrownHamAccumulator *  accumulator, BrownHamSummary *  summary);
+
+/**
+ *	@brief	Estimate a quantile of the samples added to an accumulator. The estimate is exact
+ *		for fewer than 256 samples and interpolated within the histogram bins after that.
+ *
+ *	@param	accumulator	: Pointer to the accumulator.
+ *	@param	probability	: Probability in [0, 1].
+ *	@return			: The estimated quantile, or NAN if the accumulator is empty.
+ */
+BROWNHAM_EXPORT double	brownHamAccumulatorGetQuantile(const BrownHamAccumulator *  accumulator, double probability);
+
+#ifdef __cplusplus
+}
+#endif
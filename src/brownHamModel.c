@@ -0,0 +1,292 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "brownHamModel.h"
+
+
+/*
+ *	Dual number carrying a value and its partial derivatives with respect to the
+ *	inputs of the kernel. The operations are inlined into the batched loop, so that
+ *	the compiler vectorizes across samples.
+ */
+typedef struct BrownHamModelDual
+{
+	double	value;
+	double	partials[kBrownHamModelPartialIndexMax];
+} BrownHamModelDual;
+
+static inline BrownHamModelDual
+dualVariable(double value, BrownHamModelPartialIndex index)
+{
+	BrownHamModelDual	result = {.value = value};
+
+	result.partials[index] = 1.0;
+
+	return result;
+}
+
+static inline BrownHamModelDual
+dualScale(BrownHamModelDual a, double scale)
+{
+	BrownHamModelDual	result = {.value = scale * a.value};
+
+	for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+	{
+		result.partials[j] = scale * a.partials[j];
+	}
+
+	return result;
+}
+
+static inline BrownHamModelDual
+dualSubtract(BrownHamModelDual a, BrownHamModelDual b)
+{
+	BrownHamModelDual	result = {.value = a.value - b.value};
+
+	for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+	{
+		result.partials[j] = a.partials[j] - b.partials[j];
+	}
+
+	return result;
+}
+
+static inline BrownHamModelDual
+dualMultiply(BrownHamModelDual a, BrownHamModelDual b)
+{
+	BrownHamModelDual	result = {.value = a.value * b.value};
+
+	for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+	{
+		result.partials[j] = a.partials[j] * b.value + a.value * b.partials[j];
+	}
+
+	return result;
+}
+
+static inline BrownHamModelDual
+dualDivide(BrownHamModelDual a, BrownHamModelDual b)
+{
+	BrownHamModelDual	result = {.value = a.value / b.value};
+
+	for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+	{
+		result.partials[j] = (a.partials[j] - result.value * b.partials[j]) / b.value;
+	}
+
+	return result;
+}
+
+static inline BrownHamModelDual
+dualSqrt(BrownHamModelDual a)
+{
+	BrownHamModelDual	result = {.value = sqrt(a.value)};
+
+	for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+	{
+		result.partials[j] = a.partials[j] / (2.0 * result.value);
+	}
+
+	return result;
+}
+
+void
+computeBrownHamModelOutputBatch(
+	const double *  restrict	gamma,
+	const double *  restrict	phi,
+	const double *  restrict	Rs,
+	const double *  restrict	G,
+	const double *  restrict	b,
+	const double *  restrict	M,
+	double *  restrict		sigmaCMpa,
+	size_t				count)
+{
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		sigmaCMpa[i] = ((M[i] * gamma[i]) / (2.0 * b[i]))*(sqrt((8.0 * gamma[i] * phi[i] * Rs[i]) / (M_PI * G[i] * (b[i] * b[i]))) - phi[i]) / 1000000;
+	}
+
+	return;
+}
+
+void
+computeBrownHamModelOutputAndIntermediatesBatch(
+	const double *  restrict	gamma,
+	const double *  restrict	phi,
+	const double *  restrict	Rs,
+	const double *  restrict	G,
+	const double *  restrict	b,
+	const double *  restrict	M,
+	double *  restrict		prefactor,
+	double *  restrict		sqrtArgument,
+	double *  restrict		bracket,
+	double *  restrict		sigmaCMpa,
+	size_t				count)
+{
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		prefactor[i] = (M[i] * gamma[i]) / (2.0 * b[i]);
+		sqrtArgument[i] = (8.0 * gamma[i] * phi[i] * Rs[i]) / (M_PI * G[i] * (b[i] * b[i]));
+		bracket[i] = sqrt(sqrtArgument[i]) - phi[i];
+		sigmaCMpa[i] = prefactor[i] * bracket[i] / 1000000;
+	}
+
+	return;
+}
+
+void
+computeBrownHamModelOutputOverParticleSizesBatch(
+	const double *  restrict	gamma,
+	const double *  restrict	phi,
+	const double *  restrict	Rs,
+	const double *  restrict	G,
+	const double *  restrict	b,
+	const double *  restrict	M,
+	const double *  restrict	radiusRatios,
+	const double *  restrict	weights,
+	size_t				numberOfNodes,
+	double *  restrict		prefactor,
+	double *  restrict		sqrtArgument,
+	double *  restrict		bracket,
+	double *  restrict		sigmaCMpa,
+	size_t				count)
+{
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		prefactor[i] = (M[i] * gamma[i]) / (2.0 * b[i]);
+		sqrtArgument[i] = (8.0 * gamma[i] * phi[i] * Rs[i]) / (M_PI * G[i] * (b[i] * b[i]));
+		bracket[i] = -phi[i];
+	}
+
+	/*
+	 *	Accumulate one quadrature node at a time, so that each pass is a
+	 *	vectorized loop over the samples.
+	 */
+	for (size_t k = 0; k < numberOfNodes; k++)
+	{
+		double	ratio = radiusRatios[k];
+		double	weight = weights[k];
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; i++)
+		{
+			bracket[i] += weight * sqrt(sqrtArgument[i] * ratio);
+		}
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		sigmaCMpa[i] = prefactor[i] * bracket[i] / 1000000;
+	}
+
+	return;
+}
+
+void
+computeBrownHamModelOutputAndPartialsBatch(
+	const double *  restrict	gamma,
+	const double *  restrict	phi,
+	const double *  restrict	Rs,
+	const double *  restrict	G,
+	const double *  restrict	b,
+	const double *  restrict	M,
+	double *  restrict		sigmaCMpa,
+	double *  restrict		partials,
+	size_t				stride,
+	size_t				count)
+{
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		BrownHamModelDual	dualGamma = dualVariable(gamma[i], kBrownHamModelPartialIndexGamma);
+		BrownHamModelDual	dualPhi = dualVariable(phi[i], kBrownHamModelPartialIndexPhi);
+		BrownHamModelDual	dualRs = dualVariable(Rs[i], kBrownHamModelPartialIndexRs);
+		BrownHamModelDual	dualG = dualVariable(G[i], kBrownHamModelPartialIndexG);
+		BrownHamModelDual	dualB = dualVariable(b[i], kBrownHamModelPartialIndexB);
+		BrownHamModelDual	dualM = dualVariable(M[i], kBrownHamModelPartialIndexM);
+		BrownHamModelDual	prefactor;
+		BrownHamModelDual	sqrtArgument;
+		BrownHamModelDual	sigma;
+
+		/*
+		 *	Same order of operations as `computeBrownHamModelOutputBatch()`, so that
+		 *	the values agree to the last bit.
+		 */
+		prefactor = dualDivide(dualMultiply(dualM, dualGamma), dualScale(dualB, 2.0));
+		sqrtArgument = dualDivide(
+					dualMultiply(dualMultiply(dualScale(dualGamma, 8.0), dualPhi), dualRs),
+					dualMultiply(dualScale(dualG, M_PI), dualMultiply(dualB, dualB)));
+		sigma = dualMultiply(prefactor, dualSubtract(dualSqrt(sqrtArgument), dualPhi));
+
+		sigmaCMpa[i] = sigma.value / 1000000;
+		for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+		{
+			partials[j * stride + i] = sigma.partials[j] / 1000000;
+		}
+	}
+
+	return;
+}
+
+size_t
+computeBrownHamModelRegimeSwitchingOutputBatch(
+	const double *  restrict	gamma,
+	const double *  restrict	phi,
+	const double *  restrict	Rs,
+	const double *  restrict	G,
+	const double *  restrict	b,
+	const double *  restrict	M,
+	double *  restrict		sigmaCMpa,
+	size_t				count)
+{
+	const double	kStrongPairFactor = sqrt(3.0) / (2.0 * M_PI * sqrt(M_PI));
+	const double	w = kBrownHamModelStrongPairCouplingConstant;
+	size_t		numberOfStronglyCoupled = 0;
+
+	#pragma omp simd reduction(+:numberOfStronglyCoupled)
+	for (size_t i = 0; i < count; i++)
+	{
+		double	lineTension = w * G[i] * (b[i] * b[i]);
+		double	weak = ((M[i] * gamma[i]) / (2.0 * b[i]))*(sqrt((8.0 * gamma[i] * phi[i] * Rs[i]) / (M_PI * G[i] * (b[i] * b[i]))) - phi[i]) / 1000000;
+
+		/*
+		 *	The argument of the square root is clamped so that samples below the
+		 *	coupling threshold, which the mask discards, do not produce NaNs.
+		 */
+		double	strong = M[i] * kStrongPairFactor * (w * G[i] * b[i] / Rs[i]) * sqrt(phi[i])
+				* sqrt(fmax(2.0 * M_PI * gamma[i] * Rs[i] / lineTension - 1.0, 0.0)) / 1000000;
+		bool	isStronglyCoupled = (M_PI * gamma[i] * Rs[i] > lineTension) && (strong < weak);
+
+		sigmaCMpa[i] = isStronglyCoupled ? strong : weak;
+		numberOfStronglyCoupled += isStronglyCoupled;
+	}
+
+	return numberOfStronglyCoupled;
+}
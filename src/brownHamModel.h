@@ -0,0 +1,230 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/*
+ *	Dimensionless constant `w` of the strongly coupled pair expression (Hüther and
+ *	Reppich), which scales the line tension of the dislocations.
+ */
+#define	kBrownHamModelStrongPairCouplingConstant	(1.0)
+
+/*
+ *	Version of the values that the kernels compute. Bump it with any change that
+ *	alters them, so that the result cache does not serve results of the old kernel.
+ */
+#define	kBrownHamModelVersion				(1)
+
+typedef enum
+{
+	kBrownHamModelPartialIndexGamma	= 0,
+	kBrownHamModelPartialIndexPhi,
+	kBrownHamModelPartialIndexRs,
+	kBrownHamModelPartialIndexG,
+	kBrownHamModelPartialIndexB,
+	kBrownHamModelPartialIndexM,
+	kBrownHamModelPartialIndexMax,
+} BrownHamModelPartialIndex;
+
+/**
+ *	@brief	Computes the output of the precipitate dislocation model from Brown and Ham.
+ *
+ *	@param	gamma	: `gamma` variable.
+ *	@param	phi	: `phi` variable.
+ *	@param	Rs	: `Rs` variable.
+ *	@param	G	: `G` variable.
+ *	@param	b	: `b` variable.
+ *	@param	M	: `M` variable.
+ *	@return		: The output of the precipitate dislocation model from Brown and Ham.
+ */
+static inline double
+computeBrownHamModelOutput(
+	double	gamma,
+	double	phi,
+	double	Rs,
+	double	G,
+	double	b,
+	double	M)
+{
+	/*
+	 *                    ⎛    _________________    ⎞
+	 *       ⎛ M ⋅ γ  ⎞   ⎜   ╱8.0 ⋅ γ ⋅ φ ⋅ Rs     ⎟
+	 *  σ  = ⎜─────── ⎟ ⋅ ⎜  ╱ ───────────────── - φ⎟
+	 *   c   ⎝2.0 ⋅ b ⎠   ⎝╲╱  π ⋅ G ⋅ pow(b, 2)    ⎠
+	 */
+	return ((M * gamma) / (2.0 * b))*(sqrt((8.0 * gamma * phi * Rs) / (M_PI * G * pow(b, 2))) - phi) / 1000000;
+}
+
+/**
+ *	@brief	Computes the output of the precipitate dislocation model from Brown and Ham for
+ *		a batch of inputs. The inputs are structure-of-arrays so that the loop vectorizes.
+ *
+ *	@param	gamma		: Array of `gamma` values.
+ *	@param	phi		: Array of `phi` values.
+ *	@param	Rs		: Array of `Rs` values.
+ *	@param	G		: Array of `G` values.
+ *	@param	b		: Array of `b` values.
+ *	@param	M		: Array of `M` values.
+ *	@param	sigmaCMpa	: Array to store the outputs.
+ *	@param	count		: Number of elements in each array.
+ */
+void	computeBrownHamModelOutputBatch(
+		const double *  restrict	gamma,
+		const double *  restrict	phi,
+		const double *  restrict	Rs,
+		const double *  restrict	G,
+		const double *  restrict	b,
+		const double *  restrict	M,
+		double *  restrict		sigmaCMpa,
+		size_t				count);
+
+/**
+ *	@brief	Computes the output of the precipitate dislocation model from Brown and Ham for
+ *		a batch of inputs, together with its intermediate terms.
+ *
+ *	@param	gamma		: Array of `gamma` values.
+ *	@param	phi		: Array of `phi` values.
+ *	@param	Rs		: Array of `Rs` values.
+ *	@param	G		: Array of `G` values.
+ *	@param	b		: Array of `b` values.
+ *	@param	M		: Array of `M` values.
+ *	@param	prefactor	: Array to store the prefactors.
+ *	@param	sqrtArgument	: Array to store the arguments of the square root.
+ *	@param	bracket		: Array to store the bracketed terms.
+ *	@param	sigmaCMpa	: Array to store the outputs.
+ *	@param	count		: Number of elements in each array.
+ */
+void	computeBrownHamModelOutputAndIntermediatesBatch(
+		const double *  restrict	gamma,
+		const double *  restrict	phi,
+		const double *  restrict	Rs,
+		const double *  restrict	G,
+		const double *  restrict	b,
+		const double *  restrict	M,
+		double *  restrict		prefactor,
+		double *  restrict		sqrtArgument,
+		double *  restrict		bracket,
+		double *  restrict		sigmaCMpa,
+		size_t				count);
+
+/**
+ *	@brief	Computes the output of the precipitate dislocation model from Brown and Ham for
+ *		a batch of inputs, averaged over a particle-size distribution with mean `Rs`.
+ *		The distribution is given as a quadrature rule over radii relative to the mean.
+ *
+ *	@param	gamma		: Array of `gamma` values.
+ *	@param	phi		: Array of `phi` values.
+ *	@param	Rs		: Array of mean particle radii.
+ *	@param	G		: Array of `G` values.
+ *	@param	b		: Array of `b` values.
+ *	@param	M		: Array of `M` values.
+ *	@param	radiusRatios	: Quadrature nodes, as radii relative to the mean radius.
+ *	@param	weights		: Quadrature weights, which sum to one.
+ *	@param	numberOfNodes	: Number of quadrature nodes.
+ *	@param	prefactor	: Array to store the prefactors.
+ *	@param	sqrtArgument	: Array to store the arguments of the square root at the mean radius.
+ *	@param	bracket		: Array to store the bracketed terms, averaged over the distribution.
+ *	@param	sigmaCMpa	: Array to store the outputs.
+ *	@param	count		: Number of elements in each array.
+ */
+void	computeBrownHamModelOutputOverParticleSizesBatch(
+		const double *  restrict	gamma,
+		const double *  restrict	phi,
+		const double *  restrict	Rs,
+		const double *  restrict	G,
+		const double *  restrict	b,
+		const double *  restrict	M,
+		const double *  restrict	radiusRatios,
+		const double *  restrict	weights,
+		size_t				numberOfNodes,
+		double *  restrict		prefactor,
+		double *  restrict		sqrtArgument,
+		double *  restrict		bracket,
+		double *  restrict		sigmaCMpa,
+		size_t				count);
+
+/**
+ *	@brief	Computes the output of the precipitate dislocation model from Brown and Ham for
+ *		a batch of inputs, together with its partial derivatives with respect to each
+ *		input, by forward-mode automatic differentiation on dual numbers. The outputs
+ *		are identical to those of `computeBrownHamModelOutputBatch()`.
+ *
+ *	@param	gamma		: Array of `gamma` values.
+ *	@param	phi		: Array of `phi` values.
+ *	@param	Rs		: Array of `Rs` values.
+ *	@param	G		: Array of `G` values.
+ *	@param	b		: Array of `b` values.
+ *	@param	M		: Array of `M` values.
+ *	@param	sigmaCMpa	: Array to store the outputs.
+ *	@param	partials	: Row-major array of `kBrownHamModelPartialIndexMax` rows of `stride`
+ *				  elements, to store the partial derivative with respect to input
+ *				  `j` of sample `i` at `partials[j * stride + i]`.
+ *	@param	stride		: Row stride of `partials`, at least `count`.
+ *	@param	count		: Number of elements in each array.
+ */
+void	computeBrownHamModelOutputAndPartialsBatch(
+		const double *  restrict	gamma,
+		const double *  restrict	phi,
+		const double *  restrict	Rs,
+		const double *  restrict	G,
+		const double *  restrict	b,
+		const double *  restrict	M,
+		double *  restrict		sigmaCMpa,
+		double *  restrict		partials,
+		size_t				stride,
+		size_t				count);
+
+/**
+ *	@brief	Computes the output of the precipitate dislocation model from Brown and Ham for
+ *		a batch of inputs with both pair-coupling regimes. The weakly coupled pair
+ *		expression is that of `computeBrownHamModelOutputBatch()`, which grows with `Rs`.
+ *		The strongly coupled pair expression (Hüther and Reppich),
+ *		`M (√3/2) (w G b / Rs) (√φ / π^(3/2)) √(2π γ Rs / (w G b²) - 1)`,
+ *		falls with `Rs` past its maximum at `Rs = w G b² / (π γ)`. Each sample takes the
+ *		strongly coupled value if it is past that maximum and below the weakly coupled
+ *		one, so that the output peaks where the two regimes meet. Both expressions are
+ *		evaluated for every sample and selected with a mask, so the loop has no branches.
+ *
+ *	@param	gamma		: Array of `gamma` values.
+ *	@param	phi		: Array of `phi` values.
+ *	@param	Rs		: Array of `Rs` values.
+ *	@param	G		: Array of `G` values.
+ *	@param	b		: Array of `b` values.
+ *	@param	M		: Array of `M` values.
+ *	@param	sigmaCMpa	: Array to store the outputs.
+ *	@param	count		: Number of elements in each array.
+ *	@return			: The number of samples in the strongly coupled regime.
+ */
+size_t	computeBrownHamModelRegimeSwitchingOutputBatch(
+		const double *  restrict	gamma,
+		const double *  restrict	phi,
+		const double *  restrict	Rs,
+		const double *  restrict	G,
+		const double *  restrict	b,
+		const double *  restrict	M,
+		double *  restrict		sigmaCMpa,
+		size_t				count);
@@ -0,0 +1,220 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "coarsening.h"
+#include "histogram.h"
+#include "sampling.h"
+#include "common.h"
+
+
+/*
+ *	Per-sample terms of the kernel that do not change as the precipitates coarsen.
+ */
+typedef struct CoarseningBlock
+{
+	InputSampleBlock	inputs;
+	double			prefactor[kInputSampleBlockSize];
+	double			sqrtCoefficient[kInputSampleBlockSize];
+	double			initialRsCubed[kInputSampleBlockSize];
+	double			rate[kInputSampleBlockSize];
+	double			sigmaCMpa[kInputSampleBlockSize];
+} CoarseningBlock;
+
+static void
+prepareCoarseningBlock(CoarseningBlock *  block, size_t count)
+{
+	double (*	values)[kInputSampleBlockSize] = block->inputs.values;
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		double	gamma = values[kInputDistributionIndexGamma][i];
+		double	phi = values[kInputDistributionIndexPhi][i];
+		double	Rs = values[kInputDistributionIndexRs][i];
+		double	G = values[kInputDistributionIndexG][i];
+		double	b = values[kInputDistributionIndexB][i];
+		double	M = values[kInputDistributionIndexM][i];
+
+		block->prefactor[i] = (M * gamma) / (2.0 * b);
+		block->sqrtCoefficient[i] = (8.0 * gamma * phi) / (M_PI * G * (b * b));
+		block->initialRsCubed[i] = Rs * Rs * Rs;
+	}
+
+	return;
+}
+
+static void
+advanceCoarseningBlock(CoarseningBlock *  block, double time, size_t count)
+{
+	const double *	phi = block->inputs.values[kInputDistributionIndexPhi];
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		double	Rs = cbrt(block->initialRsCubed[i] + block->rate[i] * time);
+
+		block->sigmaCMpa[i] = block->prefactor[i] * (sqrt(block->sqrtCoefficient[i] * Rs) - phi[i]) / 1000000;
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+runCoarsening(const CommandLineArguments *  arguments)
+{
+	InputSampler		sampler;
+	size_t			numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	size_t			numberOfBlocks = (numberOfSamples + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+	size_t			numberOfTimeSteps = arguments->coarseningNumberOfTimeSteps;
+	size_t			numberOfThreads = 1;
+	StreamingHistogram *	histograms;
+	FILE *			stream = stdout;
+	clock_t			start = clock();
+	double			cpuTimeUsedInSeconds;
+
+	if (inputSamplerInit(
+			&sampler,
+			arguments->samplingDistributions,
+			kInputDistributionIndexMax,
+			arguments->isCorrelatedSamplingEnabled ? &arguments->correlationMatrix[0][0] : NULL) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: The correlation matrix is not positive definite.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#ifdef _OPENMP
+	numberOfThreads = (size_t) omp_get_max_threads();
+#endif
+
+	/*
+	 *	One histogram per time step and thread. Thread `t` owns the row starting
+	 *	at `histograms[t * numberOfTimeSteps]`.
+	 */
+	histograms = (StreamingHistogram *) checkedMalloc(
+							numberOfThreads * numberOfTimeSteps * sizeof(StreamingHistogram),
+							__FILE__,
+							__LINE__);
+	for (size_t i = 0; i < numberOfThreads * numberOfTimeSteps; i++)
+	{
+		streamingHistogramInit(&histograms[i]);
+	}
+
+	#pragma omp parallel
+	{
+		size_t				threadIndex = 0;
+		StreamingHistogram *		threadHistograms;
+		CoarseningBlock *		block = (CoarseningBlock *) checkedMalloc(sizeof(CoarseningBlock), __FILE__, __LINE__);
+		SamplerRandomNumberGenerator	generator;
+
+#ifdef _OPENMP
+		threadIndex = (size_t) omp_get_thread_num();
+#endif
+		threadHistograms = &histograms[threadIndex * numberOfTimeSteps];
+
+		#pragma omp for schedule(static)
+		for (size_t blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+		{
+			size_t	first = blockIndex * kInputSampleBlockSize;
+			size_t	count = (numberOfSamples - first < kInputSampleBlockSize) ? (numberOfSamples - first) : kInputSampleBlockSize;
+
+			/*
+			 *	Sample the inputs and the coarsening rate once per sample.
+			 */
+			samplerRandomNumberGeneratorInit(&generator, arguments->seed, blockIndex);
+			inputSamplerFillBlock(&sampler, &generator, &block->inputs, count);
+			samplerFillUniforms(&generator, block->rate, count);
+			for (size_t i = 0; i < count; i++)
+			{
+				block->rate[i] = arguments->coarseningRateMin + (arguments->coarseningRateMax - arguments->coarseningRateMin) * block->rate[i];
+			}
+			prepareCoarseningBlock(block, count);
+
+			/*
+			 *	Advance the block through every time step while it is in cache.
+			 */
+			for (size_t j = 0; j < numberOfTimeSteps; j++)
+			{
+				double	time = arguments->coarseningEndTime * j / (numberOfTimeSteps - 1);
+
+				advanceCoarseningBlock(block, time, count);
+				streamingHistogramAddArray(&threadHistograms[j], block->sigmaCMpa, count);
+			}
+		}
+
+		free(block);
+	}
+
+	for (size_t t = 1; t < numberOfThreads; t++)
+	{
+		for (size_t j = 0; j < numberOfTimeSteps; j++)
+		{
+			streamingHistogramMerge(&histograms[j], &histograms[t * numberOfTimeSteps + j]);
+		}
+	}
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	if (arguments->common.isWriteToFileEnabled)
+	{
+		stream = fopen(arguments->common.outputFilePath, "w");
+		if (stream == NULL)
+		{
+			fprintf(stderr, "Error: Could not write to output CSV file \"%s\".\n", arguments->common.outputFilePath);
+			free(histograms);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	streamingHistogramPrintSummaryHeader(stream, "time", arguments->common.isWriteToFileEnabled);
+	for (size_t j = 0; j < numberOfTimeSteps; j++)
+	{
+		char	time[32];
+
+		snprintf(time, sizeof(time), "%le", arguments->coarseningEndTime * j / (numberOfTimeSteps - 1));
+		streamingHistogramPrintSummaryRow(stream, time, &histograms[j], arguments->common.isWriteToFileEnabled);
+	}
+
+	if (stream != stdout)
+	{
+		fclose(stream);
+	}
+
+	if (arguments->common.isTimingEnabled)
+	{
+		printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+	}
+
+	free(histograms);
+
+	return kCommonConstantReturnTypeSuccess;
+}
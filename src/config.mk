@@ -1,4 +1,28 @@
 SOURCES =\
 	main.c\
 	utilities.c\
-	common.c
+	common.c\
+	trace.c\
+	histogram.c\
+	sampling.c\
+	brownHamModel.c\
+	monteCarlo.c\
+	alloyBatch.c\
+	coarsening.c\
+	temperatureSweep.c\
+	particleSizeDistribution.c\
+	runFile.c\
+	resultCache.c\
+	interval.c\
+	polynomialChaos.c\
+	reweighting.c\
+	externalSort.c\
+	outOfCore.c\
+	parameterStudy.c\
+	voxelField.c
+
+LIBRARY_SOURCES =\
+	brownHamLibrary.c\
+	brownHamModel.c\
+	sampling.c\
+	histogram.c
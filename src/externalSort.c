@@ -0,0 +1,425 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "externalSort.h"
+#include "common.h"
+
+
+/*
+ *	Buffered sequential reader of a sorted run during a merge. Runs of one file are
+ *	read alternately, so each refill seeks to the next unread sample of its run.
+ */
+typedef struct SortedRunReader
+{
+	SortedRun *	run;
+	double *	buffer;
+	size_t		capacity;
+	size_t		position;
+	size_t		count;
+	uint64_t	next;
+	uint64_t	remaining;
+} SortedRunReader;
+
+CommonConstantReturnType
+sortedRunFileCreate(SortedRunFile *  file, const char *  directory)
+{
+	char	path[PATH_MAX];
+	int	fileDescriptor;
+
+	if (snprintf(path, sizeof(path), "%s/brownHamRunXXXXXX", directory) >= (int) sizeof(path))
+	{
+		fprintf(stderr, "Error: The out-of-core directory path \"%s\" is too long.\n", directory);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	fileDescriptor = mkstemp(path);
+	if (fileDescriptor < 0)
+	{
+		fprintf(stderr, "Error: Could not create a sorted-run file in \"%s\".\n", directory);
+
+		return kCommonConstantReturnTypeError;
+	}
+	unlink(path);
+
+	file->file = fdopen(fileDescriptor, "w+b");
+	if (file->file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open a sorted-run file in \"%s\".\n", directory);
+		close(fileDescriptor);
+
+		return kCommonConstantReturnTypeError;
+	}
+	file->numberOfSamples = 0;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+sortedRunFileFree(SortedRunFile *  file)
+{
+	if (file->file != NULL)
+	{
+		fclose(file->file);
+		file->file = NULL;
+	}
+
+	return;
+}
+
+void
+sortedRunCreate(SortedRun *  run, SortedRunFile *  file)
+{
+	run->file = file;
+	run->offset = file->numberOfSamples;
+	run->numberOfSamples = 0;
+
+	return;
+}
+
+CommonConstantReturnType
+sortedRunAppend(SortedRun *  run, const double *  samples, size_t count)
+{
+	FILE *	file = run->file->file;
+
+	if ((fseeko(file, (off_t) ((run->offset + run->numberOfSamples) * sizeof(double)), SEEK_SET) != 0) ||
+		(fwrite(samples, sizeof(double), count, file) != count))
+	{
+		fprintf(stderr, "Error: Could not write a sorted run. Is the disk full?\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+	run->numberOfSamples += count;
+	run->file->numberOfSamples = run->offset + run->numberOfSamples;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static CommonConstantReturnType
+sortedRunReaderRefill(SortedRunReader *  reader)
+{
+	size_t	count = (reader->remaining < reader->capacity) ? (size_t) reader->remaining : reader->capacity;
+	FILE *	file = reader->run->file->file;
+
+	if ((fseeko(file, (off_t) (reader->next * sizeof(double)), SEEK_SET) != 0) ||
+		(fread(reader->buffer, sizeof(double), count, file) != count))
+	{
+		fprintf(stderr, "Error: Could not read a sorted run.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+	reader->position = 0;
+	reader->count = count;
+	reader->next += count;
+	reader->remaining -= count;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static inline double
+sortedRunReaderHead(const SortedRunReader *  reader)
+{
+	return reader->buffer[reader->position];
+}
+
+/*
+ *	Restore the min-heap order of `heap`, which holds indices into `readers`,
+ *	below position `i`.
+ */
+static void
+siftDown(const SortedRunReader *  readers, size_t *  heap, size_t size, size_t i)
+{
+	for (;;)
+	{
+		size_t	smallest = i;
+		size_t	left = 2 * i + 1;
+		size_t	right = left + 1;
+		size_t	swap;
+
+		if ((left < size) && (sortedRunReaderHead(&readers[heap[left]]) < sortedRunReaderHead(&readers[heap[smallest]])))
+		{
+			smallest = left;
+		}
+		if ((right < size) && (sortedRunReaderHead(&readers[heap[right]]) < sortedRunReaderHead(&readers[heap[smallest]])))
+		{
+			smallest = right;
+		}
+		if (smallest == i)
+		{
+			return;
+		}
+
+		swap = heap[i];
+		heap[i] = heap[smallest];
+		heap[smallest] = swap;
+		i = smallest;
+	}
+}
+
+/*
+ *	Merge up to `kExternalSortMaximumFanIn` runs with a binary heap of their heads.
+ *	The merged samples go to `output` and `stream` unless they are NULL, and the
+ *	samples at the 0-based `ranks` (in increasing order) go to `rankValues`.
+ */
+static CommonConstantReturnType
+mergeGroup(
+	SortedRun *		runs,
+	size_t			numberOfRuns,
+	double *		workspace,
+	size_t			bufferSize,
+	SortedRun *		output,
+	FILE *			stream,
+	const uint64_t *	ranks,
+	double *		rankValues,
+	size_t			numberOfRanks)
+{
+	SortedRunReader	readers[kExternalSortMaximumFanIn];
+	size_t		heap[kExternalSortMaximumFanIn];
+	size_t		heapSize = 0;
+	double *	outputBuffer = &workspace[numberOfRuns * bufferSize];
+	size_t		outputCount = 0;
+	uint64_t	rank = 0;
+	size_t		nextRank = 0;
+
+	for (size_t r = 0; r < numberOfRuns; r++)
+	{
+		readers[r] = (SortedRunReader) {
+			.run		= &runs[r],
+			.buffer		= &workspace[r * bufferSize],
+			.capacity	= bufferSize,
+			.next		= runs[r].offset,
+			.remaining	= runs[r].numberOfSamples,
+		};
+
+		if (runs[r].numberOfSamples > 0)
+		{
+			if (sortedRunReaderRefill(&readers[r]) != kCommonConstantReturnTypeSuccess)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+			heap[heapSize++] = r;
+		}
+	}
+
+	for (size_t i = heapSize / 2; i-- > 0;)
+	{
+		siftDown(readers, heap, heapSize, i);
+	}
+
+	while (heapSize > 0)
+	{
+		SortedRunReader *	reader = &readers[heap[0]];
+		double			value = sortedRunReaderHead(reader);
+
+		while ((nextRank < numberOfRanks) && (ranks[nextRank] == rank))
+		{
+			rankValues[nextRank++] = value;
+		}
+		rank++;
+
+		outputBuffer[outputCount++] = value;
+		if (outputCount == bufferSize)
+		{
+			if (((output != NULL) && (sortedRunAppend(output, outputBuffer, outputCount) != kCommonConstantReturnTypeSuccess)) ||
+				((stream != NULL) && (fwrite(outputBuffer, sizeof(double), outputCount, stream) != outputCount)))
+			{
+				fprintf(stderr, "Error: Could not write the merged samples.\n");
+
+				return kCommonConstantReturnTypeError;
+			}
+			outputCount = 0;
+		}
+
+		if (++reader->position == reader->count)
+		{
+			if (reader->remaining > 0)
+			{
+				if (sortedRunReaderRefill(reader) != kCommonConstantReturnTypeSuccess)
+				{
+					return kCommonConstantReturnTypeError;
+				}
+			}
+			else
+			{
+				heap[0] = heap[--heapSize];
+			}
+		}
+		siftDown(readers, heap, heapSize, 0);
+	}
+
+	if (((output != NULL) && (sortedRunAppend(output, outputBuffer, outputCount) != kCommonConstantReturnTypeSuccess)) ||
+		((stream != NULL) && (fwrite(outputBuffer, sizeof(double), outputCount, stream) != outputCount)))
+	{
+		fprintf(stderr, "Error: Could not write the merged samples.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+sortedRunsMerge(
+	SortedRun *	runs,
+	size_t		numberOfRuns,
+	const char *	directory,
+	double *	workspace,
+	size_t		workspaceSize,
+	const double *	probabilities,
+	size_t		numberOfProbabilities,
+	double *	quantiles,
+	FILE *		output,
+	size_t *	numberOfMergePasses)
+{
+	size_t		fanIn = workspaceSize / kExternalSortMergeBufferSize - 1;
+	size_t		numberOfPasses = 0;
+	uint64_t	numberOfSamples = 0;
+	SortedRunFile	passFiles[2] = {0};
+	uint64_t *	ranks;
+	double *	rankValues;
+
+	if (fanIn > kExternalSortMaximumFanIn)
+	{
+		fanIn = kExternalSortMaximumFanIn;
+	}
+
+	if (workspaceSize < 3 * kExternalSortMergeBufferSize)
+	{
+		fprintf(stderr, "Error: The merge needs a workspace of at least %d samples.\n", 3 * kExternalSortMergeBufferSize);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Merge groups of `fanIn` runs into longer runs until one final merge suffices.
+	 *	Each pass writes its runs to a new file and then closes the file that the
+	 *	previous pass wrote.
+	 */
+	while (numberOfRuns > fanIn)
+	{
+		SortedRunFile *	passFile = &passFiles[numberOfPasses % 2];
+		size_t		numberOfMergedRuns = 0;
+
+		if (sortedRunFileCreate(passFile, directory) != kCommonConstantReturnTypeSuccess)
+		{
+			sortedRunFileFree(&passFiles[0]);
+			sortedRunFileFree(&passFiles[1]);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t first = 0; first < numberOfRuns; first += fanIn)
+		{
+			size_t		groupSize = (numberOfRuns - first < fanIn) ? (numberOfRuns - first) : fanIn;
+			SortedRun	merged;
+
+			sortedRunCreate(&merged, passFile);
+			if (mergeGroup(
+					&runs[first],
+					groupSize,
+					workspace,
+					workspaceSize / (groupSize + 1),
+					&merged,
+					NULL,
+					NULL,
+					NULL,
+					0) != kCommonConstantReturnTypeSuccess)
+			{
+				sortedRunFileFree(&passFiles[0]);
+				sortedRunFileFree(&passFiles[1]);
+
+				return kCommonConstantReturnTypeError;
+			}
+			runs[numberOfMergedRuns++] = merged;
+		}
+
+		sortedRunFileFree(&passFiles[(numberOfPasses + 1) % 2]);
+		numberOfRuns = numberOfMergedRuns;
+		numberOfPasses++;
+	}
+
+	/*
+	 *	The quantile at probability `p` interpolates between the samples at ranks
+	 *	`floor(p * (n - 1))` and the next one, as in `streamingHistogramQuantile()`.
+	 */
+	for (size_t r = 0; r < numberOfRuns; r++)
+	{
+		numberOfSamples += runs[r].numberOfSamples;
+	}
+
+	ranks = (uint64_t *) checkedMalloc(2 * numberOfProbabilities * sizeof(uint64_t), __FILE__, __LINE__);
+	rankValues = (double *) checkedMalloc(2 * numberOfProbabilities * sizeof(double), __FILE__, __LINE__);
+	for (size_t j = 0; j < numberOfProbabilities; j++)
+	{
+		double	position = fmin(fmax(probabilities[j], 0.0), 1.0) * (numberOfSamples - 1);
+
+		ranks[2 * j] = (uint64_t) position;
+		ranks[2 * j + 1] = (ranks[2 * j] + 1 < numberOfSamples) ? (ranks[2 * j] + 1) : ranks[2 * j];
+	}
+
+	if ((numberOfRuns > 0) &&
+		(mergeGroup(
+			runs,
+			numberOfRuns,
+			workspace,
+			workspaceSize / (numberOfRuns + 1),
+			NULL,
+			output,
+			ranks,
+			rankValues,
+			2 * numberOfProbabilities) != kCommonConstantReturnTypeSuccess))
+	{
+		sortedRunFileFree(&passFiles[0]);
+		sortedRunFileFree(&passFiles[1]);
+		free(ranks);
+		free(rankValues);
+
+		return kCommonConstantReturnTypeError;
+	}
+	numberOfPasses++;
+
+	for (size_t j = 0; j < numberOfProbabilities; j++)
+	{
+		double	fraction = fmin(fmax(probabilities[j], 0.0), 1.0) * (numberOfSamples - 1) - ranks[2 * j];
+
+		quantiles[j] = (numberOfSamples == 0) ? NAN : (rankValues[2 * j] + fraction * (rankValues[2 * j + 1] - rankValues[2 * j]));
+	}
+
+	sortedRunFileFree(&passFiles[0]);
+	sortedRunFileFree(&passFiles[1]);
+	free(ranks);
+	free(rankValues);
+
+	if (numberOfMergePasses != NULL)
+	{
+		*numberOfMergePasses = numberOfPasses;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
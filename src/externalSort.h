@@ -0,0 +1,125 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+
+#define	kExternalSortDefaultDirectory		"/tmp"
+#define	kExternalSortMergeBufferSize		(4096)
+#define	kExternalSortMaximumFanIn		(256)
+
+/*
+ *	An unnamed temporary file that holds sorted runs back to back. The file is
+ *	unlinked as soon as it is created, so it disappears when it is closed, even if
+ *	the application exits early. Keeping all the runs of a spill in one file bounds
+ *	the number of open files, whatever the number of runs.
+ */
+typedef struct SortedRunFile
+{
+	FILE *		file;
+	uint64_t	numberOfSamples;
+} SortedRunFile;
+
+/*
+ *	A sorted run of samples: `numberOfSamples` doubles from sample `offset` of a
+ *	sorted-run file.
+ */
+typedef struct SortedRun
+{
+	SortedRunFile *	file;
+	uint64_t	offset;
+	uint64_t	numberOfSamples;
+} SortedRun;
+
+/**
+ *	@brief	Create an empty sorted-run file in a directory.
+ *
+ *	@param	file		: Pointer to the sorted-run file.
+ *	@param	directory	: Directory to hold the temporary file.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sortedRunFileCreate(SortedRunFile *  file, const char *  directory);
+
+/**
+ *	@brief	Close a sorted-run file. The runs in it are no longer valid.
+ *
+ *	@param	file		: Pointer to the sorted-run file.
+ */
+void	sortedRunFileFree(SortedRunFile *  file);
+
+/**
+ *	@brief	Start an empty sorted run at the end of a sorted-run file. Only the last run
+ *		started in a file can be appended to.
+ *
+ *	@param	run		: Pointer to the run.
+ *	@param	file		: Pointer to the sorted-run file.
+ */
+void	sortedRunCreate(SortedRun *  run, SortedRunFile *  file);
+
+/**
+ *	@brief	Append samples, in increasing order and not less than the samples already in the
+ *		run, to the last sorted run of its file.
+ *
+ *	@param	run		: Pointer to the run.
+ *	@param	samples		: Array of samples.
+ *	@param	count		: Number of samples.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sortedRunAppend(SortedRun *  run, const double *  samples, size_t count);
+
+/**
+ *	@brief	Merge sorted runs and compute exact quantiles of their union. The merge reads
+ *		each run sequentially through a buffer carved out of `workspace`. If there are
+ *		more runs than the workspace has buffers for, it first merges groups of runs
+ *		into longer runs in one temporary file per pass in `directory`, so at most
+ *		two such files are open at a time. The files of the input runs stay open.
+ *
+ *	@param	runs			: Array of runs.
+ *	@param	numberOfRuns		: Number of runs in `runs`.
+ *	@param	directory		: Directory to hold the temporary files of intermediate runs.
+ *	@param	workspace		: Array of `workspaceSize` doubles for the merge buffers.
+ *	@param	workspaceSize		: Number of doubles in `workspace`, at least three merge buffers.
+ *	@param	probabilities		: Array of probabilities in [0, 1], in increasing order.
+ *	@param	numberOfProbabilities	: Number of entries in `probabilities`.
+ *	@param	quantiles		: Array to store the quantiles, interpolated linearly between order statistics.
+ *	@param	output			: Stream to write the merged samples to as raw doubles, or NULL.
+ *	@param	numberOfMergePasses	: Pointer to store the number of merge passes, or NULL.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sortedRunsMerge(
+					SortedRun *	runs,
+					size_t		numberOfRuns,
+					const char *	directory,
+					double *	workspace,
+					size_t		workspaceSize,
+					const double *	probabilities,
+					size_t		numberOfProbabilities,
+					double *	quantiles,
+					FILE *		output,
+					size_t *	numberOfMergePasses);
@@ -0,0 +1,54 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <inttypes.h>
+
+
+#define	kHashFnv1aOffsetBasis	(UINT64_C(0xCBF29CE484222325))
+#define	kHashFnv1aPrime		(UINT64_C(0x100000001B3))
+
+/**
+ *	@brief	Extend a 64-bit FNV-1a hash with a sequence of bytes. Start from
+ *		`kHashFnv1aOffsetBasis`.
+ *
+ *	@param	hash	: Hash of the bytes so far.
+ *	@param	bytes	: Bytes to hash.
+ *	@param	size	: Number of bytes.
+ *	@return		: The extended hash.
+ */
+static inline uint64_t
+hashFnv1aBytes(uint64_t hash, const void *  bytes, size_t size)
+{
+	const unsigned char *	cursor = (const unsigned char *) bytes;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= cursor[i];
+		hash *= kHashFnv1aPrime;
+	}
+
+	return hash;
+}
@@ -0,0 +1,423 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "histogram.h"
+#include "common.h"
+
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	valueA = *(const double *) a;
+	double	valueB = *(const double *) b;
+
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+/*
+ *	Floor of `index / 2^shift`, for re-binning onto a grid `shift` times coarser.
+ */
+static inline int64_t
+floorDivideByPowerOfTwo(int64_t index, int shift)
+{
+	if (shift >= 62)
+	{
+		return (index >= 0) ? 0 : -1;
+	}
+
+	return (index >= 0) ? (index >> shift) : -((-index + (INT64_C(1) << shift) - 1) >> shift);
+}
+
+/*
+ *	Index of the bin that holds `value` on the global grid of bins of width `binWidth`.
+ */
+static inline int64_t
+streamingHistogramGlobalIndex(double value, double binWidth)
+{
+	return (int64_t) floor(value / binWidth);
+}
+
+/*
+ *	Bin width for samples in [min, max]: the smallest power of two, no finer than
+ *	the resolution of the samples, for which the range spans at most
+ *	`kStreamingHistogramNumberOfBins` bins. It only grows as the range grows.
+ */
+static double
+streamingHistogramGetBinWidth(double min, double max)
+{
+	double	magnitude = fmax(fabs(min), fabs(max));
+	int	exponent = (magnitude > 0.0) ? (ilogb(magnitude) - DBL_MANT_DIG) : (DBL_MIN_EXP - DBL_MANT_DIG);
+
+	if (max > min)
+	{
+		int	rangeExponent = ilogb((max - min) / kStreamingHistogramNumberOfBins);
+
+		exponent = (rangeExponent > exponent) ? rangeExponent : exponent;
+	}
+
+	while (streamingHistogramGlobalIndex(max, ldexp(1.0, exponent)) - streamingHistogramGlobalIndex(min, ldexp(1.0, exponent)) >=
+		kStreamingHistogramNumberOfBins)
+	{
+		exponent++;
+	}
+
+	return ldexp(1.0, exponent);
+}
+
+static inline void
+streamingHistogramIncrementBin(StreamingHistogram *  histogram, double value)
+{
+	int64_t	index = streamingHistogramGlobalIndex(value, histogram->binWidth) -
+				streamingHistogramGlobalIndex(histogram->lowerEdge, histogram->binWidth);
+
+	index = (index < 0) ? 0 : index;
+	index = (index >= kStreamingHistogramNumberOfBins) ? (kStreamingHistogramNumberOfBins - 1) : index;
+	histogram->bins[index]++;
+
+	return;
+}
+
+/*
+ *	Add the bins of `source` to `destination`, whose grid is at least as coarse.
+ */
+static void
+streamingHistogramAddBins(StreamingHistogram *  destination, const uint64_t *  bins, double lowerEdge, double binWidth)
+{
+	int	shift = ilogb(destination->binWidth) - ilogb(binWidth);
+	int64_t	sourceLowerIndex = streamingHistogramGlobalIndex(lowerEdge, binWidth);
+	int64_t	destinationLowerIndex = streamingHistogramGlobalIndex(destination->lowerEdge, destination->binWidth);
+
+	for (size_t i = 0; i < kStreamingHistogramNumberOfBins; i++)
+	{
+		int64_t	index;
+
+		if (bins[i] == 0)
+		{
+			continue;
+		}
+
+		index = floorDivideByPowerOfTwo(sourceLowerIndex + (int64_t) i, shift) - destinationLowerIndex;
+		index = (index < 0) ? 0 : index;
+		index = (index >= kStreamingHistogramNumberOfBins) ? (kStreamingHistogramNumberOfBins - 1) : index;
+		destination->bins[index] += bins[i];
+	}
+
+	return;
+}
+
+/*
+ *	Move the bins onto the grid for the range [histogram->min, histogram->max]. The
+ *	grid only gets coarser, and its bins are unions of the old ones, so no count
+ *	moves to a bin that does not hold its samples.
+ */
+static void
+streamingHistogramRegrid(StreamingHistogram *  histogram)
+{
+	uint64_t	bins[kStreamingHistogramNumberOfBins];
+	double		binWidth = streamingHistogramGetBinWidth(histogram->min, histogram->max);
+	double		lowerEdge = streamingHistogramGlobalIndex(histogram->min, binWidth) * binWidth;
+	double		oldLowerEdge = histogram->lowerEdge;
+	double		oldBinWidth = histogram->binWidth;
+
+	if ((binWidth == oldBinWidth) && (lowerEdge == oldLowerEdge))
+	{
+		return;
+	}
+
+	memcpy(bins, histogram->bins, sizeof(bins));
+	memset(histogram->bins, 0, sizeof(histogram->bins));
+	histogram->binWidth = binWidth;
+	histogram->lowerEdge = lowerEdge;
+	streamingHistogramAddBins(histogram, bins, oldLowerEdge, oldBinWidth);
+
+	return;
+}
+
+/*
+ *	Choose the bin grid from the buffered warmup samples and bin them.
+ */
+static void
+streamingHistogramInitializeRange(StreamingHistogram *  histogram)
+{
+	histogram->binWidth = streamingHistogramGetBinWidth(histogram->min, histogram->max);
+	histogram->lowerEdge = streamingHistogramGlobalIndex(histogram->min, histogram->binWidth) * histogram->binWidth;
+
+	for (size_t i = 0; i < histogram->numberOfWarmupSamples; i++)
+	{
+		streamingHistogramIncrementBin(histogram, histogram->warmupSamples[i]);
+	}
+	histogram->isRangeInitialized = true;
+
+	return;
+}
+
+void
+streamingHistogramInit(StreamingHistogram *  histogram)
+{
+	memset(histogram, 0, sizeof(StreamingHistogram));
+	histogram->min = INFINITY;
+	histogram->max = -INFINITY;
+
+	return;
+}
+
+void
+streamingHistogramAdd(StreamingHistogram *  histogram, double value)
+{
+	double	delta;
+	bool	isNewExtreme;
+
+	if (!isfinite(value))
+	{
+		histogram->nonFiniteCount++;
+
+		return;
+	}
+
+	/*
+	 *	Welford update of the running moments.
+	 */
+	histogram->count++;
+	delta = value - histogram->mean;
+	histogram->mean += delta / histogram->count;
+	histogram->m2 += delta * (value - histogram->mean);
+	isNewExtreme = (value < histogram->min) || (value > histogram->max);
+	histogram->min = fmin(histogram->min, value);
+	histogram->max = fmax(histogram->max, value);
+
+	if (!histogram->isRangeInitialized)
+	{
+		histogram->warmupSamples[histogram->numberOfWarmupSamples++] = value;
+		if (histogram->numberOfWarmupSamples == kStreamingHistogramNumberOfBins)
+		{
+			streamingHistogramInitializeRange(histogram);
+		}
+
+		return;
+	}
+
+	if (isNewExtreme)
+	{
+		streamingHistogramRegrid(histogram);
+	}
+	streamingHistogramIncrementBin(histogram, value);
+
+	return;
+}
+
+void
+streamingHistogramAddArray(StreamingHistogram *  histogram, const double *  values, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		streamingHistogramAdd(histogram, values[i]);
+	}
+
+	return;
+}
+
+void
+streamingHistogramMerge(StreamingHistogram *  destination, const StreamingHistogram *  source)
+{
+	uint64_t	count;
+	double		delta;
+
+	/*
+	 *	Samples still buffered in `source` are added one by one. If only `source`
+	 *	has a bin range, merge in the other direction.
+	 */
+	if (!source->isRangeInitialized)
+	{
+		for (size_t i = 0; i < source->numberOfWarmupSamples; i++)
+		{
+			streamingHistogramAdd(destination, source->warmupSamples[i]);
+		}
+		destination->nonFiniteCount += source->nonFiniteCount;
+
+		return;
+	}
+
+	if (!destination->isRangeInitialized)
+	{
+		StreamingHistogram	merged = *source;
+
+		for (size_t i = 0; i < destination->numberOfWarmupSamples; i++)
+		{
+			streamingHistogramAdd(&merged, destination->warmupSamples[i]);
+		}
+		merged.nonFiniteCount += destination->nonFiniteCount;
+		*destination = merged;
+
+		return;
+	}
+
+	/*
+	 *	Combine the running moments (Chan et al.), move the destination onto the
+	 *	grid of the combined range, and add the source bins, which nest in it.
+	 */
+	count = destination->count + source->count;
+	delta = source->mean - destination->mean;
+	destination->m2 += source->m2 + delta * delta * ((double) destination->count * source->count / count);
+	destination->mean += delta * source->count / count;
+	destination->count = count;
+	destination->nonFiniteCount += source->nonFiniteCount;
+	destination->min = fmin(destination->min, source->min);
+	destination->max = fmax(destination->max, source->max);
+	streamingHistogramRegrid(destination);
+	streamingHistogramAddBins(destination, source->bins, source->lowerEdge, source->binWidth);
+
+	return;
+}
+
+double
+streamingHistogramQuantile(const StreamingHistogram *  histogram, double probability)
+{
+	double		target;
+	uint64_t	cumulative = 0;
+
+	if (histogram->count == 0)
+	{
+		return NAN;
+	}
+
+	probability = fmin(fmax(probability, 0.0), 1.0);
+
+	/*
+	 *	Before the range is fixed, the buffered samples give an exact quantile.
+	 */
+	if (!histogram->isRangeInitialized)
+	{
+		double	sorted[kStreamingHistogramNumberOfBins];
+		double	position = probability * (histogram->numberOfWarmupSamples - 1);
+		size_t	index = (size_t) position;
+		double	fraction = position - index;
+
+		memcpy(sorted, histogram->warmupSamples, histogram->numberOfWarmupSamples * sizeof(double));
+		qsort(sorted, histogram->numberOfWarmupSamples, sizeof(double), compareDoubles);
+
+		if (index + 1 >= histogram->numberOfWarmupSamples)
+		{
+			return sorted[histogram->numberOfWarmupSamples - 1];
+		}
+
+		return sorted[index] + fraction * (sorted[index + 1] - sorted[index]);
+	}
+
+	/*
+	 *	Otherwise, interpolate linearly within the bin that holds the target rank.
+	 */
+	target = probability * histogram->count;
+	for (size_t i = 0; i < kStreamingHistogramNumberOfBins; i++)
+	{
+		if ((histogram->bins[i] > 0) && (cumulative + histogram->bins[i] >= target))
+		{
+			double	fraction = (target - cumulative) / histogram->bins[i];
+			double	value = histogram->lowerEdge + (i + fraction) * histogram->binWidth;
+
+			return fmin(fmax(value, histogram->min), histogram->max);
+		}
+		cumulative += histogram->bins[i];
+	}
+
+	return histogram->max;
+}
+
+double
+streamingHistogramVariance(const StreamingHistogram *  histogram)
+{
+	if (histogram->count < 2)
+	{
+		return 0.0;
+	}
+
+	return histogram->m2 / (histogram->count - 1);
+}
+
+void
+streamingHistogramWriteBins(const StreamingHistogram *  histogram, FILE *  stream)
+{
+	StreamingHistogram	binned = *histogram;
+
+	if (binned.count == 0)
+	{
+		return;
+	}
+
+	if (!binned.isRangeInitialized)
+	{
+		streamingHistogramInitializeRange(&binned);
+	}
+
+	for (size_t i = 0; i < kStreamingHistogramNumberOfBins; i++)
+	{
+		fprintf(stream,
+			"%le %le %" PRIu64 "\n",
+			binned.lowerEdge + i * binned.binWidth,
+			binned.lowerEdge + (i + 1) * binned.binWidth,
+			binned.bins[i]);
+	}
+
+	return;
+}
+
+void
+streamingHistogramPrintSummaryHeader(FILE *  stream, const char *  keyName, bool isCSV)
+{
+	if (isCSV)
+	{
+		fprintf(stream, "%s,count,mean,stddev,min,p05,p50,p95,max,nonFinite\n", keyName);
+	}
+	else
+	{
+		fprintf(stream, "%-24s %12s %14s %14s %14s %14s %14s %14s %14s %12s\n",
+			keyName, "count", "mean", "stddev", "min", "p05", "p50", "p95", "max", "nonFinite");
+	}
+
+	return;
+}
+
+void
+streamingHistogramPrintSummaryRow(FILE *  stream, const char *  key, const StreamingHistogram *  histogram, bool isCSV)
+{
+	const char *	format = isCSV ?
+				"%s,%" PRIu64 ",%le,%le,%le,%le,%le,%le,%le,%" PRIu64 "\n" :
+				"%-24s %12" PRIu64 " %14le %14le %14le %14le %14le %14le %14le %12" PRIu64 "\n";
+
+	fprintf(stream, format,
+		key,
+		histogram->count,
+		histogram->mean,
+		sqrt(streamingHistogramVariance(histogram)),
+		histogram->min,
+		streamingHistogramQuantile(histogram, 0.05),
+		streamingHistogramQuantile(histogram, 0.50),
+		streamingHistogramQuantile(histogram, 0.95),
+		histogram->max,
+		histogram->nonFiniteCount);
+
+	return;
+}
@@ -0,0 +1,136 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+
+#define	kStreamingHistogramNumberOfBins		(256)
+
+/*
+ *	Fixed-size streaming histogram with running moments. The first
+ *	`kStreamingHistogramNumberOfBins` samples are buffered to choose the initial
+ *	bin range. Bins then lie on a global grid whose width is a power of two and
+ *	whose edges are multiples of it: the finest one on which [min, max] spans at
+ *	most `kStreamingHistogramNumberOfBins` bins. A new extreme can only coarsen
+ *	the grid, by merging whole bins, so each update costs O(1) amortized and the
+ *	memory footprint is constant. The bins therefore depend only on the samples
+ *	added, not on their order or on how they were split between merged histograms.
+ */
+typedef struct StreamingHistogram
+{
+	uint64_t	count;
+	uint64_t	nonFiniteCount;
+	double		mean;
+	double		m2;
+	double		min;
+	double		max;
+	double		lowerEdge;
+	double		binWidth;
+	bool		isRangeInitialized;
+	size_t		numberOfWarmupSamples;
+	double		warmupSamples[kStreamingHistogramNumberOfBins];
+	uint64_t	bins[kStreamingHistogramNumberOfBins];
+} StreamingHistogram;
+
+/**
+ *	@brief	Initialize an empty streaming histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ */
+void	streamingHistogramInit(StreamingHistogram *  histogram);
+
+/**
+ *	@brief	Add one sample to a streaming histogram. Non-finite samples are only counted.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	value		: The sample.
+ */
+void	streamingHistogramAdd(StreamingHistogram *  histogram, double value);
+
+/**
+ *	@brief	Add an array of samples to a streaming histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	values		: Array of samples.
+ *	@param	count		: Number of samples in `values`.
+ */
+void	streamingHistogramAddArray(StreamingHistogram *  histogram, const double *  values, size_t count);
+
+/**
+ *	@brief	Merge one streaming histogram into another (e.g., per-thread histograms after a
+ *		parallel run). The merge of the bins is exact.
+ *
+ *	@param	destination	: Pointer to the histogram to merge into.
+ *	@param	source		: Pointer to the histogram to merge from.
+ */
+void	streamingHistogramMerge(StreamingHistogram *  destination, const StreamingHistogram *  source);
+
+/**
+ *	@brief	Estimate a quantile from a streaming histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	probability	: Probability in [0, 1].
+ *	@return			: The estimated quantile, or NAN if the histogram is empty.
+ */
+double	streamingHistogramQuantile(const StreamingHistogram *  histogram, double probability);
+
+/**
+ *	@brief	Get the sample variance of the samples added to a streaming histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@return			: The unbiased sample variance, or 0 for fewer than two samples.
+ */
+double	streamingHistogramVariance(const StreamingHistogram *  histogram);
+
+/**
+ *	@brief	Write the bins of a streaming histogram as `lowerEdge upperEdge count` lines.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	stream		: Stream to write to.
+ */
+void	streamingHistogramWriteBins(const StreamingHistogram *  histogram, FILE *  stream);
+
+/**
+ *	@brief	Print the header of a table of histogram summaries (count, mean, standard
+ *		deviation, min, 5th/50th/95th percentiles, max, non-finite count).
+ *
+ *	@param	stream		: Stream to print to.
+ *	@param	keyName		: Name of the first column, which identifies each row.
+ *	@param	isCSV		: Print comma-separated values instead of aligned columns.
+ */
+void	streamingHistogramPrintSummaryHeader(FILE *  stream, const char *  keyName, bool isCSV);
+
+/**
+ *	@brief	Print one row of a table of histogram summaries.
+ *
+ *	@param	stream		: Stream to print to.
+ *	@param	key		: Value of the first column.
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	isCSV		: Print comma-separated values instead of aligned columns.
+ */
+void	streamingHistogramPrintSummaryRow(FILE *  stream, const char *  key, const StreamingHistogram *  histogram, bool isCSV);
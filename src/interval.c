@@ -0,0 +1,337 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "interval.h"
+#include "common.h"
+
+
+/*
+ *	Round-to-nearest arithmetic is accurate to half an ulp, and so is `sqrt()`, so
+ *	moving each bound one ulp outward gives a rigorous enclosure.
+ */
+static inline Interval
+intervalRoundOutward(double lower, double upper)
+{
+	return (Interval) {
+		.lower	= nextafter(lower, -INFINITY),
+		.upper	= nextafter(upper, INFINITY),
+	};
+}
+
+static inline Interval
+intervalMultiply(Interval a, Interval b)
+{
+	double	products[4] = {
+			a.lower * b.lower,
+			a.lower * b.upper,
+			a.upper * b.lower,
+			a.upper * b.upper,
+		};
+
+	return intervalRoundOutward(
+			fmin(fmin(products[0], products[1]), fmin(products[2], products[3])),
+			fmax(fmax(products[0], products[1]), fmax(products[2], products[3])));
+}
+
+/*
+ *	The divisor must not contain zero, which holds for the positive `G` and `b`.
+ */
+static inline Interval
+intervalDivide(Interval a, Interval b)
+{
+	double	quotients[4] = {
+			a.lower / b.lower,
+			a.lower / b.upper,
+			a.upper / b.lower,
+			a.upper / b.upper,
+		};
+
+	return intervalRoundOutward(
+			fmin(fmin(quotients[0], quotients[1]), fmin(quotients[2], quotients[3])),
+			fmax(fmax(quotients[0], quotients[1]), fmax(quotients[2], quotients[3])));
+}
+
+static inline Interval
+intervalSubtract(Interval a, Interval b)
+{
+	return intervalRoundOutward(a.lower - b.upper, a.upper - b.lower);
+}
+
+/*
+ *	Square root of the part of `a` that is not negative.
+ */
+static inline Interval
+intervalSqrt(Interval a)
+{
+	return intervalRoundOutward(sqrt(fmax(a.lower, 0.0)), sqrt(a.upper));
+}
+
+static inline Interval
+intervalConstant(double value)
+{
+	return (Interval) {.lower = value, .upper = value};
+}
+
+static inline Interval
+intervalHull(Interval a, Interval b)
+{
+	return (Interval) {.lower = fmin(a.lower, b.lower), .upper = fmax(a.upper, b.upper)};
+}
+
+static inline Interval
+intervalSubdivision(Interval a, size_t index, size_t count)
+{
+	double	width = (a.upper - a.lower) / count;
+
+	/*
+	 *	Adjacent pieces share their bounds, and the outermost bounds are those of `a`,
+	 *	so the pieces cover `a` regardless of rounding.
+	 */
+	return (Interval) {
+		.lower	= (index == 0) ? a.lower : (a.lower + index * width),
+		.upper	= (index + 1 == count) ? a.upper : (a.lower + (index + 1) * width),
+	};
+}
+
+Interval
+intervalFromInputDistribution(const InputDistribution *  distribution, double truncationSigmas)
+{
+	Interval	support = {.lower = INFINITY, .upper = -INFINITY};
+
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			support = intervalConstant(distribution->value);
+			break;
+
+		case kInputDistributionKindUniform:
+			support = (Interval) {.lower = distribution->min, .upper = distribution->max};
+			break;
+
+		case kInputDistributionKindGaussianMixture:
+			for (size_t i = 0; i < distribution->numberOfComponents; i++)
+			{
+				Interval	component = intervalRoundOutward(
+								distribution->means[i] - truncationSigmas * distribution->standardDeviations[i],
+								distribution->means[i] + truncationSigmas * distribution->standardDeviations[i]);
+
+				support = intervalHull(support, component);
+			}
+
+			/*
+			 *	If the bounds leave out all the components' ranges, the probability
+			 *	lies next to the bound nearest to them.
+			 */
+			if (distribution->isTruncated)
+			{
+				double	lower = distribution->truncationLower;
+				double	upper = distribution->truncationUpper;
+
+				if (upper < support.lower)
+				{
+					support = intervalConstant(upper);
+				}
+				else if (lower > support.upper)
+				{
+					support = intervalConstant(lower);
+				}
+				else
+				{
+					support = (Interval) {.lower = fmax(support.lower, lower), .upper = fmin(support.upper, upper)};
+				}
+			}
+			break;
+	}
+
+	return support;
+}
+
+/*
+ *	Interval extension of the kernel over one box, in the order of operations of
+ *	`computeBrownHamModelOutput()`.
+ */
+static Interval
+computeBrownHamModelOutputIntervalOverBox(
+	Interval	gamma,
+	Interval	phi,
+	Interval	Rs,
+	Interval	G,
+	Interval	b,
+	Interval	M,
+	bool *		isDomainClipped)
+{
+	Interval	pi = {.lower = M_PI, .upper = nextafter(M_PI, INFINITY)};
+	Interval	prefactor;
+	Interval	sqrtArgument;
+
+	prefactor = intervalDivide(intervalMultiply(M, gamma), intervalMultiply(intervalConstant(2.0), b));
+	sqrtArgument = intervalDivide(
+				intervalMultiply(intervalMultiply(intervalMultiply(intervalConstant(8.0), gamma), phi), Rs),
+				intervalMultiply(intervalMultiply(pi, G), intervalMultiply(b, b)));
+
+	if (sqrtArgument.upper < 0)
+	{
+		*isDomainClipped = true;
+
+		return (Interval) {.lower = NAN, .upper = NAN};
+	}
+	*isDomainClipped = *isDomainClipped || (sqrtArgument.lower < 0);
+
+	return intervalDivide(
+			intervalMultiply(prefactor, intervalSubtract(intervalSqrt(sqrtArgument), phi)),
+			intervalConstant(1000000));
+}
+
+Interval
+computeBrownHamModelOutputInterval(
+	Interval	gamma,
+	Interval	phi,
+	Interval	Rs,
+	Interval	G,
+	Interval	b,
+	Interval	M,
+	bool *		isDomainClipped)
+{
+	Interval	enclosure = {.lower = INFINITY, .upper = -INFINITY};
+
+	*isDomainClipped = false;
+
+	/*
+	 *	`gamma`, `phi`, and `b` each occur more than once in the formula, so the
+	 *	interval extension overestimates over wide intervals of them. The hull of the
+	 *	extensions over a grid of sub-boxes is much tighter.
+	 */
+	for (size_t i = 0; i < kIntervalNumberOfSubdivisions; i++)
+	{
+		for (size_t j = 0; j < kIntervalNumberOfSubdivisions; j++)
+		{
+			for (size_t k = 0; k < kIntervalNumberOfSubdivisions; k++)
+			{
+				Interval	box = computeBrownHamModelOutputIntervalOverBox(
+							intervalSubdivision(gamma, i, kIntervalNumberOfSubdivisions),
+							intervalSubdivision(phi, j, kIntervalNumberOfSubdivisions),
+							Rs,
+							G,
+							intervalSubdivision(b, k, kIntervalNumberOfSubdivisions),
+							M,
+							isDomainClipped);
+
+				if (!isnan(box.lower))
+				{
+					enclosure = intervalHull(enclosure, box);
+				}
+			}
+		}
+	}
+
+	if (enclosure.lower > enclosure.upper)
+	{
+		return (Interval) {.lower = NAN, .upper = NAN};
+	}
+
+	return enclosure;
+}
+
+CommonConstantReturnType
+runIntervalBounds(CommandLineArguments *  arguments)
+{
+	const InputDistribution *	distributions = arguments->samplingDistributions;
+	double				truncationSigmas = arguments->intervalTruncationSigmas;
+	Interval			sigmaCMpa;
+	bool				isDomainClipped;
+	clock_t				start = clock();
+	double				cpuTimeUsedInSeconds;
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		Interval	support = intervalFromInputDistribution(&distributions[i], truncationSigmas);
+
+		if (!(support.lower <= support.upper) || !isfinite(support.lower) || !isfinite(support.upper))
+		{
+			fprintf(stderr, "Error: The support of every input must be a finite interval.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((intervalFromInputDistribution(&distributions[kInputDistributionIndexG], truncationSigmas).lower <= 0) ||
+		(intervalFromInputDistribution(&distributions[kInputDistributionIndexB], truncationSigmas).lower <= 0))
+	{
+		fprintf(stderr, "Error: Interval bounds require positive `G` and `b`.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	sigmaCMpa = computeBrownHamModelOutputInterval(
+			intervalFromInputDistribution(&distributions[kInputDistributionIndexGamma], truncationSigmas),
+			intervalFromInputDistribution(&distributions[kInputDistributionIndexPhi], truncationSigmas),
+			intervalFromInputDistribution(&distributions[kInputDistributionIndexRs], truncationSigmas),
+			intervalFromInputDistribution(&distributions[kInputDistributionIndexG], truncationSigmas),
+			intervalFromInputDistribution(&distributions[kInputDistributionIndexB], truncationSigmas),
+			intervalFromInputDistribution(&distributions[kInputDistributionIndexM], truncationSigmas),
+			&isDomainClipped);
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	if (isDomainClipped)
+	{
+		fprintf(stderr, "Warning: Part of the input box gives a negative argument to the square root and is left out of the bounds.\n");
+	}
+
+	if (arguments->common.isOutputJSONMode)
+	{
+		JSONVariable	variables[] = {
+			{
+				.variableSymbol = "sigmaCMpaMin",
+				.variableDescription = "Lower bound of the cutting stress (σc)",
+				.values = (JSONVariablePointer) { .asDouble = &sigmaCMpa.lower},
+				.type = kJSONVariableTypeDouble,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "sigmaCMpaMax",
+				.variableDescription = "Upper bound of the cutting stress (σc)",
+				.values = (JSONVariablePointer) { .asDouble = &sigmaCMpa.upper},
+				.type = kJSONVariableTypeDouble,
+				.size = 1,
+			},
+		};
+
+		printJSONVariables(variables, 2, "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	}
+	else
+	{
+		printf("Cutting stress (σc) ∈ [%le, %le] MPa\n", sigmaCMpa.lower, sigmaCMpa.upper);
+	}
+
+	if (arguments->common.isTimingEnabled)
+	{
+		printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
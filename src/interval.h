@@ -0,0 +1,87 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "common.h"
+#include "utilities.h"
+
+
+#define	kIntervalDefaultTruncationSigmas	(4.0)
+#define	kIntervalNumberOfSubdivisions		(8)
+
+/*
+ *	Closed interval [lower, upper] of real numbers.
+ */
+typedef struct Interval
+{
+	double	lower;
+	double	upper;
+} Interval;
+
+/**
+ *	@brief	Get the support of an input distribution as an interval. Gaussian components
+ *		are truncated at `truncationSigmas` standard deviations from their means.
+ *
+ *	@param	distribution		: Pointer to the distribution.
+ *	@param	truncationSigmas	: Number of standard deviations to keep on either side of each Gaussian mean.
+ *	@return				: The support.
+ */
+Interval	intervalFromInputDistribution(const InputDistribution *  distribution, double truncationSigmas);
+
+/**
+ *	@brief	Enclose the outputs of the precipitate dislocation model from Brown and Ham over
+ *		a box of inputs. Every operation rounds outward, so the true range of the model
+ *		over the box is guaranteed to be inside the result. The box is subdivided along
+ *		the inputs that occur more than once in the formula to tighten the enclosure.
+ *
+ *	@param	gamma		: Interval of `gamma` values.
+ *	@param	phi		: Interval of `phi` values.
+ *	@param	Rs		: Interval of `Rs` values.
+ *	@param	G		: Interval of `G` values.
+ *	@param	b		: Interval of `b` values.
+ *	@param	M		: Interval of `M` values.
+ *	@param	isDomainClipped	: Pointer to store whether part of the box is outside the domain of the
+ *				  square root, which is then left out of the enclosure.
+ *	@return			: Enclosure of the cutting stress in MPa, or an interval of NANs if no
+ *				  part of the box is inside the domain of the model.
+ */
+Interval	computeBrownHamModelOutputInterval(
+			Interval	gamma,
+			Interval	phi,
+			Interval	Rs,
+			Interval	G,
+			Interval	b,
+			Interval	M,
+			bool *		isDomainClipped);
+
+/**
+ *	@brief	Print guaranteed bounds of the cutting stress over the supports of the input
+ *		distributions, without sampling.
+ *
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runIntervalBounds(CommandLineArguments *  arguments);
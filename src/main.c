@@ -21,42 +21,27 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include <stdio.h>
 #include <time.h>
 #include <uxhw.h>
 #include "utilities.h"
+#include "brownHamModel.h"
+#include "monteCarlo.h"
+#include "alloyBatch.h"
+#include "coarsening.h"
+#include "temperatureSweep.h"
+#include "runFile.h"
+#include "resultCache.h"
+#include "interval.h"
+#include "polynomialChaos.h"
+#include "reweighting.h"
+#include "outOfCore.h"
+#include "parameterStudy.h"
+#include "voxelField.h"
 #include "common.h"
 
 
-/**
- *	@brief	Computes the output of the precipitate dislocation model from Brown and Ham.
- *
- *	@param	gamma	: `gamma` variable.
- *	@param	phi	: `phi` variable.
- *	@param	Rs	: `Rs` variable.
- *	@param	G	: `G` variable.
- *	@param	b	: `b` variable.
- *	@param	M	: `M` variable.
- *	@return		: The output of the precipitate dislocation model from Brown and Ham.
- */
-static double
-computeBrownHamModelOutput(
-	double	gamma,
-	double	phi,
-	double	Rs,
-	double	G,
-	double	b,
-	double	M)
-{
-	/*
-	 *                    ⎛    _________________    ⎞
-	 *       ⎛ M ⋅ γ  ⎞   ⎜   ╱8.0 ⋅ γ ⋅ φ ⋅ Rs     ⎟
-	 *  σ  = ⎜─────── ⎟ ⋅ ⎜  ╱ ───────────────── - φ⎟
-	 *   c   ⎝2.0 ⋅ b ⎠   ⎝╲╱  π ⋅ G ⋅ pow(b, 2)    ⎠
-	 */
-	return ((M * gamma) / (2.0 * b))*(sqrt((8.0 * gamma * phi * Rs) / (M_PI * G * pow(b, 2))) - phi) / 1000000;
-}
-
 /*
  *	Precipitate "cutting" dislocation model from Brown and Ham
  *
@@ -107,6 +92,16 @@ main(int argc, char *  argv[])
 	double			benchmarkOutput;
 	double *		monteCarloOutputSamples = NULL;
 	MeanAndVariance		monteCarloOutputMeanAndVariance = {0};
+	MonteCarloRun		monteCarloRun = {0};
+	ResultCache		resultCache = {0};
+	ResultCacheEntry	resultCacheEntry = {0};
+	bool			isResultCacheHit = false;
+	ParameterDerivative	parameterDerivatives[kMaximumNumberOfParameterDerivatives];
+	size_t			numberOfParameterDerivatives = 0;
+	double			regimeFractions[2];
+	uint64_t		domainViolations[2];
+	bool			isDomainViolationsReported = false;
+	size_t			numberOfOutputSamples;
 
 	/*
 	 *	Get command-line arguments.
@@ -116,6 +111,78 @@ main(int argc, char *  argv[])
 		return EXIT_FAILURE;
 	}
 
+	/*
+	 *	Bound the output over the supports of the inputs if in interval mode.
+	 */
+	if (arguments.isIntervalMode)
+	{
+		return (runIntervalBounds(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Fit or load a surrogate and sample it instead of the model if in polynomial chaos mode.
+	 */
+	if (arguments.isPolynomialChaosMode)
+	{
+		return (runPolynomialChaos(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Reweight saved joint samples to the current input distributions if in reweighting mode.
+	 */
+	if (arguments.isReweightingMode)
+	{
+		return (runReweighting(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Spill sorted runs to disk and merge them for exact quantiles if in out-of-core mode.
+	 */
+	if (arguments.isOutOfCoreMode)
+	{
+		return (runOutOfCore(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Evaluate the model over lists or ranges of input values if in parameter study mode.
+	 */
+	if (arguments.isParameterStudyMode)
+	{
+		return (runParameterStudy(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Evaluate the model over raw volumes of `phi` and `Rs` if in voxel mode.
+	 */
+	if (arguments.isVoxelFieldMode)
+	{
+		return (runVoxelField(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Evaluate a table of alloy specifications if in alloy batch mode.
+	 */
+	if (arguments.isAlloyBatchMode)
+	{
+		return (runAlloyBatch(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Evolve the precipitates through time if in coarsening mode.
+	 */
+	if (arguments.isCoarseningMode)
+	{
+		return (runCoarsening(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*
+	 *	Evaluate the model over a grid of temperatures if in temperature sweep mode.
+	 */
+	if (arguments.isTemperatureSweepMode)
+	{
+		return (runTemperatureSweep(&arguments) == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	/*
 	 *	Read input distributions from CSV if input from file is enabled.
 	 */
@@ -142,6 +209,55 @@ main(int argc, char *  argv[])
 								__LINE__);
 	}
 
+	/*
+	 *	Set up the native sampler and the per-thread states if in Monte Carlo mode.
+	 */
+	if (arguments.common.isMonteCarloMode)
+	{
+		if (monteCarloRunInit(&monteCarloRun, &arguments) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	/*
+	 *	Keep the input samples if the joint samples are to be saved.
+	 */
+	if (arguments.jointSamplesFilePath != NULL)
+	{
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			monteCarloRun.inputSamples[d] = (double *) checkedMalloc(
+								arguments.common.numberOfMonteCarloIterations * sizeof(double),
+								__FILE__,
+								__LINE__);
+		}
+	}
+
+	/*
+	 *	Open the result cache if it is enabled.
+	 */
+	if (arguments.resultCacheDirectory != NULL)
+	{
+		if (resultCacheInit(&resultCache, arguments.resultCacheDirectory) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	/*
+	 *	Continue the run saved in the run file, if there is one.
+	 */
+	if (arguments.runFilePath != NULL)
+	{
+		bool	isLoaded;
+
+		if (monteCarloRunLoadRunFile(&monteCarloRun, arguments.runFilePath, &isLoaded) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
 	/*
 	 *	Start timing.
 	 */
@@ -151,9 +267,44 @@ main(int argc, char *  argv[])
 	}
 
 	/*
-	 *	Execute process kernel in a loop. The size of loop is 1 unless in Monte Carlo mode.
+	 *	Look up the results of an identical earlier run. Verbose runs always execute,
+	 *	as the cache does not hold their traces.
 	 */
-	for (size_t i = 0; i < arguments.common.numberOfMonteCarloIterations; ++i)
+	if ((arguments.resultCacheDirectory != NULL) && !arguments.common.isVerbose)
+	{
+		resultCacheEntry.key = resultCacheGetKey(&monteCarloRun, arguments.common.numberOfMonteCarloIterations);
+		isResultCacheHit = resultCacheLookup(&resultCache, resultCacheEntry.key, &resultCacheEntry);
+	}
+
+	/*
+	 *	In Monte Carlo mode, draw the inputs and execute the process kernel in blocks.
+	 *	Else, execute the process kernel once on the (distributional) inputs.
+	 */
+	numberOfOutputSamples = arguments.common.numberOfMonteCarloIterations;
+	if (isResultCacheHit)
+	{
+		numberOfOutputSamples = resultCacheEntry.numberOfKeptSamples;
+		monteCarloRun.numberOfNonFiniteOutputs = resultCacheEntry.numberOfNonFiniteOutputs;
+		monteCarloRun.numberOfNegativeOutputs = resultCacheEntry.numberOfNegativeOutputs;
+		sigmaCMpa = resultCacheEntry.lastSample;
+		monteCarloRun.outputDistribution = resultCacheEntry.outputDistribution;
+		memcpy(monteCarloRun.traceDistributions, resultCacheEntry.traceDistributions, sizeof(monteCarloRun.traceDistributions));
+		memcpy(monteCarloRun.partialDistributions, resultCacheEntry.partialDistributions, sizeof(monteCarloRun.partialDistributions));
+	}
+	else if (arguments.common.isMonteCarloMode)
+	{
+		monteCarloRunExecute(
+			&monteCarloRun,
+			monteCarloOutputSamples,
+			arguments.common.numberOfMonteCarloIterations);
+
+		if (arguments.outputDomainPolicy == kOutputDomainPolicyDrop)
+		{
+			numberOfOutputSamples = monteCarloRunDropNonFiniteSamples(&monteCarloRun, monteCarloOutputSamples, numberOfOutputSamples);
+		}
+		sigmaCMpa = (numberOfOutputSamples > 0) ? monteCarloOutputSamples[numberOfOutputSamples - 1] : NAN;
+	}
+	else
 	{
 		/*
 		 *	Load inputs.
@@ -192,31 +343,46 @@ main(int argc, char *  argv[])
 				b,
 				M);
 
-		/*
-		 *	If in Monte Carlo mode, populate monteCarloOutputSamples
-		 */
-		if (arguments.common.isMonteCarloMode)
-		{
-			monteCarloOutputSamples[i] = sigmaCMpa;
-		}
-		/*
-		 *	Else, if in benchmarking mode, populate benchmarkOutput.
-		 */
-		else if (arguments.common.isBenchmarkingMode)
-		{
-			benchmarkOutput = sigmaCMpa;
-		}
+		benchmarkOutput = sigmaCMpa;
+	}
+
+	/*
+	 *	Apply the output-domain policy, with the counts of the run or of the cached run.
+	 */
+	if ((arguments.outputDomainPolicy == kOutputDomainPolicyAbort) &&
+		(monteCarloRun.numberOfNonFiniteOutputs + monteCarloRun.numberOfNegativeOutputs > 0))
+	{
+		fprintf(stderr, "Error: The run produced %" PRIu64 " non-finite and %" PRIu64 " negative outputs.\n",
+			monteCarloRun.numberOfNonFiniteOutputs, monteCarloRun.numberOfNegativeOutputs);
+
+		return EXIT_FAILURE;
 	}
 
 	/*
 	 *	If not doing Laplace version, then approximate the cost of the third phase of
 	 *	Monte Carlo (post-processing), by calculating the mean and variance.
 	 */
-	if (arguments.common.isMonteCarloMode)
+	if (isResultCacheHit)
+	{
+		monteCarloOutputMeanAndVariance.mean = resultCacheEntry.mean;
+		monteCarloOutputMeanAndVariance.variance = resultCacheEntry.variance;
+		benchmarkOutput = monteCarloOutputMeanAndVariance.mean;
+	}
+	else if (arguments.common.isMonteCarloMode)
 	{
 		monteCarloOutputMeanAndVariance = calculateMeanAndVarianceOfDoubleSamples(
 								monteCarloOutputSamples,
-								arguments.common.numberOfMonteCarloIterations);
+								numberOfOutputSamples);
+
+		/*
+		 *	An extended run reports the moments of all its samples, which the merged
+		 *	output histogram holds, rather than those of this invocation's samples.
+		 */
+		if (arguments.runFilePath != NULL)
+		{
+			monteCarloOutputMeanAndVariance.mean = monteCarloRun.outputDistribution.mean;
+			monteCarloOutputMeanAndVariance.variance = streamingHistogramVariance(&monteCarloRun.outputDistribution);
+		}
 		benchmarkOutput = monteCarloOutputMeanAndVariance.mean;
 	}
 
@@ -229,6 +395,36 @@ main(int argc, char *  argv[])
 		cpuTimeUsedInSeconds = ((double) (end - start)) / CLOCKS_PER_SEC;
 	}
 
+	if (arguments.isParameterDerivativesEnabled)
+	{
+		numberOfParameterDerivatives = monteCarloRunGetParameterDerivatives(&monteCarloRun, parameterDerivatives);
+	}
+
+	/*
+	 *	The regime fractions cover all the samples of the run, including those of a run file.
+	 */
+	if (arguments.isRegimeSwitchingEnabled)
+	{
+		regimeFractions[1] = (double) monteCarloRun.numberOfStronglyCoupledSamples / monteCarloRun.numberOfSamples;
+		regimeFractions[0] = 1.0 - regimeFractions[1];
+	}
+
+	/*
+	 *	The output-domain counts likewise cover the whole run, as the run file accumulates them.
+	 */
+	domainViolations[0] = monteCarloRun.numberOfNonFiniteOutputs;
+	domainViolations[1] = monteCarloRun.numberOfNegativeOutputs;
+	isDomainViolationsReported = arguments.common.isMonteCarloMode &&
+					((domainViolations[0] + domainViolations[1] > 0) || (arguments.outputDomainPolicy != kOutputDomainPolicyKeep));
+
+	/*
+	 *	Render the trace as text now that the timed region is over.
+	 */
+	if (arguments.common.isMonteCarloMode)
+	{
+		monteCarloRunDecodeTraces(&monteCarloRun, stdout);
+	}
+
 	/*
 	 *	Set outputs.
 	 */
@@ -253,6 +449,11 @@ main(int argc, char *  argv[])
 			printJSONFormattedOutput(
 				sigmaCMpa,
 				cpuTimeUsedInSeconds,
+				arguments.isPartialsEnabled ? monteCarloRun.partialDistributions : NULL,
+				arguments.isParameterDerivativesEnabled ? parameterDerivatives : NULL,
+				numberOfParameterDerivatives,
+				arguments.isRegimeSwitchingEnabled ? regimeFractions : NULL,
+				isDomainViolationsReported ? domainViolations : NULL,
 				&arguments);
 		}
 		/*
@@ -261,6 +462,35 @@ main(int argc, char *  argv[])
 		else
 		{
 			printf("Cutting stress (σc) = %le MPa\n", sigmaCMpa);
+
+			if (arguments.isPartialsEnabled)
+			{
+				printPartialDistributions(monteCarloRun.partialDistributions, stdout);
+			}
+
+			if (arguments.isParameterDerivativesEnabled)
+			{
+				printParameterDerivatives(parameterDerivatives, numberOfParameterDerivatives, stdout);
+			}
+
+			if (arguments.isRegimeSwitchingEnabled)
+			{
+				printf("Pair coupling: %.2lf%% of samples weakly coupled, %.2lf%% strongly coupled\n",
+					100.0 * regimeFractions[0], 100.0 * regimeFractions[1]);
+			}
+
+			if (isDomainViolationsReported)
+			{
+				const char * const	kPolicyActions[] = {
+								[kOutputDomainPolicyKeep]	= "kept",
+								[kOutputDomainPolicyDrop]	= "dropped",
+								[kOutputDomainPolicyClamp]	= "clamped to zero",
+								[kOutputDomainPolicyAbort]	= "checked",
+							};
+
+				printf("Output domain: %" PRIu64 " non-finite and %" PRIu64 " negative outputs (%s)\n",
+					domainViolations[0], domainViolations[1], kPolicyActions[arguments.outputDomainPolicy]);
+			}
 		}
 
 		/*
@@ -273,14 +503,92 @@ main(int argc, char *  argv[])
 	}
 
 	/*
-	 *	Save Monte Carlo data to "data.out" if in Monte Carlo mode.
+	 *	Add the results of this run to the result cache.
+	 */
+	if ((arguments.resultCacheDirectory != NULL) && !isResultCacheHit && !arguments.common.isVerbose)
+	{
+		resultCacheEntry.numberOfSamples = arguments.common.numberOfMonteCarloIterations;
+		resultCacheEntry.numberOfKeptSamples = numberOfOutputSamples;
+		resultCacheEntry.numberOfNonFiniteOutputs = monteCarloRun.numberOfNonFiniteOutputs;
+		resultCacheEntry.numberOfNegativeOutputs = monteCarloRun.numberOfNegativeOutputs;
+		resultCacheEntry.lastSample = sigmaCMpa;
+		resultCacheEntry.mean = monteCarloOutputMeanAndVariance.mean;
+		resultCacheEntry.variance = monteCarloOutputMeanAndVariance.variance;
+		resultCacheEntry.outputDistribution = monteCarloRun.outputDistribution;
+		memcpy(resultCacheEntry.traceDistributions, monteCarloRun.traceDistributions, sizeof(resultCacheEntry.traceDistributions));
+		memcpy(resultCacheEntry.partialDistributions, monteCarloRun.partialDistributions, sizeof(resultCacheEntry.partialDistributions));
+
+		if (resultCacheStore(&resultCache, &resultCacheEntry) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	/*
+	 *	Save the extended run and report its accumulated output distribution.
+	 */
+	if (arguments.runFilePath != NULL)
+	{
+		if (monteCarloRunSaveRunFile(&monteCarloRun, arguments.runFilePath) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+
+		if (!arguments.common.isOutputJSONMode && !arguments.common.isBenchmarkingMode)
+		{
+			printf("Run file \"%s\": %" PRIu64 " samples.\n", arguments.runFilePath, monteCarloRun.numberOfSamples);
+			streamingHistogramPrintSummaryHeader(stdout, "variable", false);
+			streamingHistogramPrintSummaryRow(stdout, "sigmaCMpa", &monteCarloRun.outputDistribution, false);
+		}
+	}
+
+	/*
+	 *	Report the traced distributions and save their histograms to "traces.out".
+	 */
+	if (arguments.isTraceDistributionsEnabled)
+	{
+		if (!arguments.common.isOutputJSONMode && !arguments.common.isBenchmarkingMode)
+		{
+			printTraceDistributions(monteCarloRun.traceDistributions, stdout);
+		}
+
+		if (saveTraceDistributionsToTracesDotOutFile(monteCarloRun.traceDistributions) != kCommonConstantReturnTypeSuccess)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	/*
+	 *	Save Monte Carlo data to "data.out" if in Monte Carlo mode. The result cache
+	 *	does not hold the samples, so a cache hit removes any "data.out" of an earlier
+	 *	run rather than leave samples that disagree with the reported statistics.
 	 */
 	if (arguments.common.isMonteCarloMode)
 	{
-		saveMonteCarloDoubleDataToDataDotOutFile(
-			monteCarloOutputSamples,
-			(uint64_t)(cpuTimeUsedInSeconds * 1000000),
-			arguments.common.numberOfMonteCarloIterations);
+		if (!isResultCacheHit)
+		{
+			saveMonteCarloDoubleDataToDataDotOutFile(
+				monteCarloOutputSamples,
+				(uint64_t)(cpuTimeUsedInSeconds * 1000000),
+				numberOfOutputSamples);
+		}
+		else if (remove("data.out") == 0)
+		{
+			fprintf(stderr, "Warning: The results come from the result cache, which does not hold the samples, so \"data.out\" was removed.\n");
+		}
+
+		if (arguments.jointSamplesFilePath != NULL)
+		{
+			if (jointSamplesSave(
+				arguments.jointSamplesFilePath,
+				arguments.samplingDistributions,
+				monteCarloRun.inputSamples,
+				monteCarloOutputSamples,
+				numberOfOutputSamples) != kCommonConstantReturnTypeSuccess)
+			{
+				return EXIT_FAILURE;
+			}
+		}
 	}
 	/*
 	 *	Save outputs to file if not in Monte Carlo mode and write to file is enabled.
@@ -308,6 +616,11 @@ main(int argc, char *  argv[])
 	if (arguments.common.isMonteCarloMode)
 	{
 		free(monteCarloOutputSamples);
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			free(monteCarloRun.inputSamples[d]);
+		}
+		monteCarloRunFree(&monteCarloRun);
 	}
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,662 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "monteCarlo.h"
+#include "brownHamModel.h"
+#include "hash.h"
+#include "common.h"
+
+
+static const BrownHamModelPartialIndex	kInputPartialIndices[kInputDistributionIndexMax] = {
+						[kInputDistributionIndexB]	= kBrownHamModelPartialIndexB,
+						[kInputDistributionIndexG]	= kBrownHamModelPartialIndexG,
+						[kInputDistributionIndexGamma]	= kBrownHamModelPartialIndexGamma,
+						[kInputDistributionIndexM]	= kBrownHamModelPartialIndexM,
+						[kInputDistributionIndexPhi]	= kBrownHamModelPartialIndexPhi,
+						[kInputDistributionIndexRs]	= kBrownHamModelPartialIndexRs,
+					};
+
+static size_t
+getMaximumNumberOfThreads(void)
+{
+#ifdef _OPENMP
+	return (size_t) omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+static size_t
+getThreadIndex(void)
+{
+#ifdef _OPENMP
+	return (size_t) omp_get_thread_num();
+#else
+	return 0;
+#endif
+}
+
+static uint64_t
+hashDoubles(uint64_t hash, const double *  values, size_t count)
+{
+	return hashFnv1aBytes(hash, values, count * sizeof(double));
+}
+
+/*
+ *	Hash field by field, so that padding bytes do not enter the hash.
+ */
+uint64_t
+monteCarloRunGetConfigurationHash(const MonteCarloRun *  run)
+{
+	uint64_t	hash = kHashFnv1aOffsetBasis;
+	uint64_t	value;
+
+	hash = hashFnv1aBytes(hash, &run->seed, sizeof(run->seed));
+	for (size_t i = 0; i < run->sampler.numberOfDimensions; i++)
+	{
+		hash = inputDistributionGetHash(hash, &run->sampler.distributions[i]);
+
+		value = (uint64_t) run->sampler.isCorrelated[i];
+		hash = hashFnv1aBytes(hash, &value, sizeof(value));
+		hash = hashDoubles(hash, run->sampler.choleskyFactor[i], run->sampler.numberOfDimensions);
+	}
+
+	value = (uint64_t) run->isParticleSizeDistributionEnabled;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	if (run->isParticleSizeDistributionEnabled)
+	{
+		value = (uint64_t) run->particleSizeDistribution.numberOfNodes;
+		hash = hashFnv1aBytes(hash, &value, sizeof(value));
+		hash = hashDoubles(hash, run->particleSizeDistribution.radiusRatios, run->particleSizeDistribution.numberOfNodes);
+		hash = hashDoubles(hash, run->particleSizeDistribution.weights, run->particleSizeDistribution.numberOfNodes);
+	}
+
+	/*
+	 *	Hashed only when enabled, so that the hashes of existing run files do not change.
+	 */
+	if (run->isRegimeSwitchingEnabled)
+	{
+		const char	kRegimeSwitching[] = "regimeSwitching";
+
+		hash = hashFnv1aBytes(hash, kRegimeSwitching, sizeof(kRegimeSwitching));
+	}
+
+	if (run->outputDomainPolicy != kOutputDomainPolicyKeep)
+	{
+		value = (uint64_t) run->outputDomainPolicy;
+		hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	}
+
+	return hash;
+}
+
+CommonConstantReturnType
+monteCarloRunInit(MonteCarloRun *  run, const CommandLineArguments *  arguments)
+{
+	memset(run, 0, sizeof(MonteCarloRun));
+	run->seed = arguments->seed;
+	run->isTracingEnabled = arguments->common.isVerbose;
+	run->isTraceDistributionsEnabled = arguments->isTraceDistributionsEnabled;
+	run->isParticleSizeDistributionEnabled = (arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone);
+	run->isOutputDistributionEnabled = (arguments->runFilePath != NULL) || (arguments->resultCacheDirectory != NULL);
+	run->isPartialsEnabled = arguments->isPartialsEnabled;
+	run->isParameterDerivativesEnabled = arguments->isParameterDerivativesEnabled;
+	run->isRegimeSwitchingEnabled = arguments->isRegimeSwitchingEnabled;
+	run->outputDomainPolicy = arguments->outputDomainPolicy;
+
+	if (inputSamplerInit(
+			&run->sampler,
+			arguments->samplingDistributions,
+			kInputDistributionIndexMax,
+			arguments->isCorrelatedSamplingEnabled ? &arguments->correlationMatrix[0][0] : NULL) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: The correlation matrix is not positive definite.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments->particleSizeDistributionKind == kParticleSizeDistributionKindLognormal)
+	{
+		if (particleSizeDistributionInitLognormal(
+				&run->particleSizeDistribution,
+				arguments->particleSizeDistributionShape,
+				arguments->particleSizeDistributionNumberOfNodes) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else if (arguments->particleSizeDistributionKind == kParticleSizeDistributionKindEmpirical)
+	{
+		if (particleSizeDistributionInitFromCSV(
+				&run->particleSizeDistribution,
+				arguments->particleSizeDistributionFilePath,
+				arguments->particleSizeDistributionNumberOfNodes) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (run->isParameterDerivativesEnabled)
+	{
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			for (size_t j = 0; j < inputDistributionGetNumberOfParameters(&arguments->samplingDistributions[d]); j++)
+			{
+				run->parameterInputIndices[run->numberOfParameters] = (InputDistributionIndex) d;
+				run->parameterIndices[run->numberOfParameters] = j;
+				run->numberOfParameters++;
+			}
+		}
+	}
+
+	run->numberOfThreads = getMaximumNumberOfThreads();
+	run->threadStates = (MonteCarloThreadState *) checkedMalloc(
+								run->numberOfThreads * sizeof(MonteCarloThreadState),
+								__FILE__,
+								__LINE__);
+
+	for (size_t t = 0; t < run->numberOfThreads; t++)
+	{
+		MonteCarloThreadState *	state = &run->threadStates[t];
+
+		if (run->isTracingEnabled)
+		{
+			if (traceRingBufferInit(
+					&state->traceRingBuffer,
+					kTraceDefaultCapacity,
+					arguments->traceSamplingInterval) != kCommonConstantReturnTypeSuccess)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+		}
+
+		for (size_t i = 0; i < kTraceDistributionIndexMax; i++)
+		{
+			streamingHistogramInit(&state->traceDistributions[i]);
+		}
+		streamingHistogramInit(&state->outputDistribution);
+		for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+		{
+			streamingHistogramInit(&state->partialDistributions[j]);
+		}
+		memset(state->parameterDerivativeSums, 0, sizeof(state->parameterDerivativeSums));
+		memset(state->parameterDerivativeSquaredSums, 0, sizeof(state->parameterDerivativeSquaredSums));
+		state->numberOfFiniteSamples = 0;
+		state->numberOfStronglyCoupledSamples = 0;
+		state->numberOfNonFiniteOutputs = 0;
+		state->numberOfNegativeOutputs = 0;
+	}
+
+	for (size_t i = 0; i < kTraceDistributionIndexMax; i++)
+	{
+		streamingHistogramInit(&run->traceDistributions[i]);
+	}
+	streamingHistogramInit(&run->outputDistribution);
+	for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+	{
+		streamingHistogramInit(&run->partialDistributions[j]);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Count the non-finite and the negative outputs of a block with masks that the
+ *	compiler reduces in vector registers, then apply the domain policy to the
+ *	block only if it has any.
+ */
+static void
+monteCarloRunCheckOutputDomain(
+	const MonteCarloRun *	run,
+	MonteCarloThreadState *	state,
+	double *		outputs,
+	size_t			count)
+{
+	uint64_t	numberOfNonFiniteOutputs = 0;
+	uint64_t	numberOfNegativeOutputs = 0;
+	double		replacement = (run->outputDomainPolicy == kOutputDomainPolicyDrop) ? NAN : 0.0;
+
+	#pragma omp simd reduction(+:numberOfNonFiniteOutputs, numberOfNegativeOutputs)
+	for (size_t i = 0; i < count; i++)
+	{
+		numberOfNonFiniteOutputs += !(fabs(outputs[i]) <= DBL_MAX);
+		numberOfNegativeOutputs += (outputs[i] < 0.0) & (outputs[i] >= -DBL_MAX);
+	}
+
+	state->numberOfNonFiniteOutputs += numberOfNonFiniteOutputs;
+	state->numberOfNegativeOutputs += numberOfNegativeOutputs;
+
+	if ((numberOfNonFiniteOutputs + numberOfNegativeOutputs == 0) ||
+		((run->outputDomainPolicy != kOutputDomainPolicyDrop) && (run->outputDomainPolicy != kOutputDomainPolicyClamp)))
+	{
+		return;
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		outputs[i] = ((outputs[i] >= 0.0) && (outputs[i] <= DBL_MAX)) ? outputs[i] : replacement;
+	}
+
+	return;
+}
+
+/*
+ *	Sample and evaluate the block `blockIndex`, writing its outputs to `outputs`
+ *	and the samples of each input `d` to `inputSamples[d]` unless it is NULL.
+ */
+static void
+monteCarloRunExecuteBlock(
+	MonteCarloRun *		run,
+	MonteCarloThreadState *	state,
+	uint64_t		blockIndex,
+	uint64_t		firstSampleIndex,
+	double *		outputs,
+	double * const *	inputSamples,
+	size_t			count)
+{
+	SamplerRandomNumberGenerator	generator;
+	double (*			values)[kInputSampleBlockSize] = state->inputs.values;
+
+	samplerRandomNumberGeneratorInit(&generator, run->seed, blockIndex);
+	inputSamplerFillBlock(&run->sampler, &generator, &state->inputs, count);
+
+	if (run->isParticleSizeDistributionEnabled)
+	{
+		computeBrownHamModelOutputOverParticleSizesBatch(
+			values[kInputDistributionIndexGamma],
+			values[kInputDistributionIndexPhi],
+			values[kInputDistributionIndexRs],
+			values[kInputDistributionIndexG],
+			values[kInputDistributionIndexB],
+			values[kInputDistributionIndexM],
+			run->particleSizeDistribution.radiusRatios,
+			run->particleSizeDistribution.weights,
+			run->particleSizeDistribution.numberOfNodes,
+			state->prefactor,
+			state->sqrtArgument,
+			state->bracket,
+			outputs,
+			count);
+	}
+	else if (run->isTraceDistributionsEnabled)
+	{
+		computeBrownHamModelOutputAndIntermediatesBatch(
+			values[kInputDistributionIndexGamma],
+			values[kInputDistributionIndexPhi],
+			values[kInputDistributionIndexRs],
+			values[kInputDistributionIndexG],
+			values[kInputDistributionIndexB],
+			values[kInputDistributionIndexM],
+			state->prefactor,
+			state->sqrtArgument,
+			state->bracket,
+			outputs,
+			count);
+	}
+	else if (run->isRegimeSwitchingEnabled)
+	{
+		state->numberOfStronglyCoupledSamples += computeBrownHamModelRegimeSwitchingOutputBatch(
+								values[kInputDistributionIndexGamma],
+								values[kInputDistributionIndexPhi],
+								values[kInputDistributionIndexRs],
+								values[kInputDistributionIndexG],
+								values[kInputDistributionIndexB],
+								values[kInputDistributionIndexM],
+								outputs,
+								count);
+	}
+	else if (!run->isPartialsEnabled && !run->isParameterDerivativesEnabled)
+	{
+		computeBrownHamModelOutputBatch(
+			values[kInputDistributionIndexGamma],
+			values[kInputDistributionIndexPhi],
+			values[kInputDistributionIndexRs],
+			values[kInputDistributionIndexG],
+			values[kInputDistributionIndexB],
+			values[kInputDistributionIndexM],
+			outputs,
+			count);
+	}
+
+	/*
+	 *	The dual-number kernel also writes the outputs, with the same values.
+	 */
+	if (run->isPartialsEnabled || run->isParameterDerivativesEnabled)
+	{
+		computeBrownHamModelOutputAndPartialsBatch(
+			values[kInputDistributionIndexGamma],
+			values[kInputDistributionIndexPhi],
+			values[kInputDistributionIndexRs],
+			values[kInputDistributionIndexG],
+			values[kInputDistributionIndexB],
+			values[kInputDistributionIndexM],
+			outputs,
+			&state->partials[0][0],
+			kInputSampleBlockSize,
+			count);
+	}
+
+	monteCarloRunCheckOutputDomain(run, state, outputs, count);
+
+	if (run->isPartialsEnabled)
+	{
+		for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+		{
+			streamingHistogramAddArray(&state->partialDistributions[j], state->partials[j], count);
+		}
+	}
+
+	/*
+	 *	By the chain rule, the pathwise derivative of each output with respect to a
+	 *	parameter is its partial with respect to the input times the derivative of
+	 *	the input sample with respect to the parameter. The sample derivative for a
+	 *	mixture weight divides by the density between the modes, so for independent
+	 *	inputs, weights use the likelihood-ratio estimator `σc * ∂log f/∂w` instead.
+	 *	Non-finite outputs are left out.
+	 */
+	if (run->isParameterDerivativesEnabled)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			state->numberOfFiniteSamples += isfinite(outputs[i]);
+		}
+
+		for (size_t p = 0; p < run->numberOfParameters; p++)
+		{
+			InputDistributionIndex		d = run->parameterInputIndices[p];
+			const InputDistribution *	distribution = &run->sampler.distributions[d];
+			const double *			factors = state->partials[kInputPartialIndices[d]];
+			double				sum = 0.0;
+			double				squaredSum = 0.0;
+
+			if ((distribution->kind == kInputDistributionKindGaussianMixture) &&
+				(run->parameterIndices[p] >= 2 * distribution->numberOfComponents) &&
+				!run->sampler.isCorrelated[d])
+			{
+				factors = outputs;
+				inputDistributionFillWeightScores(
+					distribution,
+					run->parameterIndices[p] - 2 * distribution->numberOfComponents,
+					values[d],
+					state->sampleDerivatives,
+					count);
+			}
+			else
+			{
+				inputDistributionFillSampleDerivatives(
+					distribution,
+					run->parameterIndices[p],
+					values[d],
+					state->sampleDerivatives,
+					count);
+			}
+
+			#pragma omp simd reduction(+:sum, squaredSum)
+			for (size_t i = 0; i < count; i++)
+			{
+				double	derivative = factors[i] * state->sampleDerivatives[i];
+
+				derivative = isfinite(outputs[i]) ? derivative : 0.0;
+				sum += derivative;
+				squaredSum += derivative * derivative;
+			}
+
+			state->parameterDerivativeSums[p] += sum;
+			state->parameterDerivativeSquaredSums[p] += squaredSum;
+		}
+	}
+
+	if (run->isTraceDistributionsEnabled)
+	{
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexGamma], values[kInputDistributionIndexGamma], count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexPhi], values[kInputDistributionIndexPhi], count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexRs], values[kInputDistributionIndexRs], count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexG], values[kInputDistributionIndexG], count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexB], values[kInputDistributionIndexB], count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexM], values[kInputDistributionIndexM], count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexPrefactor], state->prefactor, count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexSqrtArgument], state->sqrtArgument, count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexBracket], state->bracket, count);
+		streamingHistogramAddArray(&state->traceDistributions[kTraceDistributionIndexSigma], outputs, count);
+	}
+
+	if (run->isOutputDistributionEnabled)
+	{
+		streamingHistogramAddArray(&state->outputDistribution, outputs, count);
+	}
+
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		if (inputSamples[d] != NULL)
+		{
+			memcpy(inputSamples[d], values[d], count * sizeof(double));
+		}
+	}
+
+	if (run->isTracingEnabled)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const double	traceValues[kTraceValueIndexMax] = {
+						[kTraceValueIndexGamma]	= values[kInputDistributionIndexGamma][i],
+						[kTraceValueIndexPhi]	= values[kInputDistributionIndexPhi][i],
+						[kTraceValueIndexRs]	= values[kInputDistributionIndexRs][i],
+						[kTraceValueIndexG]	= values[kInputDistributionIndexG][i],
+						[kTraceValueIndexB]	= values[kInputDistributionIndexB][i],
+						[kTraceValueIndexM]	= values[kInputDistributionIndexM][i],
+						[kTraceValueIndexSigma]	= outputs[i],
+					};
+
+			traceRingBufferRecord(&state->traceRingBuffer, firstSampleIndex + i, traceValues);
+		}
+	}
+
+	return;
+}
+
+void
+monteCarloRunExecute(MonteCarloRun *  run, double *  outputSamples, size_t numberOfSamples)
+{
+	size_t	numberOfBlocks = (numberOfSamples + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+
+	#pragma omp parallel for schedule(static)
+	for (size_t blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+	{
+		size_t	first = blockIndex * kInputSampleBlockSize;
+		size_t	count = (numberOfSamples - first < kInputSampleBlockSize) ? (numberOfSamples - first) : kInputSampleBlockSize;
+		double *	inputSamples[kInputDistributionIndexMax];
+
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			inputSamples[d] = (run->inputSamples[d] != NULL) ? &run->inputSamples[d][first] : NULL;
+		}
+
+		monteCarloRunExecuteBlock(
+			run,
+			&run->threadStates[getThreadIndex()],
+			run->nextBlockIndex + blockIndex,
+			run->nextBlockIndex * kInputSampleBlockSize + first,
+			&outputSamples[first],
+			inputSamples,
+			count);
+	}
+
+	/*
+	 *	Merge the per-thread partial results and reset them for the next call.
+	 */
+	for (size_t t = 0; t < run->numberOfThreads; t++)
+	{
+		MonteCarloThreadState *	state = &run->threadStates[t];
+
+		if (run->isTraceDistributionsEnabled)
+		{
+			for (size_t i = 0; i < kTraceDistributionIndexMax; i++)
+			{
+				streamingHistogramMerge(&run->traceDistributions[i], &state->traceDistributions[i]);
+				streamingHistogramInit(&state->traceDistributions[i]);
+			}
+		}
+
+		if (run->isOutputDistributionEnabled)
+		{
+			streamingHistogramMerge(&run->outputDistribution, &state->outputDistribution);
+			streamingHistogramInit(&state->outputDistribution);
+		}
+
+		if (run->isPartialsEnabled)
+		{
+			for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+			{
+				streamingHistogramMerge(&run->partialDistributions[j], &state->partialDistributions[j]);
+				streamingHistogramInit(&state->partialDistributions[j]);
+			}
+		}
+
+		if (run->isParameterDerivativesEnabled)
+		{
+			for (size_t p = 0; p < run->numberOfParameters; p++)
+			{
+				run->parameterDerivativeSums[p] += state->parameterDerivativeSums[p];
+				run->parameterDerivativeSquaredSums[p] += state->parameterDerivativeSquaredSums[p];
+				state->parameterDerivativeSums[p] = 0.0;
+				state->parameterDerivativeSquaredSums[p] = 0.0;
+			}
+			run->numberOfFiniteSamples += state->numberOfFiniteSamples;
+			state->numberOfFiniteSamples = 0;
+		}
+
+		run->numberOfStronglyCoupledSamples += state->numberOfStronglyCoupledSamples;
+		state->numberOfStronglyCoupledSamples = 0;
+		run->numberOfNonFiniteOutputs += state->numberOfNonFiniteOutputs;
+		state->numberOfNonFiniteOutputs = 0;
+		run->numberOfNegativeOutputs += state->numberOfNegativeOutputs;
+		state->numberOfNegativeOutputs = 0;
+	}
+
+	run->nextBlockIndex += numberOfBlocks;
+	run->numberOfSamples += numberOfSamples;
+
+	return;
+}
+
+size_t
+monteCarloRunDropNonFiniteSamples(MonteCarloRun *  run, double *  outputSamples, size_t numberOfSamples)
+{
+	size_t	numberOfKeptSamples = 0;
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		if (!isfinite(outputSamples[i]))
+		{
+			continue;
+		}
+
+		outputSamples[numberOfKeptSamples] = outputSamples[i];
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			if (run->inputSamples[d] != NULL)
+			{
+				run->inputSamples[d][numberOfKeptSamples] = run->inputSamples[d][i];
+			}
+		}
+		numberOfKeptSamples++;
+	}
+
+	return numberOfKeptSamples;
+}
+
+size_t
+monteCarloRunGetParameterDerivatives(const MonteCarloRun *  run, ParameterDerivative *  parameterDerivatives)
+{
+	double	n = (double) run->numberOfFiniteSamples;
+
+	for (size_t p = 0; p < run->numberOfParameters; p++)
+	{
+		double	mean = run->parameterDerivativeSums[p] / n;
+		double	variance = fmax(run->parameterDerivativeSquaredSums[p] / n - mean * mean, 0.0);
+
+		parameterDerivatives[p].inputIndex = run->parameterInputIndices[p];
+		inputDistributionGetParameterName(
+			&run->sampler.distributions[run->parameterInputIndices[p]],
+			run->parameterIndices[p],
+			parameterDerivatives[p].parameterName,
+			sizeof(parameterDerivatives[p].parameterName));
+		parameterDerivatives[p].values[0] = mean;
+		parameterDerivatives[p].values[1] = sqrt(variance / n);
+	}
+
+	return run->numberOfParameters;
+}
+
+void
+monteCarloRunDecodeTraces(const MonteCarloRun *  run, FILE *  stream)
+{
+	TraceRingBuffer *	ringBuffers;
+
+	if (!run->isTracingEnabled)
+	{
+		return;
+	}
+
+	ringBuffers = (TraceRingBuffer *) checkedMalloc(run->numberOfThreads * sizeof(TraceRingBuffer), __FILE__, __LINE__);
+	for (size_t t = 0; t < run->numberOfThreads; t++)
+	{
+		ringBuffers[t] = run->threadStates[t].traceRingBuffer;
+	}
+
+	traceRingBufferDecode(ringBuffers, run->numberOfThreads, stream);
+	free(ringBuffers);
+
+	return;
+}
+
+void
+monteCarloRunFree(MonteCarloRun *  run)
+{
+	if (run->threadStates == NULL)
+	{
+		return;
+	}
+
+	for (size_t t = 0; t < run->numberOfThreads; t++)
+	{
+		if (run->isTracingEnabled)
+		{
+			traceRingBufferFree(&run->threadStates[t].traceRingBuffer);
+		}
+	}
+
+	free(run->threadStates);
+	run->threadStates = NULL;
+
+	return;
+}
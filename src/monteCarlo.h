@@ -0,0 +1,171 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+#include "sampling.h"
+#include "histogram.h"
+#include "trace.h"
+#include "particleSizeDistribution.h"
+#include "brownHamModel.h"
+
+
+/*
+ *	Scratch space and partial results owned by one thread of a native Monte
+ *	Carlo run. Threads never share a state, and the partial results are merged
+ *	into the `MonteCarloRun` when the run is over.
+ */
+typedef struct MonteCarloThreadState
+{
+	InputSampleBlock	inputs;
+	double			prefactor[kInputSampleBlockSize];
+	double			sqrtArgument[kInputSampleBlockSize];
+	double			bracket[kInputSampleBlockSize];
+	double			partials[kBrownHamModelPartialIndexMax][kInputSampleBlockSize];
+	double			sampleDerivatives[kInputSampleBlockSize];
+	double			parameterDerivativeSums[kMaximumNumberOfParameterDerivatives];
+	double			parameterDerivativeSquaredSums[kMaximumNumberOfParameterDerivatives];
+	uint64_t		numberOfFiniteSamples;
+	uint64_t		numberOfStronglyCoupledSamples;
+	uint64_t		numberOfNonFiniteOutputs;
+	uint64_t		numberOfNegativeOutputs;
+	TraceRingBuffer		traceRingBuffer;
+	StreamingHistogram	traceDistributions[kTraceDistributionIndexMax];
+	StreamingHistogram	outputDistribution;
+	StreamingHistogram	partialDistributions[kBrownHamModelPartialIndexMax];
+} MonteCarloThreadState;
+
+/*
+ *	State of a native Monte Carlo run. Successive calls to `monteCarloRunExecute()`
+ *	continue from block `nextBlockIndex`, so that they draw from fresh streams and
+ *	accumulate into the same distributions. If the caller sets `inputSamples[d]`,
+ *	`monteCarloRunExecute()` also stores the samples of input `d` there, indexed
+ *	like the output samples. With `isParameterDerivativesEnabled`, the run also
+ *	sums the pathwise derivative of each finite output with respect to every
+ *	parameter of the input distributions. With `isRegimeSwitchingEnabled`, the
+ *	kernel selects the pair-coupling regime per sample and the run counts the
+ *	samples with strongly coupled pairs. The run always counts the non-finite and
+ *	the negative outputs, and `outputDomainPolicy` decides whether they are kept,
+ *	replaced by NAN for `monteCarloRunDropNonFiniteSamples()` to remove, or clamped to zero.
+ */
+typedef struct MonteCarloRun
+{
+	InputSampler		sampler;
+	uint64_t		seed;
+	bool			isTracingEnabled;
+	bool			isTraceDistributionsEnabled;
+	bool			isParticleSizeDistributionEnabled;
+	ParticleSizeDistribution	particleSizeDistribution;
+	bool			isOutputDistributionEnabled;
+	bool			isPartialsEnabled;
+	bool			isParameterDerivativesEnabled;
+	bool			isRegimeSwitchingEnabled;
+	uint64_t		numberOfStronglyCoupledSamples;
+	OutputDomainPolicy	outputDomainPolicy;
+	uint64_t		numberOfNonFiniteOutputs;
+	uint64_t		numberOfNegativeOutputs;
+	size_t			numberOfParameters;
+	InputDistributionIndex	parameterInputIndices[kMaximumNumberOfParameterDerivatives];
+	size_t			parameterIndices[kMaximumNumberOfParameterDerivatives];
+	double			parameterDerivativeSums[kMaximumNumberOfParameterDerivatives];
+	double			parameterDerivativeSquaredSums[kMaximumNumberOfParameterDerivatives];
+	uint64_t		numberOfFiniteSamples;
+	uint64_t		nextBlockIndex;
+	uint64_t		numberOfSamples;
+	double *		inputSamples[kInputDistributionIndexMax];
+	size_t			numberOfThreads;
+	MonteCarloThreadState *	threadStates;
+	StreamingHistogram	traceDistributions[kTraceDistributionIndexMax];
+	StreamingHistogram	outputDistribution;
+	StreamingHistogram	partialDistributions[kBrownHamModelPartialIndexMax];
+} MonteCarloRun;
+
+/**
+ *	@brief	Set up a native Monte Carlo run: the input sampler and the per-thread states.
+ *
+ *	@param	run		: Pointer to the run.
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	monteCarloRunInit(MonteCarloRun *  run, const CommandLineArguments *  arguments);
+
+/**
+ *	@brief	Draw the inputs and evaluate the kernel in blocks of `kInputSampleBlockSize`
+ *		samples, in parallel when built with OpenMP, then merge the per-thread results
+ *		into the distributions of the run.
+ *
+ *	@param	run			: Pointer to the run.
+ *	@param	outputSamples	 	: Array to store the `numberOfSamples` output samples.
+ *	@param	numberOfSamples		: Number of Monte Carlo iterations.
+ */
+void	monteCarloRunExecute(MonteCarloRun *  run, double *  outputSamples, size_t numberOfSamples);
+
+/**
+ *	@brief	Remove the non-finite output samples, and the input samples stored with them,
+ *		keeping the order of the rest (e.g., after a run with `kOutputDomainPolicyDrop`).
+ *
+ *	@param	run			: Pointer to the run.
+ *	@param	outputSamples		: Array of `numberOfSamples` output samples to compact in place.
+ *	@param	numberOfSamples		: Number of samples.
+ *	@return				: The number of samples kept.
+ */
+size_t	monteCarloRunDropNonFiniteSamples(MonteCarloRun *  run, double *  outputSamples, size_t numberOfSamples);
+
+/**
+ *	@brief	Hash everything that determines the samples a run draws: the seed, the input
+ *		distributions, the Gaussian-copula factor, and the particle-size distribution.
+ *
+ *	@param	run	: Pointer to a run set up with `monteCarloRunInit()`.
+ *	@return		: 64-bit FNV-1a hash of the configuration.
+ */
+uint64_t	monteCarloRunGetConfigurationHash(const MonteCarloRun *  run);
+
+/**
+ *	@brief	Get the derivatives of the mean output with respect to the parameters of the
+ *		input distributions, averaged over the finite outputs of the run.
+ *
+ *	@param	run			: Pointer to a run with `isParameterDerivativesEnabled`.
+ *	@param	parameterDerivatives	: Array of at least `kMaximumNumberOfParameterDerivatives` entries to store the derivatives.
+ *	@return				: The number of derivatives stored.
+ */
+size_t	monteCarloRunGetParameterDerivatives(const MonteCarloRun *  run, ParameterDerivative *  parameterDerivatives);
+
+/**
+ *	@brief	Render the traces of all threads as text.
+ *
+ *	@param	run	: Pointer to the run.
+ *	@param	stream	: Stream to print to.
+ */
+void	monteCarloRunDecodeTraces(const MonteCarloRun *  run, FILE *  stream);
+
+/**
+ *	@brief	Free the allocations of a native Monte Carlo run.
+ *
+ *	@param	run	: Pointer to the run.
+ */
+void	monteCarloRunFree(MonteCarloRun *  run);
@@ -0,0 +1,259 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "outOfCore.h"
+#include "monteCarlo.h"
+#include "common.h"
+
+
+static const double	kOutOfCoreProbabilities[] = {0.0, 0.01, 0.05, 0.25, 0.50, 0.75, 0.95, 0.99, 1.0};
+static const char * const	kOutOfCoreQuantileNames[] = {"min", "p01", "p05", "p25", "p50", "p75", "p95", "p99", "max"};
+
+#define	kOutOfCoreNumberOfQuantiles	(sizeof(kOutOfCoreProbabilities) / sizeof(kOutOfCoreProbabilities[0]))
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	valueA = *(const double *) a;
+	double	valueB = *(const double *) b;
+
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+CommonConstantReturnType
+runOutOfCore(const CommandLineArguments *  arguments)
+{
+	MonteCarloRun	run;
+	size_t		numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	size_t		chunkCapacity = arguments->outOfCoreMemoryLimit / sizeof(double) / kInputSampleBlockSize * kInputSampleBlockSize;
+	size_t		numberOfChunks = (numberOfSamples + chunkCapacity - 1) / chunkCapacity;
+	size_t		numberOfThreads = 1;
+	double *	chunk;
+	SortedRunFile	spillFile;
+	SortedRun *	runs;
+	size_t		numberOfRuns = 0;
+	size_t		numberOfMergePasses = 0;
+	uint64_t	numberOfFiniteSamples = 0;
+	uint64_t	numberOfNonFiniteSamples;
+	uint64_t	numberOfSortedRuns;
+	double		mean = 0.0;
+	double		m2 = 0.0;
+	double		statistics[2 + kOutOfCoreNumberOfQuantiles];
+	clock_t		start = clock();
+	double		cpuTimeUsedInSeconds;
+
+#ifdef _OPENMP
+	numberOfThreads = (size_t) omp_get_max_threads();
+#endif
+
+	if (monteCarloRunInit(&run, arguments) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (sortedRunFileCreate(&spillFile, arguments->outOfCoreDirectory) != kCommonConstantReturnTypeSuccess)
+	{
+		monteCarloRunFree(&run);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	chunk = (double *) checkedMalloc(chunkCapacity * sizeof(double), __FILE__, __LINE__);
+	runs = (SortedRun *) checkedMalloc(numberOfChunks * numberOfThreads * sizeof(SortedRun), __FILE__, __LINE__);
+
+	/*
+	 *	Successive chunks continue the block streams of the run, so the samples are
+	 *	the same as those of an in-memory run with the same seed. Each chunk drops
+	 *	its non-finite samples, is sorted in one slice per thread, and is spilled,
+	 *	with all the runs in one file.
+	 */
+	for (size_t c = 0; c < numberOfChunks; c++)
+	{
+		size_t	count = (numberOfSamples - c * chunkCapacity < chunkCapacity) ? (numberOfSamples - c * chunkCapacity) : chunkCapacity;
+		size_t	numberOfFiniteInChunk = 0;
+		size_t	sliceSize;
+		double	chunkMean = 0.0;
+		double	chunkM2 = 0.0;
+		double	delta;
+
+		monteCarloRunExecute(&run, chunk, count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (isfinite(chunk[i]))
+			{
+				chunk[numberOfFiniteInChunk++] = chunk[i];
+				chunkMean += chunk[i];
+			}
+		}
+
+		if (numberOfFiniteInChunk == 0)
+		{
+			continue;
+		}
+
+		/*
+		 *	Combine the exact moments of the chunk with those of the earlier chunks (Chan et al.).
+		 */
+		chunkMean /= numberOfFiniteInChunk;
+		for (size_t i = 0; i < numberOfFiniteInChunk; i++)
+		{
+			chunkM2 += (chunk[i] - chunkMean) * (chunk[i] - chunkMean);
+		}
+		delta = chunkMean - mean;
+		m2 += chunkM2 + delta * delta * ((double) numberOfFiniteSamples * numberOfFiniteInChunk / (numberOfFiniteSamples + numberOfFiniteInChunk));
+		mean += delta * numberOfFiniteInChunk / (numberOfFiniteSamples + numberOfFiniteInChunk);
+		numberOfFiniteSamples += numberOfFiniteInChunk;
+
+		sliceSize = (numberOfFiniteInChunk + numberOfThreads - 1) / numberOfThreads;
+
+		#pragma omp parallel for schedule(static)
+		for (size_t t = 0; t < numberOfThreads; t++)
+		{
+			size_t	first = t * sliceSize;
+
+			if (first < numberOfFiniteInChunk)
+			{
+				qsort(&chunk[first], (numberOfFiniteInChunk - first < sliceSize) ? (numberOfFiniteInChunk - first) : sliceSize, sizeof(double), compareDoubles);
+			}
+		}
+
+		for (size_t first = 0; first < numberOfFiniteInChunk; first += sliceSize)
+		{
+			size_t	sliceCount = (numberOfFiniteInChunk - first < sliceSize) ? (numberOfFiniteInChunk - first) : sliceSize;
+
+			sortedRunCreate(&runs[numberOfRuns], &spillFile);
+			if (sortedRunAppend(&runs[numberOfRuns], &chunk[first], sliceCount) != kCommonConstantReturnTypeSuccess)
+			{
+				sortedRunFileFree(&spillFile);
+				free(chunk);
+				free(runs);
+				monteCarloRunFree(&run);
+
+				return kCommonConstantReturnTypeError;
+			}
+			numberOfRuns++;
+		}
+	}
+
+	/*
+	 *	The chunk is the workspace of the merge, so the memory limit holds throughout.
+	 */
+	numberOfSortedRuns = numberOfRuns;
+	if (sortedRunsMerge(
+			runs,
+			numberOfRuns,
+			arguments->outOfCoreDirectory,
+			chunk,
+			chunkCapacity,
+			kOutOfCoreProbabilities,
+			kOutOfCoreNumberOfQuantiles,
+			&statistics[2],
+			NULL,
+			&numberOfMergePasses) != kCommonConstantReturnTypeSuccess)
+	{
+		sortedRunFileFree(&spillFile);
+		free(chunk);
+		free(runs);
+		monteCarloRunFree(&run);
+
+		return kCommonConstantReturnTypeError;
+	}
+	sortedRunFileFree(&spillFile);
+
+	statistics[0] = (numberOfFiniteSamples > 0) ? mean : NAN;
+	statistics[1] = (numberOfFiniteSamples > 1) ? sqrt(m2 / (numberOfFiniteSamples - 1)) : 0.0;
+	numberOfNonFiniteSamples = numberOfSamples - numberOfFiniteSamples;
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	monteCarloRunDecodeTraces(&run, stdout);
+
+	if (arguments->common.isOutputJSONMode)
+	{
+		JSONVariable	variables[] = {
+			{
+				.variableSymbol = "sigmaCMpa",
+				.variableDescription = "Cutting stress (σc) (mean, standard deviation, min, 1st, 5th, 25th, 50th, 75th, 95th, and 99th percentiles, max)",
+				.values = (JSONVariablePointer) { .asDouble = statistics},
+				.type = kJSONVariableTypeDouble,
+				.size = 2 + kOutOfCoreNumberOfQuantiles,
+			},
+			{
+				.variableSymbol = "numberOfNonFiniteSamples",
+				.variableDescription = "Number of non-finite output samples, left out of the statistics",
+				.values = (JSONVariablePointer) { .asUint64 = &numberOfNonFiniteSamples},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "numberOfSortedRuns",
+				.variableDescription = "Number of sorted runs spilled to disk",
+				.values = (JSONVariablePointer) { .asUint64 = &numberOfSortedRuns},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "cpuTimeUsed",
+				.variableDescription = "CPU time used (s)",
+				.values = (JSONVariablePointer) { .asDouble = &cpuTimeUsedInSeconds},
+				.type = kJSONVariableTypeDoubleParticle,
+				.size = 1,
+			},
+		};
+
+		printJSONVariables(variables, arguments->common.isTimingEnabled ? 4 : 3, "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	}
+	else
+	{
+		printf("Sorted %zu samples (%" PRIu64 " non-finite) out of core in %" PRIu64 " runs, merged in %zu passes.\n",
+			numberOfSamples,
+			numberOfNonFiniteSamples,
+			numberOfSortedRuns,
+			numberOfMergePasses);
+		printf("Cutting stress (σc): mean %le, standard deviation %le MPa\n", statistics[0], statistics[1]);
+		for (size_t j = 0; j < kOutOfCoreNumberOfQuantiles; j++)
+		{
+			printf("Cutting stress (σc) %s = %le MPa\n", kOutOfCoreQuantileNames[j], statistics[2 + j]);
+		}
+
+		if (arguments->common.isTimingEnabled)
+		{
+			printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+		}
+	}
+
+	free(chunk);
+	free(runs);
+	monteCarloRunFree(&run);
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,546 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "parameterStudy.h"
+#include "brownHamModel.h"
+#include "histogram.h"
+#include "sampling.h"
+#include "common.h"
+
+
+/*
+ *	Inputs in the order of the columns of the results table. In a Cartesian
+ *	product, the last listed input varies fastest.
+ */
+static const InputDistributionIndex	kParameterStudyColumns[kInputDistributionIndexMax] = {
+						kInputDistributionIndexGamma,
+						kInputDistributionIndexPhi,
+						kInputDistributionIndexRs,
+						kInputDistributionIndexG,
+						kInputDistributionIndexB,
+						kInputDistributionIndexM,
+					};
+
+static const char * const	kInputVariableNames[kInputDistributionIndexMax] = {
+					[kInputDistributionIndexB]	= "b",
+					[kInputDistributionIndexG]	= "G",
+					[kInputDistributionIndexGamma]	= "gamma",
+					[kInputDistributionIndexM]	= "M",
+					[kInputDistributionIndexPhi]	= "phi",
+					[kInputDistributionIndexRs]	= "Rs",
+				};
+
+typedef enum
+{
+	kParameterStudyStatisticMean	= 0,
+	kParameterStudyStatisticStandardDeviation,
+	kParameterStudyStatisticMin,
+	kParameterStudyStatisticP05,
+	kParameterStudyStatisticP50,
+	kParameterStudyStatisticP95,
+	kParameterStudyStatisticMax,
+	kParameterStudyStatisticIndexMax,
+} ParameterStudyStatistic;
+
+/*
+ *	Statistics of the output at one point of a Monte Carlo parameter study. Only
+ *	the histograms of the points being evaluated are kept, so memory does not
+ *	grow with the number of points by more than one summary each.
+ */
+typedef struct ParameterStudySummary
+{
+	uint64_t	count;
+	uint64_t	nonFiniteCount;
+	double		statistics[kParameterStudyStatisticIndexMax];
+} ParameterStudySummary;
+
+/*
+ *	Scratch space owned by one thread of a Monte Carlo parameter study.
+ */
+typedef struct ParameterStudyWorkspace
+{
+	InputSampleBlock	inputs;
+	double			fixedInputs[kInputDistributionIndexMax][kInputSampleBlockSize];
+	double			outputs[kInputSampleBlockSize];
+	StreamingHistogram	histograms[kParameterStudyTileSize];
+} ParameterStudyWorkspace;
+
+/*
+ *	Parse the items of a list of values. If `values` is NULL, only count them.
+ */
+static CommonConstantReturnType
+parseParameterStudyItems(const char *  string, double *  values, size_t *  numberOfValues)
+{
+	const char *	cursor = string;
+
+	*numberOfValues = 0;
+	for (;;)
+	{
+		char *		end;
+		double		start = strtod(cursor, &end);
+		double		stop;
+		unsigned long	count = 1;
+
+		if (end == cursor)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		stop = start;
+		if (*end == ':')
+		{
+			cursor = end + 1;
+			stop = strtod(cursor, &end);
+			if ((end == cursor) || (*end != ':'))
+			{
+				return kCommonConstantReturnTypeError;
+			}
+
+			cursor = end + 1;
+			count = strtoul(cursor, &end, 10);
+			if ((end == cursor) || (count == 0) || (count > kParameterStudyMaximumNumberOfPoints))
+			{
+				return kCommonConstantReturnTypeError;
+			}
+		}
+
+		if ((*end != ',') && (*end != '\0'))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t i = 0; (values != NULL) && (i < count); i++)
+		{
+			values[*numberOfValues + i] = (count == 1) ? start : (start + (stop - start) * i / (count - 1));
+		}
+		*numberOfValues += count;
+
+		if (*numberOfValues > kParameterStudyMaximumNumberOfPoints)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (*end == '\0')
+		{
+			return kCommonConstantReturnTypeSuccess;
+		}
+		cursor = end + 1;
+	}
+}
+
+CommonConstantReturnType
+parseParameterStudyValues(const char *  string, double **  values, size_t *  numberOfValues)
+{
+	*values = NULL;
+	if (parseParameterStudyItems(string, NULL, numberOfValues) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	*values = (double *) checkedMalloc(*numberOfValues * sizeof(double), __FILE__, __LINE__);
+
+	return parseParameterStudyItems(string, *values, numberOfValues);
+}
+
+uint64_t
+parameterStudyGetNumberOfPoints(const CommandLineArguments *  arguments)
+{
+	uint64_t	numberOfPoints = 1;
+
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		uint64_t	numberOfValues = arguments->parameterStudyNumberOfValues[d];
+
+		if (numberOfValues <= 1)
+		{
+			continue;
+		}
+
+		if (arguments->isParameterStudyZipped)
+		{
+			if ((numberOfPoints != 1) && (numberOfPoints != numberOfValues))
+			{
+				return 0;
+			}
+			numberOfPoints = numberOfValues;
+		}
+		else
+		{
+			if (numberOfPoints > kParameterStudyMaximumNumberOfPoints / numberOfValues)
+			{
+				return 0;
+			}
+			numberOfPoints *= numberOfValues;
+		}
+	}
+
+	return numberOfPoints;
+}
+
+/*
+ *	Get the values of the listed inputs at point `point`, leaving the other entries as they are.
+ */
+static void
+getParameterStudyPoint(const CommandLineArguments *  arguments, uint64_t point, double *  values)
+{
+	for (size_t c = kInputDistributionIndexMax; c-- > 0;)
+	{
+		InputDistributionIndex	d = kParameterStudyColumns[c];
+		uint64_t		numberOfValues = arguments->parameterStudyNumberOfValues[d];
+
+		if (numberOfValues == 0)
+		{
+			continue;
+		}
+
+		if (arguments->isParameterStudyZipped)
+		{
+			values[d] = arguments->parameterStudyValues[d][(numberOfValues == 1) ? 0 : point];
+		}
+		else
+		{
+			values[d] = arguments->parameterStudyValues[d][point % numberOfValues];
+			point /= numberOfValues;
+		}
+	}
+
+	return;
+}
+
+static void
+printParameterStudyHeader(FILE *  stream, bool isMonteCarloMode, bool isCSV)
+{
+	for (size_t c = 0; c < kInputDistributionIndexMax; c++)
+	{
+		fprintf(stream, isCSV ? "%s," : "%14s ", kInputVariableNames[kParameterStudyColumns[c]]);
+	}
+
+	if (!isMonteCarloMode)
+	{
+		fprintf(stream, isCSV ? "%s\n" : "%14s\n", "sigmaCMpa");
+	}
+	else if (isCSV)
+	{
+		fprintf(stream, "count,mean,stddev,min,p05,p50,p95,max,nonFinite\n");
+	}
+	else
+	{
+		fprintf(stream, "%12s %14s %14s %14s %14s %14s %14s %14s %12s\n",
+			"count", "mean", "stddev", "min", "p05", "p50", "p95", "max", "nonFinite");
+	}
+
+	return;
+}
+
+static void
+printParameterStudyInputs(FILE *  stream, const double *  inputs, bool isCSV)
+{
+	for (size_t c = 0; c < kInputDistributionIndexMax; c++)
+	{
+		fprintf(stream, isCSV ? "%le," : "%14le ", inputs[kParameterStudyColumns[c]]);
+	}
+
+	return;
+}
+
+static void
+printParameterStudySummary(FILE *  stream, const ParameterStudySummary *  summary, bool isCSV)
+{
+	const double *	s = summary->statistics;
+	const char *	format = isCSV ?
+				"%" PRIu64 ",%le,%le,%le,%le,%le,%le,%le,%" PRIu64 "\n" :
+				"%12" PRIu64 " %14le %14le %14le %14le %14le %14le %14le %12" PRIu64 "\n";
+
+	fprintf(stream, format,
+		summary->count,
+		s[kParameterStudyStatisticMean],
+		s[kParameterStudyStatisticStandardDeviation],
+		s[kParameterStudyStatisticMin],
+		s[kParameterStudyStatisticP05],
+		s[kParameterStudyStatisticP50],
+		s[kParameterStudyStatisticP95],
+		s[kParameterStudyStatisticMax],
+		summary->nonFiniteCount);
+
+	return;
+}
+
+/*
+ *	Evaluate the points in chunks of `kInputSampleBlockSize`, with the batched
+ *	kernel running across points.
+ */
+static void
+evaluateParameterStudyPoints(const CommandLineArguments *  arguments, uint64_t numberOfPoints, double *  outputs)
+{
+	uint64_t	numberOfChunks = (numberOfPoints + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+	double		defaults[kInputDistributionIndexMax] = {
+				[kInputDistributionIndexB]	= arguments->b,
+				[kInputDistributionIndexG]	= arguments->G,
+				[kInputDistributionIndexGamma]	= arguments->gamma,
+				[kInputDistributionIndexM]	= arguments->M,
+				[kInputDistributionIndexPhi]	= arguments->phi,
+				[kInputDistributionIndexRs]	= arguments->Rs,
+			};
+
+	#pragma omp parallel for schedule(static)
+	for (uint64_t chunk = 0; chunk < numberOfChunks; chunk++)
+	{
+		uint64_t	first = chunk * kInputSampleBlockSize;
+		size_t		count = (numberOfPoints - first < kInputSampleBlockSize) ? (size_t) (numberOfPoints - first) : kInputSampleBlockSize;
+		double		inputs[kInputDistributionIndexMax][kInputSampleBlockSize];
+
+		for (size_t i = 0; i < count; i++)
+		{
+			double	point[kInputDistributionIndexMax];
+
+			memcpy(point, defaults, sizeof(point));
+			getParameterStudyPoint(arguments, first + i, point);
+			for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+			{
+				inputs[d][i] = point[d];
+			}
+		}
+
+		computeBrownHamModelOutputBatch(
+			inputs[kInputDistributionIndexGamma],
+			inputs[kInputDistributionIndexPhi],
+			inputs[kInputDistributionIndexRs],
+			inputs[kInputDistributionIndexG],
+			inputs[kInputDistributionIndexB],
+			inputs[kInputDistributionIndexM],
+			&outputs[first],
+			count);
+	}
+
+	return;
+}
+
+/*
+ *	Evaluate the points in tiles of `kParameterStudyTileSize`. Each block of
+ *	samples is drawn once per tile, from the same stream for every tile, and the
+ *	listed inputs replace their columns of the block at each point.
+ */
+static CommonConstantReturnType
+summarizeParameterStudyPoints(const CommandLineArguments *  arguments, uint64_t numberOfPoints, ParameterStudySummary *  summaries)
+{
+	InputSampler	sampler;
+	size_t		numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	size_t		numberOfBlocks = (numberOfSamples + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+	uint64_t	numberOfTiles = (numberOfPoints + kParameterStudyTileSize - 1) / kParameterStudyTileSize;
+
+	if (inputSamplerInit(
+			&sampler,
+			arguments->samplingDistributions,
+			kInputDistributionIndexMax,
+			arguments->isCorrelatedSamplingEnabled ? &arguments->correlationMatrix[0][0] : NULL) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: The correlation matrix is not positive definite.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	#pragma omp parallel
+	{
+		ParameterStudyWorkspace *	workspace = (ParameterStudyWorkspace *) checkedMalloc(sizeof(ParameterStudyWorkspace), __FILE__, __LINE__);
+
+		#pragma omp for schedule(dynamic)
+		for (uint64_t tile = 0; tile < numberOfTiles; tile++)
+		{
+			uint64_t	first = tile * kParameterStudyTileSize;
+			size_t		numberOfTilePoints = (numberOfPoints - first < kParameterStudyTileSize) ? (size_t) (numberOfPoints - first) : kParameterStudyTileSize;
+
+			for (size_t p = 0; p < numberOfTilePoints; p++)
+			{
+				streamingHistogramInit(&workspace->histograms[p]);
+			}
+
+			for (size_t blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+			{
+				SamplerRandomNumberGenerator	generator;
+				size_t				count = (numberOfSamples - blockIndex * kInputSampleBlockSize < kInputSampleBlockSize) ?
+									(numberOfSamples - blockIndex * kInputSampleBlockSize) : kInputSampleBlockSize;
+
+				samplerRandomNumberGeneratorInit(&generator, arguments->seed, blockIndex);
+				inputSamplerFillBlock(&sampler, &generator, &workspace->inputs, count);
+
+				for (size_t p = 0; p < numberOfTilePoints; p++)
+				{
+					double		point[kInputDistributionIndexMax] = {0};
+					const double *	inputs[kInputDistributionIndexMax];
+
+					getParameterStudyPoint(arguments, first + p, point);
+					for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+					{
+						double *	fixedInput = workspace->fixedInputs[d];
+
+						inputs[d] = workspace->inputs.values[d];
+						if (arguments->parameterStudyNumberOfValues[d] == 0)
+						{
+							continue;
+						}
+
+						#pragma omp simd
+						for (size_t i = 0; i < count; i++)
+						{
+							fixedInput[i] = point[d];
+						}
+						inputs[d] = fixedInput;
+					}
+
+					computeBrownHamModelOutputBatch(
+						inputs[kInputDistributionIndexGamma],
+						inputs[kInputDistributionIndexPhi],
+						inputs[kInputDistributionIndexRs],
+						inputs[kInputDistributionIndexG],
+						inputs[kInputDistributionIndexB],
+						inputs[kInputDistributionIndexM],
+						workspace->outputs,
+						count);
+					streamingHistogramAddArray(&workspace->histograms[p], workspace->outputs, count);
+				}
+			}
+
+			for (size_t p = 0; p < numberOfTilePoints; p++)
+			{
+				const StreamingHistogram *	histogram = &workspace->histograms[p];
+				ParameterStudySummary *		summary = &summaries[first + p];
+
+				summary->count = histogram->count;
+				summary->nonFiniteCount = histogram->nonFiniteCount;
+				summary->statistics[kParameterStudyStatisticMean] = (histogram->count > 0) ? histogram->mean : NAN;
+				summary->statistics[kParameterStudyStatisticStandardDeviation] = sqrt(streamingHistogramVariance(histogram));
+				summary->statistics[kParameterStudyStatisticMin] = histogram->min;
+				summary->statistics[kParameterStudyStatisticP05] = streamingHistogramQuantile(histogram, 0.05);
+				summary->statistics[kParameterStudyStatisticP50] = streamingHistogramQuantile(histogram, 0.50);
+				summary->statistics[kParameterStudyStatisticP95] = streamingHistogramQuantile(histogram, 0.95);
+				summary->statistics[kParameterStudyStatisticMax] = histogram->max;
+			}
+		}
+
+		free(workspace);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+runParameterStudy(const CommandLineArguments *  arguments)
+{
+	uint64_t		numberOfPoints = parameterStudyGetNumberOfPoints(arguments);
+	bool			isMonteCarloMode = arguments->common.isMonteCarloMode;
+	bool			isCSV = arguments->common.isWriteToFileEnabled;
+	double *		outputs = NULL;
+	ParameterStudySummary *	summaries = NULL;
+	FILE *			stream = stdout;
+	clock_t			start = clock();
+	double			cpuTimeUsedInSeconds;
+
+	if (isMonteCarloMode)
+	{
+		summaries = (ParameterStudySummary *) checkedMalloc(numberOfPoints * sizeof(ParameterStudySummary), __FILE__, __LINE__);
+		if (summarizeParameterStudyPoints(arguments, numberOfPoints, summaries) != kCommonConstantReturnTypeSuccess)
+		{
+			free(summaries);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else
+	{
+		outputs = (double *) checkedMalloc(numberOfPoints * sizeof(double), __FILE__, __LINE__);
+		evaluateParameterStudyPoints(arguments, numberOfPoints, outputs);
+	}
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	if (isCSV)
+	{
+		stream = fopen(arguments->common.outputFilePath, "w");
+		if (stream == NULL)
+		{
+			fprintf(stderr, "Error: Could not write to output CSV file \"%s\".\n", arguments->common.outputFilePath);
+			free(outputs);
+			free(summaries);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	printParameterStudyHeader(stream, isMonteCarloMode, isCSV);
+	for (uint64_t point = 0; point < numberOfPoints; point++)
+	{
+		double	inputs[kInputDistributionIndexMax] = {
+				[kInputDistributionIndexB]	= arguments->b,
+				[kInputDistributionIndexG]	= arguments->G,
+				[kInputDistributionIndexGamma]	= arguments->gamma,
+				[kInputDistributionIndexM]	= arguments->M,
+				[kInputDistributionIndexPhi]	= arguments->phi,
+				[kInputDistributionIndexRs]	= arguments->Rs,
+			};
+
+		/*
+		 *	In Monte Carlo mode, the unlisted inputs are sampled, so their columns are empty.
+		 */
+		if (isMonteCarloMode)
+		{
+			for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+			{
+				inputs[d] = NAN;
+			}
+		}
+
+		getParameterStudyPoint(arguments, point, inputs);
+		printParameterStudyInputs(stream, inputs, isCSV);
+		if (isMonteCarloMode)
+		{
+			printParameterStudySummary(stream, &summaries[point], isCSV);
+		}
+		else
+		{
+			fprintf(stream, isCSV ? "%le\n" : "%14le\n", outputs[point]);
+		}
+	}
+
+	if (stream != stdout)
+	{
+		fclose(stream);
+	}
+
+	if (arguments->common.isTimingEnabled)
+	{
+		printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+	}
+
+	free(outputs);
+	free(summaries);
+
+	return kCommonConstantReturnTypeSuccess;
+}
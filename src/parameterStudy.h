@@ -0,0 +1,69 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "common.h"
+#include "utilities.h"
+
+
+#define	kParameterStudyMaximumNumberOfPoints	(UINT64_C(1) << 32)
+#define	kParameterStudyTileSize			(64)
+
+/**
+ *	@brief	Parse the values of one input of a parameter study: a comma-separated list whose
+ *		items are real numbers or `start:stop:count` ranges of `count` evenly spaced values
+ *		from `start` to `stop` inclusive.
+ *
+ *	@param	string		: String to parse.
+ *	@param	values		: Pointer to store the allocated array of values.
+ *	@param	numberOfValues	: Pointer to store the number of values.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	parseParameterStudyValues(const char *  string, double **  values, size_t *  numberOfValues);
+
+/**
+ *	@brief	Get the number of points of a parameter study: the product of the numbers of
+ *		values of the listed inputs, or, if the study is zipped, their common number of
+ *		values (inputs with a single value are broadcast).
+ *
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: The number of points, or 0 if zipped lists differ in length or the
+ *				  product exceeds `kParameterStudyMaximumNumberOfPoints`.
+ */
+uint64_t	parameterStudyGetNumberOfPoints(const CommandLineArguments *  arguments);
+
+/**
+ *	@brief	Evaluate the model at every point of a parameter study in one process and write
+ *		the results as a table (to the output file if one is given, else to stdout). Without
+ *		Monte Carlo mode, each row holds the inputs and `σc` at one point, evaluated with the
+ *		batched kernel across points. In Monte Carlo mode, each row holds the statistics
+ *		of `σc` over the samples of the unlisted inputs, which all points share, so the
+ *		differences between rows are not blurred by sampling noise.
+ *
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runParameterStudy(const CommandLineArguments *  arguments);
@@ -0,0 +1,293 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "particleSizeDistribution.h"
+#include "common.h"
+
+
+typedef struct MeasuredParticle
+{
+	double	radius;
+	double	weight;
+} MeasuredParticle;
+
+static int
+compareMeasuredParticlesByRadius(const void *  a, const void *  b)
+{
+	double	radiusA = ((const MeasuredParticle *) a)->radius;
+	double	radiusB = ((const MeasuredParticle *) b)->radius;
+
+	return (radiusA > radiusB) - (radiusA < radiusB);
+}
+
+/*
+ *	Nodes and weights of the `n`-point Gauss–Hermite rule for the weight `exp(-x^2)`,
+ *	by Newton iteration on the orthonormal Hermite recurrence.
+ */
+static void
+computeGaussHermiteRule(size_t n, double *  nodes, double *  weights)
+{
+	double	z = 0.0;
+
+	for (size_t i = 0; i < (n + 1) / 2; i++)
+	{
+		double	derivative = 0.0;
+
+		if (i == 0)
+		{
+			z = sqrt(2.0 * n + 1) - 1.85575 * pow(2.0 * n + 1, -0.16667);
+		}
+		else if (i == 1)
+		{
+			z -= 1.14 * pow((double) n, 0.426) / z;
+		}
+		else if (i == 2)
+		{
+			z = 1.86 * z - 0.86 * nodes[0];
+		}
+		else if (i == 3)
+		{
+			z = 1.91 * z - 0.91 * nodes[1];
+		}
+		else
+		{
+			z = 2.0 * z - nodes[i - 2];
+		}
+
+		for (size_t iteration = 0; iteration < 100; iteration++)
+		{
+			double	p1 = pow(M_PI, -0.25);
+			double	p2 = 0.0;
+			double	previous = z;
+
+			for (size_t j = 1; j <= n; j++)
+			{
+				double	p3 = p2;
+
+				p2 = p1;
+				p1 = z * sqrt(2.0 / j) * p2 - sqrt((j - 1.0) / j) * p3;
+			}
+			derivative = sqrt(2.0 * n) * p2;
+			z = previous - p1 / derivative;
+
+			if (fabs(z - previous) <= 3E-14)
+			{
+				break;
+			}
+		}
+
+		nodes[i] = z;
+		nodes[n - 1 - i] = -z;
+		weights[i] = 2.0 / (derivative * derivative);
+		weights[n - 1 - i] = weights[i];
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+particleSizeDistributionInitLognormal(
+	ParticleSizeDistribution *	distribution,
+	double				shape,
+	size_t				numberOfNodes)
+{
+	double	nodes[kParticleSizeDistributionMaximumNumberOfNodes];
+	double	weights[kParticleSizeDistributionMaximumNumberOfNodes];
+
+	if ((numberOfNodes == 0) || (numberOfNodes > kParticleSizeDistributionMaximumNumberOfNodes) || !(shape >= 0) || !isfinite(shape))
+	{
+		fprintf(stderr, "Error: Invalid lognormal particle-size distribution.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	computeGaussHermiteRule(numberOfNodes, nodes, weights);
+
+	/*
+	 *	With `R / mean(R) = exp(shape ⋅ Z - shape^2 / 2)` and `Z` standard normal,
+	 *	`E[f(R)] ≈ Σ w_k / √π ⋅ f(mean(R) ⋅ exp(shape ⋅ √2 ⋅ x_k - shape^2 / 2))`.
+	 */
+	distribution->numberOfNodes = numberOfNodes;
+	for (size_t k = 0; k < numberOfNodes; k++)
+	{
+		distribution->radiusRatios[k] = exp(shape * M_SQRT2 * nodes[k] - 0.5 * shape * shape);
+		distribution->weights[k] = weights[k] / sqrt(M_PI);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+particleSizeDistributionInitFromCSV(
+	ParticleSizeDistribution *	distribution,
+	const char *			path,
+	size_t				numberOfNodes)
+{
+	FILE *			file;
+	char			line[kParticleSizeDistributionMaximumLineLength];
+	MeasuredParticle *	particles;
+	size_t			numberOfParticles = 0;
+	size_t			capacity = 256;
+	size_t			lineNumber = 1;
+	bool			hasWeights;
+	double			totalWeight = 0.0;
+	double			meanRadius = 0.0;
+	double			cumulativeWeight = 0.0;
+
+	if ((numberOfNodes == 0) || (numberOfNodes > kParticleSizeDistributionMaximumNumberOfNodes))
+	{
+		fprintf(stderr, "Error: Invalid number of particle-size distribution nodes.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	file = fopen(path, "r");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open particle-size distribution file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (fgets(line, sizeof(line), file) == NULL)
+	{
+		line[0] = '\0';
+	}
+	line[strcspn(line, "\r\n")] = '\0';
+	if ((strcmp(line, "radius") != 0) && (strcmp(line, "radius,weight") != 0))
+	{
+		fprintf(stderr, "Error: The header of \"%s\" must be `radius` or `radius,weight`.\n", path);
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+	hasWeights = (strcmp(line, "radius,weight") == 0);
+
+	particles = (MeasuredParticle *) checkedMalloc(capacity * sizeof(MeasuredParticle), __FILE__, __LINE__);
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		MeasuredParticle	particle = {.weight = 1.0};
+		char *			end;
+
+		lineNumber++;
+		line[strcspn(line, "\r\n")] = '\0';
+		if ((line[0] == '\0') || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		errno = 0;
+		particle.radius = strtod(line, &end);
+		if (hasWeights && (*end == ','))
+		{
+			char *	weightStart = end + 1;
+
+			particle.weight = strtod(weightStart, &end);
+			if (end == weightStart)
+			{
+				end = line;
+			}
+		}
+
+		if ((errno != 0) || (end == line) || (*end != '\0') || !(particle.radius > 0) || !isfinite(particle.radius) ||
+			!(particle.weight > 0) || !isfinite(particle.weight))
+		{
+			fprintf(stderr, "Error: Line %zu of \"%s\" must hold a positive radius%s.\n",
+				lineNumber, path, hasWeights ? " and a positive weight" : "");
+			free(particles);
+			fclose(file);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (numberOfParticles == capacity)
+		{
+			capacity *= 2;
+			particles = (MeasuredParticle *) realloc(particles, capacity * sizeof(MeasuredParticle));
+			if (particles == NULL)
+			{
+				fprintf(stderr, "Error: Out of memory while reading \"%s\".\n", path);
+				fclose(file);
+
+				return kCommonConstantReturnTypeError;
+			}
+		}
+		particles[numberOfParticles++] = particle;
+		totalWeight += particle.weight;
+		meanRadius += particle.weight * particle.radius;
+	}
+	fclose(file);
+
+	if (numberOfParticles == 0)
+	{
+		fprintf(stderr, "Error: The particle-size distribution file \"%s\" has no particles.\n", path);
+		free(particles);
+
+		return kCommonConstantReturnTypeError;
+	}
+	meanRadius /= totalWeight;
+
+	/*
+	 *	Group the particles, in order of radius, into groups of about equal weight.
+	 *	A particle belongs to the group that holds the midpoint of its weight.
+	 */
+	qsort(particles, numberOfParticles, sizeof(MeasuredParticle), compareMeasuredParticlesByRadius);
+	memset(distribution, 0, sizeof(ParticleSizeDistribution));
+	if (numberOfNodes > numberOfParticles)
+	{
+		numberOfNodes = numberOfParticles;
+	}
+
+	for (size_t i = 0; i < numberOfParticles; i++)
+	{
+		size_t	group = (size_t) ((cumulativeWeight + 0.5 * particles[i].weight) / totalWeight * numberOfNodes);
+
+		if (group >= numberOfNodes)
+		{
+			group = numberOfNodes - 1;
+		}
+		distribution->radiusRatios[group] += particles[i].weight * particles[i].radius / meanRadius;
+		distribution->weights[group] += particles[i].weight;
+		cumulativeWeight += particles[i].weight;
+	}
+	free(particles);
+
+	for (size_t k = 0; k < numberOfNodes; k++)
+	{
+		if (distribution->weights[k] == 0)
+		{
+			continue;
+		}
+
+		distribution->radiusRatios[distribution->numberOfNodes] = distribution->radiusRatios[k] / distribution->weights[k];
+		distribution->weights[distribution->numberOfNodes] = distribution->weights[k] / totalWeight;
+		distribution->numberOfNodes++;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,82 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "common.h"
+
+
+#define	kParticleSizeDistributionMaximumNumberOfNodes		(64)
+#define	kParticleSizeDistributionDefaultNumberOfNodes		(16)
+#define	kParticleSizeDistributionMaximumLineLength		(256)
+
+typedef enum
+{
+	kParticleSizeDistributionKindNone	= 0,
+	kParticleSizeDistributionKindLognormal,
+	kParticleSizeDistributionKindEmpirical,
+} ParticleSizeDistributionKind;
+
+/*
+ *	Quadrature rule over a particle-size distribution. The nodes are radii relative
+ *	to the mean radius and the weights sum to one, so the same rule applies to every
+ *	sample of `Rs`, with `Rs` as the mean radius of the distribution.
+ */
+typedef struct ParticleSizeDistribution
+{
+	size_t	numberOfNodes;
+	double	radiusRatios[kParticleSizeDistributionMaximumNumberOfNodes];
+	double	weights[kParticleSizeDistributionMaximumNumberOfNodes];
+} ParticleSizeDistribution;
+
+/**
+ *	@brief	Build the quadrature rule of a lognormal particle-size distribution with unit
+ *		mean from a Gauss–Hermite rule.
+ *
+ *	@param	distribution	: Pointer to the quadrature rule to fill.
+ *	@param	shape		: Standard deviation of the logarithm of the radius.
+ *	@param	numberOfNodes	: Number of quadrature nodes, at most `kParticleSizeDistributionMaximumNumberOfNodes`.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	particleSizeDistributionInitLognormal(
+					ParticleSizeDistribution *	distribution,
+					double				shape,
+					size_t				numberOfNodes);
+
+/**
+ *	@brief	Build the quadrature rule of an empirical particle-size distribution from a
+ *		CSV file with a `radius` or `radius,weight` header and one measured particle per
+ *		line. The particles are grouped into `numberOfNodes` groups of equal weight in
+ *		order of radius, and each group becomes one node at its mean radius.
+ *
+ *	@param	distribution	: Pointer to the quadrature rule to fill.
+ *	@param	path		: Path to the CSV file.
+ *	@param	numberOfNodes	: Number of quadrature nodes, at most `kParticleSizeDistributionMaximumNumberOfNodes`.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	particleSizeDistributionInitFromCSV(
+					ParticleSizeDistribution *	distribution,
+					const char *			path,
+					size_t				numberOfNodes);
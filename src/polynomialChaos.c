@@ -0,0 +1,1002 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "polynomialChaos.h"
+#include "brownHamModel.h"
+#include "histogram.h"
+#include "sampling.h"
+#include "hash.h"
+#include "common.h"
+
+
+static const char	kPolynomialChaosFileMagic[8] = {'B', 'H', 'P', 'C', 'E', '\0', '\0', '\0'};
+
+static const char * const	kInputVariableNames[kInputDistributionIndexMax] = {
+					[kInputDistributionIndexB]	= "b",
+					[kInputDistributionIndexG]	= "G",
+					[kInputDistributionIndexGamma]	= "gamma",
+					[kInputDistributionIndexM]	= "M",
+					[kInputDistributionIndexPhi]	= "phi",
+					[kInputDistributionIndexRs]	= "Rs",
+				};
+
+/*
+ *	The design and the validation points are drawn from streams that no Monte
+ *	Carlo block uses.
+ */
+#define	kPolynomialChaosDesignStreamIndex	(UINT64_MAX)
+#define	kPolynomialChaosValidationStreamIndex	(UINT64_MAX - 1)
+
+/*
+ *	Fixed-size header of a surrogate file. It is followed by the `numberOfTerms`
+ *	multi-indices and then by the `numberOfTerms` coefficients.
+ */
+typedef struct PolynomialChaosFileHeader
+{
+	char		magic[8];
+	uint64_t	version;
+	uint64_t	inputDistributionsHash;
+	uint64_t	numberOfDimensions;
+	uint64_t	inputIndices[kInputDistributionIndexMax];
+	uint64_t	degree;
+	double		qNorm;
+	uint64_t	numberOfTerms;
+	uint64_t	numberOfDesignPoints;
+	double		validationError;
+} PolynomialChaosFileHeader;
+
+static uint64_t
+getInputDistributionsHash(const CommandLineArguments *  arguments)
+{
+	uint64_t	hash = kHashFnv1aOffsetBasis;
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		hash = inputDistributionGetHash(hash, &arguments->samplingDistributions[i]);
+	}
+
+	return hash;
+}
+
+/*
+ *	Orthonormal Legendre polynomials on (-1, 1) of degree 0 to `degree` at `2 u - 1`,
+ *	by the three-term recurrence, scaled by `sqrt(2 n + 1)`.
+ */
+static void
+evaluateOrthonormalLegendre(
+	const double *	uniforms,
+	size_t		degree,
+	double		values[][kInputSampleBlockSize],
+	size_t		count)
+{
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		values[0][i] = 1.0;
+		values[1][i] = 2.0 * uniforms[i] - 1.0;
+	}
+
+	for (size_t n = 1; n < degree; n++)
+	{
+		#pragma omp simd
+		for (size_t i = 0; i < count; i++)
+		{
+			values[n + 1][i] = ((2 * n + 1) * values[1][i] * values[n][i] - n * values[n - 1][i]) / (n + 1);
+		}
+	}
+
+	for (size_t n = 2; n <= degree; n++)
+	{
+		double	scale = sqrt(2.0 * n + 1.0);
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; i++)
+		{
+			values[n][i] *= scale;
+		}
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		values[1][i] *= sqrt(3.0);
+	}
+
+	return;
+}
+
+/*
+ *	Enumerate the multi-indices of the hyperbolic cross in graded order, so that
+ *	the first term is the constant.
+ */
+static CommonConstantReturnType
+enumerateMultiIndices(PolynomialChaosExpansion *  expansion)
+{
+	size_t	numberOfDimensions = expansion->numberOfDimensions;
+	size_t	degree = expansion->degree;
+
+	expansion->numberOfTerms = 0;
+	for (size_t totalDegree = 0; totalDegree <= degree; totalDegree++)
+	{
+		uint8_t	index[kInputDistributionIndexMax] = {0};
+
+		/*
+		 *	Iterate over all multi-indices with entries up to `totalDegree` as an
+		 *	odometer, and keep those whose entries sum to `totalDegree`.
+		 */
+		while (true)
+		{
+			size_t	sum = 0;
+			double	qSum = 0.0;
+			size_t	d;
+
+			for (d = 0; d < numberOfDimensions; d++)
+			{
+				sum += index[d];
+				qSum += pow(index[d], expansion->qNorm);
+			}
+
+			if ((sum == totalDegree) && (pow(qSum, 1.0 / expansion->qNorm) <= degree + 1E-9))
+			{
+				if (expansion->numberOfTerms == kPolynomialChaosMaximumNumberOfTerms)
+				{
+					fprintf(stderr, "Error: The expansion has more than %d terms. Use a lower degree or q-norm.\n", kPolynomialChaosMaximumNumberOfTerms);
+
+					return kCommonConstantReturnTypeError;
+				}
+
+				memset(expansion->multiIndices[expansion->numberOfTerms], 0, kInputDistributionIndexMax);
+				memcpy(expansion->multiIndices[expansion->numberOfTerms], index, numberOfDimensions);
+				expansion->numberOfTerms++;
+			}
+
+			for (d = 0; d < numberOfDimensions; d++)
+			{
+				if (index[d] < totalDegree)
+				{
+					index[d]++;
+					break;
+				}
+				index[d] = 0;
+			}
+
+			if (d == numberOfDimensions)
+			{
+				break;
+			}
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Map the uniform coordinates of a block of points to the inputs of the model
+ *	through the quantile functions of the uncertain inputs, and evaluate the model.
+ */
+static void
+evaluateModelAtUniforms(
+	const PolynomialChaosExpansion *	expansion,
+	const CommandLineArguments *		arguments,
+	const PolynomialChaosBlock *		block,
+	InputSampleBlock *			inputs,
+	double *				sigmaCMpa,
+	size_t					count)
+{
+	double (*	values)[kInputSampleBlockSize] = inputs->values;
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		for (size_t j = 0; j < count; j++)
+		{
+			values[i][j] = arguments->samplingDistributions[i].value;
+		}
+	}
+
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		const InputDistribution *	distribution = &arguments->samplingDistributions[expansion->inputIndices[d]];
+
+		for (size_t j = 0; j < count; j++)
+		{
+			values[expansion->inputIndices[d]][j] = inputDistributionQuantile(distribution, block->uniforms[d][j]);
+		}
+	}
+
+	computeBrownHamModelOutputBatch(
+		values[kInputDistributionIndexGamma],
+		values[kInputDistributionIndexPhi],
+		values[kInputDistributionIndexRs],
+		values[kInputDistributionIndexG],
+		values[kInputDistributionIndexB],
+		values[kInputDistributionIndexM],
+		sigmaCMpa,
+		count);
+
+	return;
+}
+
+CommonConstantReturnType
+polynomialChaosExpansionFit(PolynomialChaosExpansion *  expansion, const CommandLineArguments *  arguments)
+{
+	size_t				numberOfTerms;
+	size_t				numberOfDesignPoints;
+	size_t				numberOfDroppedPoints = 0;
+	double *			design;
+	double *			gram;
+	double *			factor;
+	double *			rightHandSide;
+	double *			basis;
+	double				modelOutputs[kInputSampleBlockSize];
+	double				squaredResidualSum = 0.0;
+	double				squaredDeviationSum = 0.0;
+	double				validationMean = 0.0;
+	size_t				numberOfValidationPoints = 0;
+	PolynomialChaosBlock *		block;
+	InputSampleBlock *		inputs;
+	SamplerRandomNumberGenerator	generator;
+
+	memset(expansion, 0, sizeof(PolynomialChaosExpansion));
+	expansion->inputDistributionsHash = getInputDistributionsHash(arguments);
+	expansion->degree = arguments->polynomialChaosDegree;
+	expansion->qNorm = arguments->polynomialChaosQNorm;
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		if (arguments->samplingDistributions[i].kind != kInputDistributionKindConstant)
+		{
+			expansion->inputIndices[expansion->numberOfDimensions++] = i;
+		}
+	}
+
+	if (expansion->numberOfDimensions == 0)
+	{
+		fprintf(stderr, "Error: A polynomial chaos expansion requires at least one uncertain input.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (enumerateMultiIndices(expansion) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	numberOfTerms = expansion->numberOfTerms;
+	numberOfDesignPoints = kPolynomialChaosDesignOversampling * numberOfTerms;
+	expansion->numberOfDesignPoints = numberOfDesignPoints;
+
+	/*
+	 *	Latin hypercube design in the uniform coordinates: each coordinate takes
+	 *	one point in each of `numberOfDesignPoints` equal strata, in random order.
+	 */
+	design = (double *) checkedMalloc(expansion->numberOfDimensions * numberOfDesignPoints * sizeof(double), __FILE__, __LINE__);
+	samplerRandomNumberGeneratorInit(&generator, arguments->seed, kPolynomialChaosDesignStreamIndex);
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		double *	coordinates = &design[d * numberOfDesignPoints];
+
+		for (size_t j = 0; j < numberOfDesignPoints; j++)
+		{
+			coordinates[j] = (double) j;
+		}
+
+		for (size_t j = numberOfDesignPoints - 1; j > 0; j--)
+		{
+			size_t	k = (size_t) (samplerRandomNumberGeneratorNext(&generator) % (j + 1));
+			double	swap = coordinates[j];
+
+			coordinates[j] = coordinates[k];
+			coordinates[k] = swap;
+		}
+
+		for (size_t j = 0; j < numberOfDesignPoints; j++)
+		{
+			double	uniform;
+
+			samplerFillUniforms(&generator, &uniform, 1);
+			coordinates[j] = (coordinates[j] + uniform) / numberOfDesignPoints;
+		}
+	}
+
+	/*
+	 *	Accumulate the normal equations of the least-squares fit one block of
+	 *	design points at a time. Points where the model is not finite (e.g., a
+	 *	negative `Rs`) are left out.
+	 */
+	gram = (double *) checkedMalloc(numberOfTerms * numberOfTerms * sizeof(double), __FILE__, __LINE__);
+	factor = (double *) checkedMalloc(numberOfTerms * numberOfTerms * sizeof(double), __FILE__, __LINE__);
+	rightHandSide = (double *) checkedMalloc(numberOfTerms * sizeof(double), __FILE__, __LINE__);
+	basis = (double *) checkedMalloc(numberOfTerms * kInputSampleBlockSize * sizeof(double), __FILE__, __LINE__);
+	block = (PolynomialChaosBlock *) checkedMalloc(sizeof(PolynomialChaosBlock), __FILE__, __LINE__);
+	inputs = (InputSampleBlock *) checkedMalloc(sizeof(InputSampleBlock), __FILE__, __LINE__);
+	memset(gram, 0, numberOfTerms * numberOfTerms * sizeof(double));
+	memset(rightHandSide, 0, numberOfTerms * sizeof(double));
+
+	for (size_t first = 0; first < numberOfDesignPoints; first += kInputSampleBlockSize)
+	{
+		size_t	count = (numberOfDesignPoints - first < kInputSampleBlockSize) ? (numberOfDesignPoints - first) : kInputSampleBlockSize;
+		size_t	numberOfFinitePoints = 0;
+
+		for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+		{
+			memcpy(block->uniforms[d], &design[d * numberOfDesignPoints + first], count * sizeof(double));
+		}
+		evaluateModelAtUniforms(expansion, arguments, block, inputs, modelOutputs, count);
+
+		for (size_t j = 0; j < count; j++)
+		{
+			if (!isfinite(modelOutputs[j]))
+			{
+				continue;
+			}
+
+			for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+			{
+				block->uniforms[d][numberOfFinitePoints] = block->uniforms[d][j];
+			}
+			modelOutputs[numberOfFinitePoints++] = modelOutputs[j];
+		}
+		numberOfDroppedPoints += count - numberOfFinitePoints;
+
+		for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+		{
+			evaluateOrthonormalLegendre(block->uniforms[d], expansion->degree, block->legendre[d], numberOfFinitePoints);
+		}
+
+		for (size_t t = 0; t < numberOfTerms; t++)
+		{
+			double *	row = &basis[t * kInputSampleBlockSize];
+
+			for (size_t j = 0; j < numberOfFinitePoints; j++)
+			{
+				row[j] = 1.0;
+			}
+
+			for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+			{
+				const double *	legendre = block->legendre[d][expansion->multiIndices[t][d]];
+
+				#pragma omp simd
+				for (size_t j = 0; j < numberOfFinitePoints; j++)
+				{
+					row[j] *= legendre[j];
+				}
+			}
+		}
+
+		for (size_t t = 0; t < numberOfTerms; t++)
+		{
+			const double *	rowT = &basis[t * kInputSampleBlockSize];
+			double		sum = 0.0;
+
+			for (size_t s = 0; s <= t; s++)
+			{
+				const double *	rowS = &basis[s * kInputSampleBlockSize];
+				double		product = 0.0;
+
+				#pragma omp simd reduction(+:product)
+				for (size_t j = 0; j < numberOfFinitePoints; j++)
+				{
+					product += rowT[j] * rowS[j];
+				}
+				gram[t * numberOfTerms + s] += product;
+			}
+
+			#pragma omp simd reduction(+:sum)
+			for (size_t j = 0; j < numberOfFinitePoints; j++)
+			{
+				sum += rowT[j] * modelOutputs[j];
+			}
+			rightHandSide[t] += sum;
+		}
+	}
+
+	for (size_t t = 0; t < numberOfTerms; t++)
+	{
+		for (size_t s = t + 1; s < numberOfTerms; s++)
+		{
+			gram[t * numberOfTerms + s] = gram[s * numberOfTerms + t];
+		}
+	}
+
+	if (numberOfDroppedPoints > 0)
+	{
+		fprintf(stderr, "Warning: The model is not finite at %zu of %zu design points, which are left out of the fit.\n",
+			numberOfDroppedPoints, numberOfDesignPoints);
+	}
+
+	/*
+	 *	Solve the normal equations by Cholesky decomposition and substitution.
+	 */
+	if (choleskyDecompose(gram, factor, numberOfTerms) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: The least-squares problem of the polynomial chaos expansion is singular. Use a lower degree.\n");
+		free(design);
+		free(gram);
+		free(factor);
+		free(rightHandSide);
+		free(basis);
+		free(block);
+		free(inputs);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t t = 0; t < numberOfTerms; t++)
+	{
+		double	sum = rightHandSide[t];
+
+		for (size_t s = 0; s < t; s++)
+		{
+			sum -= factor[t * numberOfTerms + s] * expansion->coefficients[s];
+		}
+		expansion->coefficients[t] = sum / factor[t * numberOfTerms + t];
+	}
+
+	for (size_t t = numberOfTerms; t-- > 0;)
+	{
+		double	sum = expansion->coefficients[t];
+
+		for (size_t s = t + 1; s < numberOfTerms; s++)
+		{
+			sum -= factor[s * numberOfTerms + t] * expansion->coefficients[s];
+		}
+		expansion->coefficients[t] = sum / factor[t * numberOfTerms + t];
+	}
+
+	/*
+	 *	Estimate the relative mean squared error of the expansion on independent
+	 *	random points.
+	 */
+	samplerRandomNumberGeneratorInit(&generator, arguments->seed, kPolynomialChaosValidationStreamIndex);
+	for (size_t first = 0; first < numberOfDesignPoints; first += kInputSampleBlockSize)
+	{
+		size_t	count = (numberOfDesignPoints - first < kInputSampleBlockSize) ? (numberOfDesignPoints - first) : kInputSampleBlockSize;
+
+		for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+		{
+			samplerFillUniforms(&generator, block->uniforms[d], count);
+		}
+		evaluateModelAtUniforms(expansion, arguments, block, inputs, modelOutputs, count);
+		polynomialChaosExpansionEvaluateBlock(expansion, block, count);
+
+		for (size_t j = 0; j < count; j++)
+		{
+			double	delta;
+
+			if (!isfinite(modelOutputs[j]))
+			{
+				continue;
+			}
+
+			/*
+			 *	Welford update of the sum of squared deviations of the model outputs.
+			 */
+			numberOfValidationPoints++;
+			delta = modelOutputs[j] - validationMean;
+			validationMean += delta / numberOfValidationPoints;
+			squaredDeviationSum += delta * (modelOutputs[j] - validationMean);
+			squaredResidualSum += (modelOutputs[j] - block->sigmaCMpa[j]) * (modelOutputs[j] - block->sigmaCMpa[j]);
+		}
+	}
+	expansion->validationError = (squaredDeviationSum > 0.0) ? (squaredResidualSum / squaredDeviationSum) : 0.0;
+
+	free(design);
+	free(gram);
+	free(factor);
+	free(rightHandSide);
+	free(basis);
+	free(block);
+	free(inputs);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+double
+polynomialChaosExpansionMean(const PolynomialChaosExpansion *  expansion)
+{
+	return expansion->coefficients[0];
+}
+
+double
+polynomialChaosExpansionVariance(const PolynomialChaosExpansion *  expansion)
+{
+	double	variance = 0.0;
+
+	for (size_t t = 1; t < expansion->numberOfTerms; t++)
+	{
+		variance += expansion->coefficients[t] * expansion->coefficients[t];
+	}
+
+	return variance;
+}
+
+void
+polynomialChaosExpansionSobolIndices(const PolynomialChaosExpansion *  expansion, double *  firstOrder, double *  total)
+{
+	double	variance = polynomialChaosExpansionVariance(expansion);
+
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		firstOrder[d] = 0.0;
+		total[d] = 0.0;
+	}
+
+	/*
+	 *	A term contributes to the total index of every input it depends on, and to
+	 *	the first-order index of an input only if it depends on no other input.
+	 */
+	for (size_t t = 1; t < expansion->numberOfTerms; t++)
+	{
+		double	contribution = expansion->coefficients[t] * expansion->coefficients[t];
+		size_t	numberOfActiveDimensions = 0;
+		size_t	activeDimension = 0;
+
+		for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+		{
+			if (expansion->multiIndices[t][d] > 0)
+			{
+				total[d] += contribution;
+				activeDimension = d;
+				numberOfActiveDimensions++;
+			}
+		}
+
+		if (numberOfActiveDimensions == 1)
+		{
+			firstOrder[activeDimension] += contribution;
+		}
+	}
+
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		firstOrder[d] = (variance > 0.0) ? (firstOrder[d] / variance) : 0.0;
+		total[d] = (variance > 0.0) ? (total[d] / variance) : 0.0;
+	}
+
+	return;
+}
+
+void
+polynomialChaosExpansionEvaluateBlock(
+	const PolynomialChaosExpansion *	expansion,
+	PolynomialChaosBlock *			block,
+	size_t					count)
+{
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		evaluateOrthonormalLegendre(block->uniforms[d], expansion->degree, block->legendre[d], count);
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		block->sigmaCMpa[i] = expansion->coefficients[0];
+	}
+
+	/*
+	 *	Each term is a product of one Legendre polynomial per input it depends on.
+	 *	Degree-zero factors are one and are skipped.
+	 */
+	for (size_t t = 1; t < expansion->numberOfTerms; t++)
+	{
+		double	coefficient = expansion->coefficients[t];
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; i++)
+		{
+			block->product[i] = coefficient;
+		}
+
+		for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+		{
+			const double *	legendre;
+
+			if (expansion->multiIndices[t][d] == 0)
+			{
+				continue;
+			}
+
+			legendre = block->legendre[d][expansion->multiIndices[t][d]];
+			#pragma omp simd
+			for (size_t i = 0; i < count; i++)
+			{
+				block->product[i] *= legendre[i];
+			}
+		}
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; i++)
+		{
+			block->sigmaCMpa[i] += block->product[i];
+		}
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+polynomialChaosExpansionSave(const PolynomialChaosExpansion *  expansion, const char *  path)
+{
+	FILE *				file = fopen(path, "wb");
+	PolynomialChaosFileHeader	header = {
+						.version		= kPolynomialChaosFileVersion,
+						.inputDistributionsHash	= expansion->inputDistributionsHash,
+						.numberOfDimensions	= expansion->numberOfDimensions,
+						.degree			= expansion->degree,
+						.qNorm			= expansion->qNorm,
+						.numberOfTerms		= expansion->numberOfTerms,
+						.numberOfDesignPoints	= expansion->numberOfDesignPoints,
+						.validationError	= expansion->validationError,
+					};
+	bool				isWritten;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	memcpy(header.magic, kPolynomialChaosFileMagic, sizeof(kPolynomialChaosFileMagic));
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		header.inputIndices[d] = expansion->inputIndices[d];
+	}
+
+	isWritten = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+			(fwrite(expansion->multiIndices, sizeof(expansion->multiIndices[0]), expansion->numberOfTerms, file) == expansion->numberOfTerms) &&
+			(fwrite(expansion->coefficients, sizeof(double), expansion->numberOfTerms, file) == expansion->numberOfTerms);
+	isWritten = (fclose(file) == 0) && isWritten;
+
+	if (!isWritten)
+	{
+		fprintf(stderr, "Error: Could not write surrogate file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+polynomialChaosExpansionLoad(
+	PolynomialChaosExpansion *	expansion,
+	const char *			path,
+	const CommandLineArguments *	arguments)
+{
+	FILE *				file = fopen(path, "rb");
+	PolynomialChaosFileHeader	header;
+	bool				isValid;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open surrogate file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((fread(&header, sizeof(header), 1, file) != 1) ||
+		(memcmp(header.magic, kPolynomialChaosFileMagic, sizeof(kPolynomialChaosFileMagic)) != 0) ||
+		(header.version != kPolynomialChaosFileVersion) ||
+		(header.numberOfDimensions < 1) || (header.numberOfDimensions > kInputDistributionIndexMax) ||
+		(header.degree < 1) || (header.degree > kPolynomialChaosMaximumDegree) ||
+		(header.numberOfTerms < 1) || (header.numberOfTerms > kPolynomialChaosMaximumNumberOfTerms))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a surrogate file of this version of the application.\n", path);
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (header.inputDistributionsHash != getInputDistributionsHash(arguments))
+	{
+		fprintf(stderr, "Error: The surrogate in \"%s\" was fitted for different input distributions.\n", path);
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	memset(expansion, 0, sizeof(PolynomialChaosExpansion));
+	expansion->inputDistributionsHash = header.inputDistributionsHash;
+	expansion->numberOfDimensions = header.numberOfDimensions;
+	expansion->degree = header.degree;
+	expansion->qNorm = header.qNorm;
+	expansion->numberOfTerms = header.numberOfTerms;
+	expansion->numberOfDesignPoints = header.numberOfDesignPoints;
+	expansion->validationError = header.validationError;
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		expansion->inputIndices[d] = header.inputIndices[d];
+	}
+
+	isValid = (fread(expansion->multiIndices, sizeof(expansion->multiIndices[0]), expansion->numberOfTerms, file) == expansion->numberOfTerms) &&
+			(fread(expansion->coefficients, sizeof(double), expansion->numberOfTerms, file) == expansion->numberOfTerms);
+	fclose(file);
+
+	for (size_t t = 0; isValid && (t < expansion->numberOfTerms); t++)
+	{
+		for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+		{
+			isValid = isValid && (expansion->multiIndices[t][d] <= expansion->degree);
+		}
+	}
+
+	if (!isValid)
+	{
+		fprintf(stderr, "Error: The surrogate file \"%s\" is truncated or corrupt.\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Sample the expansion at `numberOfSamples` random points, in blocks that each
+ *	draw from their own stream, and merge the per-thread histograms.
+ */
+static void
+samplePolynomialChaosExpansion(
+	const PolynomialChaosExpansion *	expansion,
+	uint64_t				seed,
+	size_t					numberOfSamples,
+	StreamingHistogram *			outputDistribution)
+{
+	size_t			numberOfBlocks = (numberOfSamples + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+	size_t			numberOfThreads = 1;
+	StreamingHistogram *	histograms;
+
+#ifdef _OPENMP
+	numberOfThreads = (size_t) omp_get_max_threads();
+#endif
+
+	histograms = (StreamingHistogram *) checkedMalloc(numberOfThreads * sizeof(StreamingHistogram), __FILE__, __LINE__);
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		streamingHistogramInit(&histograms[t]);
+	}
+
+	#pragma omp parallel
+	{
+		size_t				threadIndex = 0;
+		PolynomialChaosBlock *		block = (PolynomialChaosBlock *) checkedMalloc(sizeof(PolynomialChaosBlock), __FILE__, __LINE__);
+		SamplerRandomNumberGenerator	generator;
+
+#ifdef _OPENMP
+		threadIndex = (size_t) omp_get_thread_num();
+#endif
+
+		#pragma omp for schedule(static)
+		for (size_t blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+		{
+			size_t	first = blockIndex * kInputSampleBlockSize;
+			size_t	count = (numberOfSamples - first < kInputSampleBlockSize) ? (numberOfSamples - first) : kInputSampleBlockSize;
+
+			samplerRandomNumberGeneratorInit(&generator, seed, blockIndex);
+			for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+			{
+				samplerFillUniforms(&generator, block->uniforms[d], count);
+			}
+			polynomialChaosExpansionEvaluateBlock(expansion, block, count);
+			streamingHistogramAddArray(&histograms[threadIndex], block->sigmaCMpa, count);
+		}
+
+		free(block);
+	}
+
+	*outputDistribution = histograms[0];
+	for (size_t t = 1; t < numberOfThreads; t++)
+	{
+		streamingHistogramMerge(outputDistribution, &histograms[t]);
+	}
+
+	free(histograms);
+
+	return;
+}
+
+CommonConstantReturnType
+runPolynomialChaos(const CommandLineArguments *  arguments)
+{
+	PolynomialChaosExpansion *	expansion;
+	StreamingHistogram		outputDistribution;
+	double				mean;
+	double				variance;
+	double				firstOrder[kInputDistributionIndexMax];
+	double				total[kInputDistributionIndexMax];
+	FILE *				stream = stdout;
+	clock_t				start = clock();
+	double				cpuTimeUsedInSeconds;
+	CommonConstantReturnType	result;
+
+	expansion = (PolynomialChaosExpansion *) checkedMalloc(sizeof(PolynomialChaosExpansion), __FILE__, __LINE__);
+
+	/*
+	 *	Fit the expansion, and save it if a file is given, or load it from the file.
+	 */
+	if (arguments->isPolynomialChaosFitEnabled)
+	{
+		result = polynomialChaosExpansionFit(expansion, arguments);
+		if ((result == kCommonConstantReturnTypeSuccess) && (arguments->polynomialChaosFilePath != NULL))
+		{
+			result = polynomialChaosExpansionSave(expansion, arguments->polynomialChaosFilePath);
+		}
+	}
+	else
+	{
+		result = polynomialChaosExpansionLoad(expansion, arguments->polynomialChaosFilePath, arguments);
+	}
+
+	if (result != kCommonConstantReturnTypeSuccess)
+	{
+		free(expansion);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	mean = polynomialChaosExpansionMean(expansion);
+	variance = polynomialChaosExpansionVariance(expansion);
+	polynomialChaosExpansionSobolIndices(expansion, firstOrder, total);
+	samplePolynomialChaosExpansion(expansion, arguments->seed, arguments->common.numberOfMonteCarloIterations, &outputDistribution);
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	if (arguments->common.isOutputJSONMode)
+	{
+		JSONVariable	variables[5 + kInputDistributionIndexMax];
+		char		sobolSymbols[kInputDistributionIndexMax][32];
+		char		sobolDescriptions[kInputDistributionIndexMax][96];
+		double		sobolIndices[kInputDistributionIndexMax][2];
+		double		surrogateStatistics[5] = {
+					outputDistribution.mean,
+					sqrt(streamingHistogramVariance(&outputDistribution)),
+					streamingHistogramQuantile(&outputDistribution, 0.05),
+					streamingHistogramQuantile(&outputDistribution, 0.50),
+					streamingHistogramQuantile(&outputDistribution, 0.95),
+				};
+		size_t		numberOfVariables = 0;
+
+		variables[numberOfVariables++] = (JSONVariable) {
+			.variableSymbol = "sigmaCMpaMean",
+			.variableDescription = "Mean of the cutting stress (σc) from the expansion",
+			.values = (JSONVariablePointer) { .asDouble = &mean},
+			.type = kJSONVariableTypeDouble,
+			.size = 1,
+		};
+		variables[numberOfVariables++] = (JSONVariable) {
+			.variableSymbol = "sigmaCMpaVariance",
+			.variableDescription = "Variance of the cutting stress (σc) from the expansion",
+			.values = (JSONVariablePointer) { .asDouble = &variance},
+			.type = kJSONVariableTypeDouble,
+			.size = 1,
+		};
+		variables[numberOfVariables++] = (JSONVariable) {
+			.variableSymbol = "validationError",
+			.variableDescription = "Relative mean squared error of the expansion on validation points",
+			.values = (JSONVariablePointer) { .asDouble = &expansion->validationError},
+			.type = kJSONVariableTypeDouble,
+			.size = 1,
+		};
+		variables[numberOfVariables++] = (JSONVariable) {
+			.variableSymbol = "sigmaCMpaSurrogate",
+			.variableDescription = "Cutting stress (σc) sampled from the expansion (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+			.values = (JSONVariablePointer) { .asDouble = surrogateStatistics},
+			.type = kJSONVariableTypeDouble,
+			.size = 5,
+		};
+
+		for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+		{
+			snprintf(sobolSymbols[d], sizeof(sobolSymbols[d]), "sobolIndices_%s", kInputVariableNames[expansion->inputIndices[d]]);
+			snprintf(sobolDescriptions[d], sizeof(sobolDescriptions[d]), "Sobol indices of %s (first-order, total)", kInputVariableNames[expansion->inputIndices[d]]);
+			sobolIndices[d][0] = firstOrder[d];
+			sobolIndices[d][1] = total[d];
+
+			variables[numberOfVariables++] = (JSONVariable) {
+				.variableSymbol = sobolSymbols[d],
+				.variableDescription = sobolDescriptions[d],
+				.values = (JSONVariablePointer) { .asDouble = sobolIndices[d]},
+				.type = kJSONVariableTypeDouble,
+				.size = 2,
+			};
+		}
+
+		if (arguments->common.isTimingEnabled)
+		{
+			variables[numberOfVariables++] = (JSONVariable) {
+				.variableSymbol = "cpuTimeUsed",
+				.variableDescription = "CPU time used (s)",
+				.values = (JSONVariablePointer) { .asDouble = &cpuTimeUsedInSeconds},
+				.type = kJSONVariableTypeDoubleParticle,
+				.size = 1,
+			};
+		}
+
+		printJSONVariables(variables, numberOfVariables, "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+		free(expansion);
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	printf("Polynomial chaos expansion: %zu inputs, degree %zu, q-norm %.2lf, %zu terms, %zu design points, relative validation error %le.\n",
+		expansion->numberOfDimensions,
+		expansion->degree,
+		expansion->qNorm,
+		expansion->numberOfTerms,
+		expansion->numberOfDesignPoints,
+		expansion->validationError);
+	printf("Mean of cutting stress (σc) = %le MPa\n", mean);
+	printf("Standard deviation of cutting stress (σc) = %le MPa\n", sqrt(variance));
+
+	if (arguments->common.isWriteToFileEnabled)
+	{
+		stream = fopen(arguments->common.outputFilePath, "w");
+		if (stream == NULL)
+		{
+			fprintf(stderr, "Error: Could not write to output CSV file \"%s\".\n", arguments->common.outputFilePath);
+			free(expansion);
+
+			return kCommonConstantReturnTypeError;
+		}
+		fprintf(stream, "input,firstOrderSobol,totalSobol\n");
+	}
+	else
+	{
+		fprintf(stream, "%-24s %16s %16s\n", "input", "firstOrderSobol", "totalSobol");
+	}
+
+	for (size_t d = 0; d < expansion->numberOfDimensions; d++)
+	{
+		fprintf(stream,
+			arguments->common.isWriteToFileEnabled ? "%s,%le,%le\n" : "%-24s %16le %16le\n",
+			kInputVariableNames[expansion->inputIndices[d]],
+			firstOrder[d],
+			total[d]);
+	}
+
+	if (stream != stdout)
+	{
+		fclose(stream);
+	}
+
+	printf("Samples of the expansion:\n");
+	streamingHistogramPrintSummaryHeader(stdout, "variable", false);
+	streamingHistogramPrintSummaryRow(stdout, "sigmaCMpa", &outputDistribution, false);
+
+	if (arguments->common.isTimingEnabled)
+	{
+		printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+	}
+
+	free(expansion);
+
+	return kCommonConstantReturnTypeSuccess;
+}
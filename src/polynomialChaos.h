@@ -0,0 +1,156 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+
+
+#define	kPolynomialChaosDefaultDegree		(4)
+#define	kPolynomialChaosMaximumDegree		(12)
+#define	kPolynomialChaosDefaultQNorm		(0.75)
+#define	kPolynomialChaosMaximumNumberOfTerms	(512)
+#define	kPolynomialChaosDesignOversampling	(3)
+#define	kPolynomialChaosFileVersion		(1)
+
+/*
+ *	Polynomial chaos expansion of the cutting stress in the uncertain inputs.
+ *	Each uncertain input `x_d` is mapped to a uniform variable `u_d` in (0, 1)
+ *	by its CDF, and the expansion is a sum of products of orthonormal Legendre
+ *	polynomials in `2 u_d - 1`. Because the basis is orthonormal, the mean is the
+ *	first coefficient and the variance is the sum of the squares of the others.
+ */
+typedef struct PolynomialChaosExpansion
+{
+	uint64_t	inputDistributionsHash;
+	size_t		numberOfDimensions;
+	size_t		inputIndices[kInputDistributionIndexMax];
+	size_t		degree;
+	double		qNorm;
+	size_t		numberOfTerms;
+	size_t		numberOfDesignPoints;
+	double		validationError;
+	uint8_t		multiIndices[kPolynomialChaosMaximumNumberOfTerms][kInputDistributionIndexMax];
+	double		coefficients[kPolynomialChaosMaximumNumberOfTerms];
+} PolynomialChaosExpansion;
+
+/*
+ *	Scratch space for evaluating an expansion at a block of points: the uniform
+ *	coordinates of the points, and the values of the Legendre polynomials of each
+ *	degree at them.
+ */
+typedef struct PolynomialChaosBlock
+{
+	double	uniforms[kInputDistributionIndexMax][kInputSampleBlockSize];
+	double	legendre[kInputDistributionIndexMax][kPolynomialChaosMaximumDegree + 1][kInputSampleBlockSize];
+	double	product[kInputSampleBlockSize];
+	double	sigmaCMpa[kInputSampleBlockSize];
+} PolynomialChaosBlock;
+
+/**
+ *	@brief	Fit a sparse polynomial chaos expansion of the cutting stress by least-squares
+ *		regression on a Latin hypercube design. The basis is the hyperbolic cross of
+ *		multi-indices `α` with `(Σ α_d^q)^(1/q) <= degree`, which keeps the low-order
+ *		interactions and drops most high-order ones.
+ *
+ *	@param	expansion	: Pointer to the expansion to fit.
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	polynomialChaosExpansionFit(PolynomialChaosExpansion *  expansion, const CommandLineArguments *  arguments);
+
+/**
+ *	@brief	Get the mean of the cutting stress from the coefficients of an expansion.
+ *
+ *	@param	expansion	: Pointer to the expansion.
+ *	@return			: The mean.
+ */
+double	polynomialChaosExpansionMean(const PolynomialChaosExpansion *  expansion);
+
+/**
+ *	@brief	Get the variance of the cutting stress from the coefficients of an expansion.
+ *
+ *	@param	expansion	: Pointer to the expansion.
+ *	@return			: The variance.
+ */
+double	polynomialChaosExpansionVariance(const PolynomialChaosExpansion *  expansion);
+
+/**
+ *	@brief	Get the first-order and total Sobol indices of each uncertain input from the
+ *		coefficients of an expansion.
+ *
+ *	@param	expansion	: Pointer to the expansion.
+ *	@param	firstOrder	: Array of `numberOfDimensions` elements to store the first-order indices.
+ *	@param	total		: Array of `numberOfDimensions` elements to store the total indices.
+ */
+void	polynomialChaosExpansionSobolIndices(const PolynomialChaosExpansion *  expansion, double *  firstOrder, double *  total);
+
+/**
+ *	@brief	Evaluate an expansion at the points whose uniform coordinates are in
+ *		`block->uniforms`, and store the values in `block->sigmaCMpa`.
+ *
+ *	@param	expansion	: Pointer to the expansion.
+ *	@param	block		: Pointer to the block of points.
+ *	@param	count		: Number of points (at most `kInputSampleBlockSize`).
+ */
+void	polynomialChaosExpansionEvaluateBlock(
+		const PolynomialChaosExpansion *	expansion,
+		PolynomialChaosBlock *			block,
+		size_t					count);
+
+/**
+ *	@brief	Save an expansion to a file.
+ *
+ *	@param	expansion	: Pointer to the expansion.
+ *	@param	path		: Path to the file.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	polynomialChaosExpansionSave(const PolynomialChaosExpansion *  expansion, const char *  path);
+
+/**
+ *	@brief	Load an expansion saved by `polynomialChaosExpansionSave()`. The expansion must
+ *		have been fitted for the input distributions in `arguments`.
+ *
+ *	@param	expansion	: Pointer to the expansion to load into.
+ *	@param	path		: Path to the file.
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	polynomialChaosExpansionLoad(
+					PolynomialChaosExpansion *	expansion,
+					const char *			path,
+					const CommandLineArguments *	arguments);
+
+/**
+ *	@brief	Fit or load a polynomial chaos expansion, report the mean, variance, and Sobol
+ *		indices of the cutting stress from its coefficients, and sample the expansion
+ *		instead of the model.
+ *
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runPolynomialChaos(const CommandLineArguments *  arguments);
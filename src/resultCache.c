@@ -0,0 +1,166 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "resultCache.h"
+#include "brownHamModel.h"
+#include "sampling.h"
+#include "hash.h"
+#include "common.h"
+
+
+static const char	kResultCacheMagic[8] = {'B', 'H', 'C', 'A', 'C', 'H', 'E', '\0'};
+
+typedef struct ResultCacheFileHeader
+{
+	char		magic[8];
+	uint64_t	version;
+	uint64_t	entrySize;
+} ResultCacheFileHeader;
+
+static void
+getResultCacheFilePath(const ResultCache *  cache, uint64_t key, char *  path, size_t size)
+{
+	snprintf(path, size, "%s/%016" PRIx64 ".cache", cache->directory, key);
+
+	return;
+}
+
+CommonConstantReturnType
+resultCacheInit(ResultCache *  cache, const char *  directory)
+{
+	struct stat	status;
+
+	memset(cache, 0, sizeof(ResultCache));
+
+	if ((stat(directory, &status) != 0) || !S_ISDIR(status.st_mode))
+	{
+		fprintf(stderr, "Error: The result cache directory \"%s\" does not exist.\n", directory);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	cache->directory = directory;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+uint64_t
+resultCacheGetKey(const MonteCarloRun *  run, size_t numberOfSamples)
+{
+	const char	kModel[] = "brownHam";
+	uint64_t	hash = kHashFnv1aOffsetBasis;
+	uint64_t	value;
+
+	value = monteCarloRunGetConfigurationHash(run);
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	value = (uint64_t) numberOfSamples;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	value = (uint64_t) run->isTraceDistributionsEnabled;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	value = (uint64_t) run->isPartialsEnabled;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	hash = hashFnv1aBytes(hash, kModel, sizeof(kModel));
+
+	/*
+	 *	The versions of the kernel and of the sampler, so that a build that changes
+	 *	either never serves the results of the other.
+	 */
+	value = kBrownHamModelVersion;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	value = kInputSamplerVersion;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+
+	return hash;
+}
+
+bool
+resultCacheLookup(const ResultCache *  cache, uint64_t key, ResultCacheEntry *  entry)
+{
+	char			path[kResultCacheMaximumPathLength];
+	FILE *			file;
+	ResultCacheFileHeader	header;
+	bool			isFound;
+
+	getResultCacheFilePath(cache, key, path, sizeof(path));
+	file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	/*
+	 *	A file that is unreadable, from another version, or for another key is a miss.
+	 */
+	isFound = (fread(&header, sizeof(header), 1, file) == 1) &&
+			(memcmp(header.magic, kResultCacheMagic, sizeof(kResultCacheMagic)) == 0) &&
+			(header.version == kResultCacheVersion) &&
+			(header.entrySize == sizeof(ResultCacheEntry)) &&
+			(fread(entry, sizeof(ResultCacheEntry), 1, file) == 1) &&
+			(entry->key == key);
+	fclose(file);
+
+	return isFound;
+}
+
+CommonConstantReturnType
+resultCacheStore(const ResultCache *  cache, const ResultCacheEntry *  entry)
+{
+	char			path[kResultCacheMaximumPathLength];
+	char			temporaryPath[kResultCacheMaximumPathLength + sizeof(".tmp")];
+	FILE *			file;
+	ResultCacheFileHeader	header = {
+					.version	= kResultCacheVersion,
+					.entrySize	= sizeof(ResultCacheEntry),
+				};
+	bool			isWritten;
+
+	memcpy(header.magic, kResultCacheMagic, sizeof(kResultCacheMagic));
+	getResultCacheFilePath(cache, entry->key, path, sizeof(path));
+	snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+
+	file = fopen(temporaryPath, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", temporaryPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isWritten = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+			(fwrite(entry, sizeof(ResultCacheEntry), 1, file) == 1);
+	isWritten = (fclose(file) == 0) && isWritten;
+
+	if (!isWritten || (rename(temporaryPath, path) != 0))
+	{
+		fprintf(stderr, "Error: Could not write result cache file \"%s\".\n", path);
+		remove(temporaryPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
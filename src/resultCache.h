@@ -0,0 +1,104 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+#include "histogram.h"
+#include "monteCarlo.h"
+
+
+#define	kResultCacheVersion			(4)
+#define	kResultCacheMaximumPathLength		(4096)
+
+/*
+ *	Cached results of one native Monte Carlo configuration: the reported output
+ *	sample, the statistics, the output-domain counts, and the histograms of the
+ *	output, of the traced distributions, and of the partial derivatives. Whether the
+ *	traced distributions and partial derivatives are set is part of the key.
+ */
+typedef struct ResultCacheEntry
+{
+	uint64_t		key;
+	uint64_t		numberOfSamples;
+	uint64_t		numberOfKeptSamples;
+	uint64_t		numberOfNonFiniteOutputs;
+	uint64_t		numberOfNegativeOutputs;
+	double			lastSample;
+	double			mean;
+	double			variance;
+	StreamingHistogram	outputDistribution;
+	StreamingHistogram	traceDistributions[kTraceDistributionIndexMax];
+	StreamingHistogram	partialDistributions[kBrownHamModelPartialIndexMax];
+} ResultCacheEntry;
+
+/*
+ *	Content-addressed result cache: one file per key in `directory`.
+ */
+typedef struct ResultCache
+{
+	const char *		directory;
+} ResultCache;
+
+/**
+ *	@brief	Set up a result cache over a directory, which must exist.
+ *
+ *	@param	cache		: Pointer to the cache.
+ *	@param	directory	: Directory that holds the cache files.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	resultCacheInit(ResultCache *  cache, const char *  directory);
+
+/**
+ *	@brief	Compute the cache key of a native Monte Carlo run: its configuration hash,
+ *		the number of samples, whether it traces distributions and partial derivatives,
+ *		the model, and the versions of the kernel and of the sampler.
+ *
+ *	@param	run		: Pointer to a run set up with `monteCarloRunInit()`.
+ *	@param	numberOfSamples	: Number of Monte Carlo iterations.
+ *	@return			: The cache key.
+ */
+uint64_t	resultCacheGetKey(const MonteCarloRun *  run, size_t numberOfSamples);
+
+/**
+ *	@brief	Look up an entry.
+ *
+ *	@param	cache	: Pointer to the cache.
+ *	@param	key	: The cache key.
+ *	@param	entry	: Pointer to store the entry if it is found.
+ *	@return		: `true` if the entry was found, else `false`.
+ */
+bool	resultCacheLookup(const ResultCache *  cache, uint64_t key, ResultCacheEntry *  entry);
+
+/**
+ *	@brief	Store an entry. The file is replaced atomically.
+ *
+ *	@param	cache	: Pointer to the cache.
+ *	@param	entry	: The entry, with its `key` set.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	resultCacheStore(const ResultCache *  cache, const ResultCacheEntry *  entry);
@@ -0,0 +1,478 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "reweighting.h"
+#include "monteCarlo.h"
+#include "common.h"
+
+
+static const char	kJointSamplesFileMagic[8] = {'B', 'H', 'J', 'O', 'I', 'N', 'T', '\0'};
+
+static const char * const	kInputVariableNames[kInputDistributionIndexMax] = {
+					[kInputDistributionIndexB]	= "b",
+					[kInputDistributionIndexG]	= "G",
+					[kInputDistributionIndexGamma]	= "gamma",
+					[kInputDistributionIndexM]	= "M",
+					[kInputDistributionIndexPhi]	= "phi",
+					[kInputDistributionIndexRs]	= "Rs",
+				};
+
+/*
+ *	Fixed-size header of a joint sample file. It is followed by the input
+ *	distributions, stored as they are in memory, and then by one column of
+ *	`numberOfSamples` doubles per input and one for the output.
+ */
+typedef struct JointSamplesFileHeader
+{
+	char		magic[8];
+	uint64_t	version;
+	uint64_t	distributionSize;
+	uint64_t	numberOfInputs;
+	uint64_t	numberOfSamples;
+} JointSamplesFileHeader;
+
+/*
+ *	An output sample and its importance weight, for the weighted quantiles.
+ */
+typedef struct WeightedSample
+{
+	double	value;
+	double	weight;
+} WeightedSample;
+
+static int
+compareWeightedSamples(const void *  a, const void *  b)
+{
+	double	valueA = ((const WeightedSample *) a)->value;
+	double	valueB = ((const WeightedSample *) b)->value;
+
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+CommonConstantReturnType
+jointSamplesSave(
+	const char *			path,
+	const InputDistribution *	distributions,
+	double * const *		inputSamples,
+	const double *			outputSamples,
+	size_t				numberOfSamples)
+{
+	FILE *			file = fopen(path, "wb");
+	JointSamplesFileHeader	header = {
+					.version		= kJointSamplesFileVersion,
+					.distributionSize	= sizeof(InputDistribution),
+					.numberOfInputs		= kInputDistributionIndexMax,
+					.numberOfSamples	= numberOfSamples,
+				};
+	bool			isWritten;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	memcpy(header.magic, kJointSamplesFileMagic, sizeof(kJointSamplesFileMagic));
+	isWritten = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+			(fwrite(distributions, sizeof(InputDistribution), kInputDistributionIndexMax, file) == kInputDistributionIndexMax);
+	for (size_t d = 0; isWritten && (d < kInputDistributionIndexMax); d++)
+	{
+		isWritten = (fwrite(inputSamples[d], sizeof(double), numberOfSamples, file) == numberOfSamples);
+	}
+	isWritten = isWritten && (fwrite(outputSamples, sizeof(double), numberOfSamples, file) == numberOfSamples);
+	isWritten = (fclose(file) == 0) && isWritten;
+
+	if (!isWritten)
+	{
+		fprintf(stderr, "Error: Could not write joint sample file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+jointSamplesLoad(const char *  path, JointSamples *  samples)
+{
+	FILE *			file = fopen(path, "rb");
+	JointSamplesFileHeader	header;
+	bool			isValid;
+
+	memset(samples, 0, sizeof(JointSamples));
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open joint sample file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((fread(&header, sizeof(header), 1, file) != 1) ||
+		(memcmp(header.magic, kJointSamplesFileMagic, sizeof(kJointSamplesFileMagic)) != 0) ||
+		(header.version != kJointSamplesFileVersion) ||
+		(header.distributionSize != sizeof(InputDistribution)) ||
+		(header.numberOfInputs != kInputDistributionIndexMax) ||
+		(header.numberOfSamples == 0) || (header.numberOfSamples > SIZE_MAX / ((kInputDistributionIndexMax + 1) * sizeof(double))))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a joint sample file of this version of the application.\n", path);
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	One allocation holds the input columns followed by the output column.
+	 */
+	samples->numberOfSamples = header.numberOfSamples;
+	samples->outputSamples = (double *) checkedMalloc((kInputDistributionIndexMax + 1) * samples->numberOfSamples * sizeof(double), __FILE__, __LINE__);
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		samples->inputSamples[d] = &samples->outputSamples[(d + 1) * samples->numberOfSamples];
+	}
+
+	isValid = (fread(samples->distributions, sizeof(InputDistribution), kInputDistributionIndexMax, file) == kInputDistributionIndexMax);
+	for (size_t d = 0; isValid && (d < kInputDistributionIndexMax); d++)
+	{
+		isValid = (fread(samples->inputSamples[d], sizeof(double), samples->numberOfSamples, file) == samples->numberOfSamples);
+	}
+	isValid = isValid && (fread(samples->outputSamples, sizeof(double), samples->numberOfSamples, file) == samples->numberOfSamples);
+	fclose(file);
+
+	if (!isValid)
+	{
+		fprintf(stderr, "Error: The joint sample file \"%s\" is truncated.\n", path);
+		jointSamplesFree(samples);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+jointSamplesFree(JointSamples *  samples)
+{
+	free(samples->outputSamples);
+	memset(samples, 0, sizeof(JointSamples));
+
+	return;
+}
+
+/*
+ *	Probability that a sample of `target` is inside the support of `proposal`. A
+ *	constant target can only be reached from the same constant.
+ */
+static double
+getSupportCoverage(const InputDistribution *  proposal, const InputDistribution *  target)
+{
+	if (target->kind == kInputDistributionKindConstant)
+	{
+		return ((proposal->kind == kInputDistributionKindConstant) && (proposal->value == target->value)) ? 1.0 : 0.0;
+	}
+
+	switch (proposal->kind)
+	{
+		case kInputDistributionKindConstant:
+			return 0.0;
+
+		case kInputDistributionKindUniform:
+			return inputDistributionCdf(target, proposal->max) - inputDistributionCdf(target, proposal->min);
+
+		case kInputDistributionKindGaussianMixture:
+			if (proposal->isTruncated)
+			{
+				return inputDistributionCdf(target, proposal->truncationUpper) - inputDistributionCdf(target, proposal->truncationLower);
+			}
+
+			return 1.0;
+	}
+
+	return 0.0;
+}
+
+void
+computeImportanceWeights(
+	const JointSamples *		samples,
+	const InputDistribution *	targets,
+	double *			weights,
+	double *			coverage)
+{
+	size_t	numberOfSamples = samples->numberOfSamples;
+
+	*coverage = 1.0;
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		weights[i] = isfinite(samples->outputSamples[i]) ? 1.0 : 0.0;
+	}
+
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		const InputDistribution *	proposal = &samples->distributions[d];
+		const InputDistribution *	target = &targets[d];
+		const double *			x = samples->inputSamples[d];
+
+		*coverage = fmin(*coverage, getSupportCoverage(proposal, target));
+
+		/*
+		 *	Constants contribute a factor of one if they are unchanged. Otherwise,
+		 *	the coverage is zero and the weights are not used.
+		 */
+		if ((proposal->kind == kInputDistributionKindConstant) || (target->kind == kInputDistributionKindConstant))
+		{
+			continue;
+		}
+
+		if ((proposal->kind == kInputDistributionKindUniform) && (target->kind == kInputDistributionKindUniform))
+		{
+			double	ratio = (proposal->max - proposal->min) / (target->max - target->min);
+
+			#pragma omp simd
+			for (size_t i = 0; i < numberOfSamples; i++)
+			{
+				weights[i] *= ((x[i] >= target->min) && (x[i] <= target->max)) ? ratio : 0.0;
+			}
+
+			continue;
+		}
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			weights[i] *= inputDistributionPdf(target, x[i]) / inputDistributionPdf(proposal, x[i]);
+		}
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+runReweighting(const CommandLineArguments *  arguments)
+{
+	JointSamples		samples;
+	double *		weights;
+	WeightedSample *	sortedSamples;
+	double			coverage;
+	double			weightSum = 0.0;
+	double			squaredWeightSum = 0.0;
+	double			effectiveSampleSize;
+	double			statistics[5] = {0};
+	double			variance = 0.0;
+	const double		probabilities[3] = {0.05, 0.50, 0.95};
+	uint64_t		isReweighted = 1;
+	clock_t			start = clock();
+	double			cpuTimeUsedInSeconds;
+
+	if (jointSamplesLoad(arguments->reweightingFilePath, &samples) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		if (getSupportCoverage(&samples.distributions[d], &arguments->samplingDistributions[d]) < kReweightingMinimumSupportCoverage)
+		{
+			fprintf(stderr, "Warning: The saved samples of `%s` do not cover the support of its new distribution.\n", kInputVariableNames[d]);
+		}
+	}
+
+	weights = (double *) checkedMalloc(samples.numberOfSamples * sizeof(double), __FILE__, __LINE__);
+	computeImportanceWeights(&samples, arguments->samplingDistributions, weights, &coverage);
+
+	for (size_t i = 0; i < samples.numberOfSamples; i++)
+	{
+		weightSum += weights[i];
+		squaredWeightSum += weights[i] * weights[i];
+	}
+	effectiveSampleSize = (squaredWeightSum > 0.0) ? (weightSum * weightSum / squaredWeightSum) : 0.0;
+
+	/*
+	 *	If the weights degenerate, replace the saved samples by fresh samples of
+	 *	the current input distributions, with unit weights.
+	 */
+	if ((coverage < kReweightingMinimumSupportCoverage) ||
+		(effectiveSampleSize < kReweightingMinimumEffectiveSampleSizeFraction * samples.numberOfSamples))
+	{
+		MonteCarloRun	run;
+		size_t		numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+
+		if (coverage >= kReweightingMinimumSupportCoverage)
+		{
+			fprintf(stderr, "Warning: The effective sample size is %.0lf of %zu samples. Running %zu fresh samples instead.\n",
+				effectiveSampleSize, samples.numberOfSamples, numberOfSamples);
+		}
+		else
+		{
+			fprintf(stderr, "Warning: The saved samples cannot be reweighted to the new input distributions. Running %zu fresh samples instead.\n",
+				numberOfSamples);
+		}
+
+		jointSamplesFree(&samples);
+		free(weights);
+
+		if (monteCarloRunInit(&run, arguments) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		samples.numberOfSamples = numberOfSamples;
+		memcpy(samples.distributions, arguments->samplingDistributions, sizeof(samples.distributions));
+		samples.outputSamples = (double *) checkedMalloc((kInputDistributionIndexMax + 1) * numberOfSamples * sizeof(double), __FILE__, __LINE__);
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			samples.inputSamples[d] = &samples.outputSamples[(d + 1) * numberOfSamples];
+			run.inputSamples[d] = samples.inputSamples[d];
+		}
+
+		monteCarloRunExecute(&run, samples.outputSamples, numberOfSamples);
+		monteCarloRunFree(&run);
+
+		if ((arguments->jointSamplesFilePath != NULL) &&
+			(jointSamplesSave(
+				arguments->jointSamplesFilePath,
+				samples.distributions,
+				samples.inputSamples,
+				samples.outputSamples,
+				numberOfSamples) != kCommonConstantReturnTypeSuccess))
+		{
+			jointSamplesFree(&samples);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		weights = (double *) checkedMalloc(numberOfSamples * sizeof(double), __FILE__, __LINE__);
+		computeImportanceWeights(&samples, arguments->samplingDistributions, weights, &coverage);
+		weightSum = 0.0;
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			weightSum += weights[i];
+		}
+		effectiveSampleSize = weightSum;
+		isReweighted = 0;
+	}
+
+	/*
+	 *	Weighted mean, standard deviation, and quantiles of the output. Samples
+	 *	with a non-finite output have zero weight.
+	 */
+	sortedSamples = (WeightedSample *) checkedMalloc(samples.numberOfSamples * sizeof(WeightedSample), __FILE__, __LINE__);
+	for (size_t i = 0; i < samples.numberOfSamples; i++)
+	{
+		sortedSamples[i] = (WeightedSample) {
+			.value	= (weights[i] > 0.0) ? samples.outputSamples[i] : 0.0,
+			.weight	= weights[i],
+		};
+		statistics[0] += sortedSamples[i].weight * sortedSamples[i].value;
+	}
+	statistics[0] /= weightSum;
+
+	for (size_t i = 0; i < samples.numberOfSamples; i++)
+	{
+		variance += sortedSamples[i].weight * (sortedSamples[i].value - statistics[0]) * (sortedSamples[i].value - statistics[0]);
+	}
+	statistics[1] = sqrt(variance / weightSum);
+
+	qsort(sortedSamples, samples.numberOfSamples, sizeof(WeightedSample), compareWeightedSamples);
+	for (size_t j = 0; j < 3; j++)
+	{
+		double	target = probabilities[j] * weightSum;
+		double	cumulative = 0.0;
+		size_t	i;
+
+		for (i = 0; i + 1 < samples.numberOfSamples; i++)
+		{
+			cumulative += sortedSamples[i].weight;
+			if ((sortedSamples[i].weight > 0.0) && (cumulative >= target))
+			{
+				break;
+			}
+		}
+		statistics[2 + j] = sortedSamples[i].value;
+	}
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	if (arguments->common.isOutputJSONMode)
+	{
+		JSONVariable	variables[] = {
+			{
+				.variableSymbol = "sigmaCMpa",
+				.variableDescription = "Cutting stress (σc) (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+				.values = (JSONVariablePointer) { .asDouble = statistics},
+				.type = kJSONVariableTypeDouble,
+				.size = 5,
+			},
+			{
+				.variableSymbol = "effectiveSampleSize",
+				.variableDescription = "Effective sample size of the importance weights",
+				.values = (JSONVariablePointer) { .asDouble = &effectiveSampleSize},
+				.type = kJSONVariableTypeDouble,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "isReweighted",
+				.variableDescription = "Whether the saved samples were reweighted (1) or fresh samples were run (0)",
+				.values = (JSONVariablePointer) { .asUint64 = &isReweighted},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "cpuTimeUsed",
+				.variableDescription = "CPU time used (s)",
+				.values = (JSONVariablePointer) { .asDouble = &cpuTimeUsedInSeconds},
+				.type = kJSONVariableTypeDoubleParticle,
+				.size = 1,
+			},
+		};
+
+		printJSONVariables(variables, arguments->common.isTimingEnabled ? 4 : 3, "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	}
+	else
+	{
+		if (isReweighted)
+		{
+			printf("Reweighted %zu samples of \"%s\": effective sample size %.0lf (%.1lf%%).\n",
+				samples.numberOfSamples,
+				arguments->reweightingFilePath,
+				effectiveSampleSize,
+				100.0 * effectiveSampleSize / samples.numberOfSamples);
+		}
+		printf("Cutting stress (σc): mean %le, standard deviation %le, 5th/50th/95th percentiles %le/%le/%le MPa\n",
+			statistics[0], statistics[1], statistics[2], statistics[3], statistics[4]);
+
+		if (arguments->common.isTimingEnabled)
+		{
+			printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+		}
+	}
+
+	free(sortedSamples);
+	free(weights);
+	jointSamplesFree(&samples);
+
+	return kCommonConstantReturnTypeSuccess;
+}
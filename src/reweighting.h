@@ -0,0 +1,109 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+#include "utilities.h"
+#include "sampling.h"
+
+
+#define	kJointSamplesFileVersion				(1)
+#define	kReweightingMinimumEffectiveSampleSizeFraction		(0.1)
+#define	kReweightingMinimumSupportCoverage			(1.0 - 1E-6)
+
+/*
+ *	Joint input and output samples of a Monte Carlo run, together with the input
+ *	distributions they were drawn from. The samples are stored column-wise.
+ */
+typedef struct JointSamples
+{
+	size_t			numberOfSamples;
+	InputDistribution	distributions[kInputDistributionIndexMax];
+	double *		inputSamples[kInputDistributionIndexMax];
+	double *		outputSamples;
+} JointSamples;
+
+/**
+ *	@brief	Save the joint input and output samples of a Monte Carlo run.
+ *
+ *	@param	path			: Path to the joint sample file.
+ *	@param	distributions		: Array of the `kInputDistributionIndexMax` input distributions the samples were drawn from.
+ *	@param	inputSamples		: Array of `kInputDistributionIndexMax` arrays of `numberOfSamples` input samples.
+ *	@param	outputSamples		: Array of `numberOfSamples` output samples.
+ *	@param	numberOfSamples		: Number of samples.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	jointSamplesSave(
+					const char *			path,
+					const InputDistribution *	distributions,
+					double * const *		inputSamples,
+					const double *			outputSamples,
+					size_t				numberOfSamples);
+
+/**
+ *	@brief	Load the joint input and output samples saved by `jointSamplesSave()`.
+ *
+ *	@param	path		: Path to the joint sample file.
+ *	@param	samples		: Pointer to the samples to load into.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	jointSamplesLoad(const char *  path, JointSamples *  samples);
+
+/**
+ *	@brief	Free joint samples loaded with `jointSamplesLoad()`.
+ *
+ *	@param	samples		: Pointer to the samples.
+ */
+void	jointSamplesFree(JointSamples *  samples);
+
+/**
+ *	@brief	Compute the importance weights that turn samples of the input distributions
+ *		`proposals` into samples of the input distributions `targets`: the product over
+ *		the inputs of the ratio of the target density to the proposal density.
+ *
+ *	@param	samples		: Pointer to the samples, drawn from `samples->distributions`.
+ *	@param	targets		: Array of the `kInputDistributionIndexMax` target input distributions.
+ *	@param	weights		: Array of `samples->numberOfSamples` elements to store the weights.
+ *	@param	coverage	: Pointer to store the lowest probability, over the inputs, that a target
+ *				  sample is inside the support of its proposal. Reweighting is biased
+ *				  unless this is one.
+ */
+void	computeImportanceWeights(
+		const JointSamples *		samples,
+		const InputDistribution *	targets,
+		double *			weights,
+		double *			coverage);
+
+/**
+ *	@brief	Estimate the statistics of the output under the current input distributions by
+ *		reweighting saved joint samples. If the weights degenerate, run fresh Monte Carlo
+ *		samples instead, and save them if a joint sample file to save to is given.
+ *
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runReweighting(const CommandLineArguments *  arguments);
@@ -0,0 +1,203 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "runFile.h"
+#include "common.h"
+
+
+static const char	kRunFileMagic[8] = {'B', 'H', 'M', 'C', 'R', 'U', 'N', '\0'};
+
+/*
+ *	Fixed-size header of a run file. It is followed by the output histogram, by the
+ *	`kTraceDistributionIndexMax` traced histograms if `hasTraceDistributions` is set,
+ *	and by the `kBrownHamModelPartialIndexMax` partial-derivative histograms if
+ *	`hasPartialDistributions` is set. The histograms are stored as they are in memory, so a run file can
+ *	only be extended by a build with the same `StreamingHistogram` layout.
+ */
+typedef struct RunFileHeader
+{
+	char		magic[8];
+	uint64_t	version;
+	uint64_t	histogramSize;
+	uint64_t	configurationHash;
+	uint64_t	nextBlockIndex;
+	uint64_t	numberOfSamples;
+	uint64_t	numberOfStronglyCoupledSamples;
+	uint64_t	numberOfNonFiniteOutputs;
+	uint64_t	numberOfNegativeOutputs;
+	uint64_t	hasTraceDistributions;
+	uint64_t	hasPartialDistributions;
+} RunFileHeader;
+
+CommonConstantReturnType
+monteCarloRunLoadRunFile(MonteCarloRun *  run, const char *  path, bool *  isLoaded)
+{
+	FILE *		file = fopen(path, "rb");
+	RunFileHeader	header;
+	bool		isValid;
+
+	*isLoaded = false;
+	if (file == NULL)
+	{
+		if (errno == ENOENT)
+		{
+			return kCommonConstantReturnTypeSuccess;
+		}
+
+		fprintf(stderr, "Error: Could not open run file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((fread(&header, sizeof(header), 1, file) != 1) ||
+		(memcmp(header.magic, kRunFileMagic, sizeof(kRunFileMagic)) != 0) ||
+		(header.version != kRunFileVersion) ||
+		(header.histogramSize != sizeof(StreamingHistogram)))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a run file of this version of the application.\n", path);
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (header.configurationHash != monteCarloRunGetConfigurationHash(run))
+	{
+		fprintf(stderr, "Error: The run in \"%s\" used a different seed, input distributions, correlations, particle-size distribution, pair-coupling regime setting (`-w`), or domain policy (`-n`).\n", path);
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((header.hasTraceDistributions != 0) != run->isTraceDistributionsEnabled)
+	{
+		fprintf(stderr, "Error: The run in \"%s\" was saved %s `-d`, so it must be extended %s `-d`.\n",
+			path,
+			header.hasTraceDistributions ? "with" : "without",
+			header.hasTraceDistributions ? "with" : "without");
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((header.hasPartialDistributions != 0) != run->isPartialsEnabled)
+	{
+		fprintf(stderr, "Error: The run in \"%s\" was saved %s `-D`, so it must be extended %s `-D`.\n",
+			path,
+			header.hasPartialDistributions ? "with" : "without",
+			header.hasPartialDistributions ? "with" : "without");
+		fclose(file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isValid = (fread(&run->outputDistribution, sizeof(StreamingHistogram), 1, file) == 1);
+	if (isValid && run->isTraceDistributionsEnabled)
+	{
+		isValid = (fread(run->traceDistributions, sizeof(StreamingHistogram), kTraceDistributionIndexMax, file) == kTraceDistributionIndexMax);
+	}
+	if (isValid && run->isPartialsEnabled)
+	{
+		isValid = (fread(run->partialDistributions, sizeof(StreamingHistogram), kBrownHamModelPartialIndexMax, file) == kBrownHamModelPartialIndexMax);
+	}
+	fclose(file);
+
+	if (!isValid)
+	{
+		fprintf(stderr, "Error: The run file \"%s\" is truncated.\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	run->nextBlockIndex = header.nextBlockIndex;
+	run->numberOfSamples = header.numberOfSamples;
+	run->numberOfStronglyCoupledSamples = header.numberOfStronglyCoupledSamples;
+	run->numberOfNonFiniteOutputs = header.numberOfNonFiniteOutputs;
+	run->numberOfNegativeOutputs = header.numberOfNegativeOutputs;
+	*isLoaded = true;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+monteCarloRunSaveRunFile(const MonteCarloRun *  run, const char *  path)
+{
+	FILE *		file;
+	char *		temporaryPath;
+	size_t		temporaryPathSize = strlen(path) + sizeof(".tmp");
+	RunFileHeader	header = {
+				.version		= kRunFileVersion,
+				.histogramSize		= sizeof(StreamingHistogram),
+				.configurationHash	= monteCarloRunGetConfigurationHash(run),
+				.nextBlockIndex		= run->nextBlockIndex,
+				.numberOfSamples	= run->numberOfSamples,
+				.numberOfStronglyCoupledSamples	= run->numberOfStronglyCoupledSamples,
+				.numberOfNonFiniteOutputs	= run->numberOfNonFiniteOutputs,
+				.numberOfNegativeOutputs	= run->numberOfNegativeOutputs,
+				.hasTraceDistributions	= run->isTraceDistributionsEnabled,
+				.hasPartialDistributions	= run->isPartialsEnabled,
+			};
+	bool		isWritten;
+
+	memcpy(header.magic, kRunFileMagic, sizeof(kRunFileMagic));
+
+	temporaryPath = (char *) checkedMalloc(temporaryPathSize, __FILE__, __LINE__);
+	snprintf(temporaryPath, temporaryPathSize, "%s.tmp", path);
+
+	file = fopen(temporaryPath, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", temporaryPath);
+		free(temporaryPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isWritten = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+			(fwrite(&run->outputDistribution, sizeof(StreamingHistogram), 1, file) == 1);
+	if (isWritten && run->isTraceDistributionsEnabled)
+	{
+		isWritten = (fwrite(run->traceDistributions, sizeof(StreamingHistogram), kTraceDistributionIndexMax, file) == kTraceDistributionIndexMax);
+	}
+	if (isWritten && run->isPartialsEnabled)
+	{
+		isWritten = (fwrite(run->partialDistributions, sizeof(StreamingHistogram), kBrownHamModelPartialIndexMax, file) == kBrownHamModelPartialIndexMax);
+	}
+	isWritten = (fclose(file) == 0) && isWritten;
+
+	if (!isWritten || (rename(temporaryPath, path) != 0))
+	{
+		fprintf(stderr, "Error: Could not write run file \"%s\".\n", path);
+		remove(temporaryPath);
+		free(temporaryPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	free(temporaryPath);
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,59 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "common.h"
+#include "monteCarlo.h"
+
+
+#define	kRunFileVersion		(6)
+
+/**
+ *	@brief	Restore the accumulated distributions and the position of the random number
+ *		streams of a native Monte Carlo run from a run file, so that the next call to
+ *		`monteCarloRunExecute()` extends the saved run. The run must have been set up
+ *		with the same seed, input distributions, correlations, particle-size distribution,
+ *		pair-coupling regime and domain policy settings, and `-d` and `-D` settings as the
+ *		saved run. If the file does not exist, the run is left
+ *		as it is.
+ *
+ *	@param	run		: Pointer to a run set up with `monteCarloRunInit()`.
+ *	@param	path		: Path to the run file.
+ *	@param	isLoaded	: Pointer to store whether the file existed and was loaded.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	monteCarloRunLoadRunFile(MonteCarloRun *  run, const char *  path, bool *  isLoaded);
+
+/**
+ *	@brief	Save the accumulated distributions and the position of the random number
+ *		streams of a native Monte Carlo run to a run file. The file is replaced
+ *		atomically, so an interrupted save keeps the previous run file.
+ *
+ *	@param	run	: Pointer to the run.
+ *	@param	path	: Path to the run file.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	monteCarloRunSaveRunFile(const MonteCarloRun *  run, const char *  path);
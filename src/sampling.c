@@ -0,0 +1,1257 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sampling.h"
+#include "hash.h"
+#include "common.h"
+
+
+static inline uint64_t
+splitMix64Next(uint64_t *  state)
+{
+	uint64_t	z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+
+	z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+	z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+
+	return z ^ (z >> 31);
+}
+
+void
+samplerRandomNumberGeneratorInit(
+	SamplerRandomNumberGenerator *	generator,
+	uint64_t			seed,
+	uint64_t			streamIndex)
+{
+	uint64_t	splitMixState = seed;
+
+	/*
+	 *	Mix the stream index into the seed through an extra SplitMix64 round so
+	 *	that neighbouring streams start from unrelated states.
+	 */
+	splitMixState ^= splitMix64Next(&streamIndex);
+	for (size_t i = 0; i < 4; i++)
+	{
+		generator->state[i] = splitMix64Next(&splitMixState);
+	}
+
+	return;
+}
+
+void
+samplerFillUniforms(
+	SamplerRandomNumberGenerator *	generator,
+	double *			uniforms,
+	size_t				count)
+{
+	/*
+	 *	Use the top 53 bits and offset by half a unit so that samples lie in (0, 1).
+	 */
+	for (size_t i = 0; i < count; i++)
+	{
+		uniforms[i] = ((samplerRandomNumberGeneratorNext(generator) >> 11) + 0.5) * 0x1.0p-53;
+	}
+
+	return;
+}
+
+void
+samplerFillStandardNormals(
+	SamplerRandomNumberGenerator *	generator,
+	double *			normals,
+	size_t				count)
+{
+	size_t	numberOfPairs = (count + 1) / 2;
+	double	radii[kInputSampleBlockSize / 2];
+	double	angles[kInputSampleBlockSize / 2];
+
+	/*
+	 *	Box–Muller transform. Draw the uniforms first so that the transform loop
+	 *	has no dependence on the generator state and vectorizes.
+	 */
+	for (size_t start = 0; start < numberOfPairs; start += kInputSampleBlockSize / 2)
+	{
+		size_t	n = (numberOfPairs - start < kInputSampleBlockSize / 2) ? (numberOfPairs - start) : (kInputSampleBlockSize / 2);
+
+		samplerFillUniforms(generator, radii, n);
+		samplerFillUniforms(generator, angles, n);
+
+		for (size_t i = 0; i < n; i++)
+		{
+			radii[i] = sqrt(-2.0 * log(radii[i]));
+			angles[i] = 2.0 * M_PI * angles[i];
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			size_t	index = 2 * (start + i);
+
+			normals[index] = radii[i] * cos(angles[i]);
+			if (index + 1 < count)
+			{
+				normals[index + 1] = radii[i] * sin(angles[i]);
+			}
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Base strip and layer areas of Doornik's 128-layer ziggurat.
+ */
+static const double	kSamplerZigguratTailStart = 3.442619855899;
+static const double	kSamplerZigguratLayerArea = 9.91256303526217e-3;
+
+static inline double
+samplerNextUniform(SamplerRandomNumberGenerator *  generator)
+{
+	return ((samplerRandomNumberGeneratorNext(generator) >> 11) + 0.5) * 0x1.0p-53;
+}
+
+/*
+ *	The layer of a candidate comes from its low bits and the signed uniform in
+ *	(-1, 1) from its top 53 bits, so that the two are independent.
+ */
+static inline size_t
+zigguratLayer(uint64_t bits)
+{
+	return (size_t) (bits & (kSamplerZigguratNumberOfLayers - 1));
+}
+
+static inline double
+zigguratSignedUniform(uint64_t bits)
+{
+	return ((bits >> 11) + 0.5) * 0x1.0p-52 - 1.0;
+}
+
+void
+samplerZigguratInit(SamplerZiggurat *  ziggurat)
+{
+	double	f = exp(-0.5 * kSamplerZigguratTailStart * kSamplerZigguratTailStart);
+
+	ziggurat->edges[0] = kSamplerZigguratLayerArea / f;
+	ziggurat->edges[1] = kSamplerZigguratTailStart;
+	ziggurat->edges[kSamplerZigguratNumberOfLayers] = 0.0;
+	for (size_t i = 2; i < kSamplerZigguratNumberOfLayers; i++)
+	{
+		ziggurat->edges[i] = sqrt(-2.0 * log(kSamplerZigguratLayerArea / ziggurat->edges[i - 1] + f));
+		f = exp(-0.5 * ziggurat->edges[i] * ziggurat->edges[i]);
+	}
+
+	for (size_t i = 0; i < kSamplerZigguratNumberOfLayers; i++)
+	{
+		ziggurat->ratios[i] = ziggurat->edges[i + 1] / ziggurat->edges[i];
+	}
+
+	return;
+}
+
+/*
+ *	Resolve a candidate outside the rectangle of its layer: sample the tail beyond
+ *	the base strip, or test the wedge under the density, and draw new candidates
+ *	until one is accepted.
+ */
+static double
+zigguratSampleSlow(
+	SamplerRandomNumberGenerator *	generator,
+	const SamplerZiggurat *		ziggurat,
+	size_t				layer,
+	double				u)
+{
+	for (;;)
+	{
+		uint64_t	bits;
+
+		if (layer == 0)
+		{
+			double	x;
+			double	y;
+
+			do
+			{
+				x = log(samplerNextUniform(generator)) / kSamplerZigguratTailStart;
+				y = log(samplerNextUniform(generator));
+			} while (-2.0 * y < x * x);
+
+			return (u < 0.0) ? (x - kSamplerZigguratTailStart) : (kSamplerZigguratTailStart - x);
+		}
+		else
+		{
+			double	x = u * ziggurat->edges[layer];
+			double	f0 = exp(-0.5 * (ziggurat->edges[layer] * ziggurat->edges[layer] - x * x));
+			double	f1 = exp(-0.5 * (ziggurat->edges[layer + 1] * ziggurat->edges[layer + 1] - x * x));
+
+			if (f1 + samplerNextUniform(generator) * (f0 - f1) < 1.0)
+			{
+				return x;
+			}
+		}
+
+		bits = samplerRandomNumberGeneratorNext(generator);
+		layer = zigguratLayer(bits);
+		u = zigguratSignedUniform(bits);
+		if (fabs(u) < ziggurat->ratios[layer])
+		{
+			return u * ziggurat->edges[layer];
+		}
+	}
+}
+
+void
+samplerFillStandardNormalsZiggurat(
+	SamplerRandomNumberGenerator *	generator,
+	const SamplerZiggurat *		ziggurat,
+	double *			normals,
+	size_t				count)
+{
+	uint64_t	bits[kInputSampleBlockSize];
+
+	for (size_t start = 0; start < count; start += kInputSampleBlockSize)
+	{
+		size_t	n = (count - start < kInputSampleBlockSize) ? (count - start) : kInputSampleBlockSize;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			bits[i] = samplerRandomNumberGeneratorNext(generator);
+		}
+
+		#pragma omp simd
+		for (size_t i = 0; i < n; i++)
+		{
+			normals[start + i] = zigguratSignedUniform(bits[i]) * ziggurat->edges[zigguratLayer(bits[i])];
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			size_t	layer = zigguratLayer(bits[i]);
+			double	u = zigguratSignedUniform(bits[i]);
+
+			if (!(fabs(u) < ziggurat->ratios[layer]))
+			{
+				normals[start + i] = zigguratSampleSlow(generator, ziggurat, layer, u);
+			}
+		}
+	}
+
+	return;
+}
+
+double
+standardNormalCdf(double x)
+{
+	return 0.5 * erfc(-x * M_SQRT1_2);
+}
+
+double
+standardNormalQuantile(double p)
+{
+	double	q = p - 0.5;
+	double	r;
+	double	value;
+
+	if (p <= 0.0)
+	{
+		return -INFINITY;
+	}
+	if (p >= 1.0)
+	{
+		return INFINITY;
+	}
+
+	if (fabs(q) <= 0.425)
+	{
+		r = 0.180625 - q * q;
+
+		return q * (((((((2.5090809287301226727e+3 * r + 3.3430575583588128105e+4) * r + 6.7265770927008700853e+4) * r
+				+ 4.5921953931549871457e+4) * r + 1.3731693765509461125e+4) * r + 1.9715909503065514427e+3) * r
+				+ 1.3314166789178437745e+2) * r + 3.3871328727963666080e+0)
+			/ (((((((5.2264952788528545610e+3 * r + 2.8729085735721942674e+4) * r + 3.9307895800092710610e+4) * r
+				+ 2.1213794301586595867e+4) * r + 5.3941960214247511077e+3) * r + 6.8718700749205790830e+2) * r
+				+ 4.2313330701600911252e+1) * r + 1.0);
+	}
+
+	r = sqrt(-log((q < 0.0) ? p : (1.0 - p)));
+	if (r <= 5.0)
+	{
+		r -= 1.6;
+		value = (((((((7.74545014278341407640e-4 * r + 2.27238449892691845833e-2) * r + 2.41780725177450611770e-1) * r
+				+ 1.27045825245236838258e+0) * r + 3.64784832476320460504e+0) * r + 5.76949722146069140550e+0) * r
+				+ 4.63033784615654529590e+0) * r + 1.42343711074968357734e+0)
+			/ (((((((1.05075007164441684324e-9 * r + 5.47593808499534494600e-4) * r + 1.51986665636164571966e-2) * r
+				+ 1.48103976427480074590e-1) * r + 6.89767334985100004550e-1) * r + 1.67638483018380384940e+0) * r
+				+ 2.05319162663775882187e+0) * r + 1.0);
+	}
+	else
+	{
+		r -= 5.0;
+		value = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r + 1.24266094738807843860e-3) * r
+				+ 2.65321895265761230930e-2) * r + 2.96560571828504891230e-1) * r + 1.78482653991729133580e+0) * r
+				+ 5.46378491116411436990e+0) * r + 6.65790464350110377720e+0)
+			/ (((((((2.04426310338993978564e-15 * r + 1.42151175831644588870e-7) * r + 1.84631831751005468180e-5) * r
+				+ 7.86869131145613259100e-4) * r + 1.48753612908506148525e-2) * r + 1.36929880922735805310e-1) * r
+				+ 5.99832206555887937690e-1) * r + 1.0);
+	}
+
+	return (q < 0.0) ? -value : value;
+}
+
+/*
+ *	Distribution function of a Gaussian mixture, ignoring any truncation.
+ */
+static double
+gaussianMixtureCdf(const InputDistribution *  distribution, double x)
+{
+	double	cdf = 0.0;
+
+	for (size_t k = 0; k < distribution->numberOfComponents; k++)
+	{
+		cdf += distribution->weights[k] * standardNormalCdf((x - distribution->means[k]) / distribution->standardDeviations[k]);
+	}
+
+	return cdf;
+}
+
+/*
+ *	Probability that a Gaussian mixture, ignoring any truncation, puts between its
+ *	lower truncation bound and `x`. A component whose mean lies below the lower bound
+ *	contributes through its upper tail, Φ(-zLower) - Φ(-zX), since the lower-tail
+ *	difference cancels to zero once the bound is a few standard deviations above the mean.
+ */
+static double
+gaussianMixtureTruncatedCdf(const InputDistribution *  distribution, double x)
+{
+	double	cdf = 0.0;
+
+	for (size_t k = 0; k < distribution->numberOfComponents; k++)
+	{
+		double	zLower = (distribution->truncationLower - distribution->means[k]) / distribution->standardDeviations[k];
+		double	zX = (x - distribution->means[k]) / distribution->standardDeviations[k];
+
+		cdf += distribution->weights[k] * ((zLower > 0.0) ?
+			(standardNormalCdf(-zLower) - standardNormalCdf(-zX)) :
+			(standardNormalCdf(zX) - standardNormalCdf(zLower)));
+	}
+
+	return cdf;
+}
+
+/*
+ *	Probability that a Gaussian mixture, ignoring any truncation, puts within its truncation bounds.
+ */
+static double
+gaussianMixtureTruncatedMass(const InputDistribution *  distribution)
+{
+	return gaussianMixtureTruncatedCdf(distribution, distribution->truncationUpper);
+}
+
+/*
+ *	Quantile of component `k` of a truncated mixture, restricted to the truncation
+ *	bounds. As in inputDistributionInitTruncation, a component whose mean lies below
+ *	the lower bound is inverted through its upper tail.
+ */
+static double
+gaussianMixtureTruncatedComponentQuantile(const InputDistribution *  distribution, size_t k, double p)
+{
+	double	zLower = (distribution->truncationLower - distribution->means[k]) / distribution->standardDeviations[k];
+	double	zUpper = (distribution->truncationUpper - distribution->means[k]) / distribution->standardDeviations[k];
+	double	sign = (zLower > 0.0) ? -1.0 : 1.0;
+	double	base = standardNormalCdf(sign * zLower);
+	double	span = standardNormalCdf(sign * zUpper) - base;
+	double	x = distribution->means[k] + sign * distribution->standardDeviations[k] * standardNormalQuantile(base + p * span);
+
+	return fmin(fmax(x, distribution->truncationLower), distribution->truncationUpper);
+}
+
+double
+inputDistributionGetTruncatedMass(const InputDistribution *  distribution)
+{
+	if (distribution->kind != kInputDistributionKindGaussianMixture)
+	{
+		return 1.0;
+	}
+
+	return gaussianMixtureTruncatedMass(distribution);
+}
+
+double
+inputDistributionCdf(const InputDistribution *  distribution, double x)
+{
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			return (x >= distribution->value) ? 1.0 : 0.0;
+
+		case kInputDistributionKindUniform:
+			return fmin(fmax((x - distribution->min) / (distribution->max - distribution->min), 0.0), 1.0);
+
+		case kInputDistributionKindGaussianMixture:
+			if (!distribution->isTruncated)
+			{
+				return gaussianMixtureCdf(distribution, x);
+			}
+
+			if (x < distribution->truncationLower)
+			{
+				return 0.0;
+			}
+
+			if (x >= distribution->truncationUpper)
+			{
+				return 1.0;
+			}
+
+			return gaussianMixtureTruncatedCdf(distribution, x) / gaussianMixtureTruncatedMass(distribution);
+	}
+
+	return NAN;
+}
+
+/*
+ *	Density of a Gaussian mixture, for the Newton steps of its quantile function.
+ */
+static double
+gaussianMixturePdf(const InputDistribution *  distribution, double x)
+{
+	double	pdf = 0.0;
+
+	for (size_t k = 0; k < distribution->numberOfComponents; k++)
+	{
+		double	z = (x - distribution->means[k]) / distribution->standardDeviations[k];
+
+		pdf += distribution->weights[k] * exp(-0.5 * z * z) / (distribution->standardDeviations[k] * sqrt(2.0 * M_PI));
+	}
+
+	return pdf;
+}
+
+double
+inputDistributionPdf(const InputDistribution *  distribution, double x)
+{
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			return NAN;
+
+		case kInputDistributionKindUniform:
+			return ((x >= distribution->min) && (x <= distribution->max)) ? (1.0 / (distribution->max - distribution->min)) : 0.0;
+
+		case kInputDistributionKindGaussianMixture:
+			if (!distribution->isTruncated)
+			{
+				return gaussianMixturePdf(distribution, x);
+			}
+
+			if ((x < distribution->truncationLower) || (x > distribution->truncationUpper))
+			{
+				return 0.0;
+			}
+
+			return gaussianMixturePdf(distribution, x) / gaussianMixtureTruncatedMass(distribution);
+	}
+
+	return NAN;
+}
+
+double
+inputDistributionQuantile(const InputDistribution *  distribution, double p)
+{
+	double	lower = INFINITY;
+	double	upper = -INFINITY;
+	double	x;
+	double	z;
+
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			return distribution->value;
+
+		case kInputDistributionKindUniform:
+			return distribution->min + (distribution->max - distribution->min) * p;
+
+		case kInputDistributionKindGaussianMixture:
+			break;
+	}
+
+	/*
+	 *	The mixture quantile lies between the smallest and the largest component
+	 *	quantiles. Use safeguarded Newton iterations within that bracket. A truncated
+	 *	mixture is a mixture of its truncated components, so the same bracket holds
+	 *	with the quantiles of the truncated components.
+	 */
+	if (distribution->isTruncated)
+	{
+		p = fmin(fmax(p, 0.0), 1.0);
+		for (size_t k = 0; k < distribution->numberOfComponents; k++)
+		{
+			double	componentQuantile = gaussianMixtureTruncatedComponentQuantile(distribution, k, p);
+
+			lower = fmin(lower, componentQuantile);
+			upper = fmax(upper, componentQuantile);
+		}
+	}
+	else
+	{
+		p = fmin(fmax(p, DBL_MIN), 1.0 - DBL_EPSILON);
+		z = standardNormalQuantile(p);
+		for (size_t k = 0; k < distribution->numberOfComponents; k++)
+		{
+			double	componentQuantile = distribution->means[k] + distribution->standardDeviations[k] * z;
+
+			lower = fmin(lower, componentQuantile);
+			upper = fmax(upper, componentQuantile);
+		}
+	}
+
+	x = 0.5 * (lower + upper);
+	for (size_t iteration = 0; (iteration < 100) && (upper - lower > 4 * DBL_EPSILON * fabs(x)); iteration++)
+	{
+		double	residual = inputDistributionCdf(distribution, x) - p;
+		double	pdf = inputDistributionPdf(distribution, x);
+		double	next;
+
+		if (residual == 0.0)
+		{
+			break;
+		}
+
+		if (residual < 0.0)
+		{
+			lower = x;
+		}
+		else
+		{
+			upper = x;
+		}
+
+		next = x - residual / pdf;
+		x = ((pdf > 0.0) && (next > lower) && (next < upper)) ? next : 0.5 * (lower + upper);
+	}
+
+	if (distribution->isTruncated)
+	{
+		x = fmin(fmax(x, distribution->truncationLower), distribution->truncationUpper);
+	}
+
+	return x;
+}
+
+size_t
+inputDistributionGetNumberOfParameters(const InputDistribution *  distribution)
+{
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			return 1;
+
+		case kInputDistributionKindUniform:
+			return 2;
+
+		case kInputDistributionKindGaussianMixture:
+			return 3 * distribution->numberOfComponents - 1;
+	}
+
+	return 0;
+}
+
+void
+inputDistributionGetParameterName(
+	const InputDistribution *	distribution,
+	size_t				parameterIndex,
+	char *				name,
+	size_t				size)
+{
+	size_t	numberOfComponents = distribution->numberOfComponents;
+
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			snprintf(name, size, "Value");
+			break;
+
+		case kInputDistributionKindUniform:
+			snprintf(name, size, (parameterIndex == 0) ? "Min" : "Max");
+			break;
+
+		case kInputDistributionKindGaussianMixture:
+			if (parameterIndex < 2 * numberOfComponents)
+			{
+				snprintf(name, size, (parameterIndex % 2 == 0) ? "Mean%zu" : "StandardDeviation%zu", parameterIndex / 2 + 1);
+			}
+			else
+			{
+				snprintf(name, size, "Weight%zu", parameterIndex - 2 * numberOfComponents + 1);
+			}
+			break;
+	}
+
+	return;
+}
+
+/*
+ *	With the uniform variate `u = F(x; θ)` held fixed, `dx/dθ = -(∂F/∂θ) / f(x)`.
+ *	This is the reparameterization of the inverse-CDF sampler, and it holds for
+ *	the Gaussian copula too, since that also fixes `u`. For a mixture, it gives
+ *	the responsibility `w_k N_k(x) / f(x)` of component `k` for `dx/dμ_k`.
+ */
+void
+inputDistributionFillSampleDerivatives(
+	const InputDistribution *	distribution,
+	size_t				parameterIndex,
+	const double *			samples,
+	double *			derivatives,
+	size_t				count)
+{
+	size_t	numberOfComponents = distribution->numberOfComponents;
+	size_t	k = parameterIndex / 2;
+	size_t	last = numberOfComponents - 1;
+
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			for (size_t i = 0; i < count; i++)
+			{
+				derivatives[i] = 1.0;
+			}
+			break;
+
+		case kInputDistributionKindUniform:
+			#pragma omp simd
+			for (size_t i = 0; i < count; i++)
+			{
+				double	u = (samples[i] - distribution->min) / (distribution->max - distribution->min);
+
+				derivatives[i] = (parameterIndex == 0) ? (1.0 - u) : u;
+			}
+			break;
+
+		case kInputDistributionKindGaussianMixture:
+			if (parameterIndex >= 2 * numberOfComponents)
+			{
+				k = parameterIndex - 2 * numberOfComponents;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				double	z = (samples[i] - distribution->means[k]) / distribution->standardDeviations[k];
+				double	pdf = gaussianMixturePdf(distribution, samples[i]);
+				double	responsibility = distribution->weights[k] * exp(-0.5 * z * z) / (distribution->standardDeviations[k] * sqrt(2.0 * M_PI) * pdf);
+
+				if (parameterIndex < 2 * numberOfComponents)
+				{
+					derivatives[i] = (parameterIndex % 2 == 0) ? responsibility : (responsibility * z);
+				}
+				else
+				{
+					derivatives[i] = -(standardNormalCdf(z) -
+								standardNormalCdf((samples[i] - distribution->means[last]) / distribution->standardDeviations[last])) / pdf;
+				}
+			}
+			break;
+	}
+
+	return;
+}
+
+void
+inputDistributionFillWeightScores(
+	const InputDistribution *	distribution,
+	size_t				componentIndex,
+	const double *			samples,
+	double *			scores,
+	size_t				count)
+{
+	size_t	last = distribution->numberOfComponents - 1;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		double	z = (samples[i] - distribution->means[componentIndex]) / distribution->standardDeviations[componentIndex];
+		double	zLast = (samples[i] - distribution->means[last]) / distribution->standardDeviations[last];
+
+		scores[i] = (exp(-0.5 * z * z) / distribution->standardDeviations[componentIndex] -
+				exp(-0.5 * zLast * zLast) / distribution->standardDeviations[last]) /
+				(sqrt(2.0 * M_PI) * gaussianMixturePdf(distribution, samples[i]));
+	}
+
+	return;
+}
+
+/*
+ *	Hash field by field, so that padding bytes do not enter the hash.
+ */
+uint64_t
+inputDistributionGetHash(uint64_t hash, const InputDistribution *  distribution)
+{
+	uint64_t	value;
+
+	value = (uint64_t) distribution->kind;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	hash = hashFnv1aBytes(hash, &distribution->value, sizeof(double));
+	hash = hashFnv1aBytes(hash, &distribution->min, sizeof(double));
+	hash = hashFnv1aBytes(hash, &distribution->max, sizeof(double));
+	value = (uint64_t) distribution->numberOfComponents;
+	hash = hashFnv1aBytes(hash, &value, sizeof(value));
+	hash = hashFnv1aBytes(hash, distribution->weights, distribution->numberOfComponents * sizeof(double));
+	hash = hashFnv1aBytes(hash, distribution->means, distribution->numberOfComponents * sizeof(double));
+	hash = hashFnv1aBytes(hash, distribution->standardDeviations, distribution->numberOfComponents * sizeof(double));
+
+	/*
+	 *	Untruncated distributions keep the hash they had before truncation existed.
+	 */
+	if (distribution->isTruncated)
+	{
+		hash = hashFnv1aBytes(hash, &distribution->truncationLower, sizeof(double));
+		hash = hashFnv1aBytes(hash, &distribution->truncationUpper, sizeof(double));
+	}
+
+	return hash;
+}
+
+CommonConstantReturnType
+choleskyDecompose(const double *  matrix, double *  factor, size_t n)
+{
+	memset(factor, 0, n * n * sizeof(double));
+
+	for (size_t j = 0; j < n; j++)
+	{
+		double	diagonal = matrix[j * n + j];
+
+		for (size_t k = 0; k < j; k++)
+		{
+			diagonal -= factor[j * n + k] * factor[j * n + k];
+		}
+
+		if (!(diagonal > 0.0))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		factor[j * n + j] = sqrt(diagonal);
+
+		for (size_t i = j + 1; i < n; i++)
+		{
+			double	sum = matrix[i * n + j];
+
+			for (size_t k = 0; k < j; k++)
+			{
+				sum -= factor[i * n + k] * factor[j * n + k];
+			}
+			factor[i * n + j] = sum / factor[j * n + j];
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Vose's alias method: split the scaled weights into `n` columns of height one,
+ *	each holding its own component up to `aliasProbabilities[k]` and the component
+ *	`aliasIndices[k]` above it.
+ */
+static void
+inputDistributionInitAliasTable(InputDistribution *  distribution, const double *  weights)
+{
+	size_t	n = distribution->numberOfComponents;
+	double	scaled[kInputDistributionMaximumMixtureComponents];
+	size_t	small[kInputDistributionMaximumMixtureComponents];
+	size_t	large[kInputDistributionMaximumMixtureComponents];
+	size_t	numberOfSmall = 0;
+	size_t	numberOfLarge = 0;
+
+	for (size_t k = 0; k < n; k++)
+	{
+		scaled[k] = weights[k] * n;
+		if (scaled[k] < 1.0)
+		{
+			small[numberOfSmall++] = k;
+		}
+		else
+		{
+			large[numberOfLarge++] = k;
+		}
+	}
+
+	while ((numberOfSmall > 0) && (numberOfLarge > 0))
+	{
+		size_t	smallIndex = small[--numberOfSmall];
+		size_t	largeIndex = large[--numberOfLarge];
+
+		distribution->aliasProbabilities[smallIndex] = scaled[smallIndex];
+		distribution->aliasIndices[smallIndex] = largeIndex;
+		scaled[largeIndex] = (scaled[largeIndex] + scaled[smallIndex]) - 1.0;
+		if (scaled[largeIndex] < 1.0)
+		{
+			small[numberOfSmall++] = largeIndex;
+		}
+		else
+		{
+			large[numberOfLarge++] = largeIndex;
+		}
+	}
+
+	/*
+	 *	What remains is full up to rounding.
+	 */
+	while (numberOfLarge > 0)
+	{
+		size_t	k = large[--numberOfLarge];
+
+		distribution->aliasProbabilities[k] = 1.0;
+		distribution->aliasIndices[k] = k;
+	}
+	while (numberOfSmall > 0)
+	{
+		size_t	k = small[--numberOfSmall];
+
+		distribution->aliasProbabilities[k] = 1.0;
+		distribution->aliasIndices[k] = k;
+	}
+
+	return;
+}
+
+/*
+ *	Map the truncation bounds of each component of a truncated mixture to the
+ *	probabilities `base + u * span` that an inverse-CDF sample with uniform `u`
+ *	takes, and weight the components by the probability each puts within the
+ *	bounds. Components whose range lies above their mean are sampled through
+ *	their upper tail (`sign` of -1), where Φ keeps its relative precision.
+ */
+static void
+inputDistributionInitTruncation(InputDistribution *  distribution, double *  weights)
+{
+	double	totalWeight = 0.0;
+
+	for (size_t k = 0; k < distribution->numberOfComponents; k++)
+	{
+		double	zLower = (distribution->truncationLower - distribution->means[k]) / distribution->standardDeviations[k];
+		double	zUpper = (distribution->truncationUpper - distribution->means[k]) / distribution->standardDeviations[k];
+		double	sign = (zLower > 0.0) ? -1.0 : 1.0;
+
+		distribution->truncationSigns[k] = sign;
+		distribution->truncationBases[k] = standardNormalCdf(sign * zLower);
+		distribution->truncationSpans[k] = standardNormalCdf(sign * zUpper) - distribution->truncationBases[k];
+		weights[k] = distribution->weights[k] * fabs(distribution->truncationSpans[k]);
+		totalWeight += weights[k];
+	}
+
+	for (size_t k = 0; k < distribution->numberOfComponents; k++)
+	{
+		weights[k] /= totalWeight;
+	}
+
+	return;
+}
+
+/*
+ *	Tabulate `x(z) = F⁻¹(Φ(z))` once per run, with the slopes `dx/dz = φ(z) / f(x)`.
+ *	Where the density vanishes at the table ends (far beyond a truncation bound or
+ *	in an underflowing tail), the slope is flat.
+ */
+static void
+samplerQuantileTableInit(SamplerQuantileTable *  table, const InputDistribution *  distribution)
+{
+	double	step = 2.0 * kSamplerQuantileTableNormalBound / kSamplerQuantileTableNumberOfIntervals;
+
+	for (size_t j = 0; j <= kSamplerQuantileTableNumberOfIntervals; j++)
+	{
+		double	z = -kSamplerQuantileTableNormalBound + j * step;
+		double	x = inputDistributionQuantile(distribution, standardNormalCdf(z));
+		double	slope = exp(-0.5 * z * z) / sqrt(2.0 * M_PI) / inputDistributionPdf(distribution, x);
+
+		table->values[j] = x;
+		table->slopes[j] = isfinite(slope) ? slope : 0.0;
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+inputSamplerInit(
+	InputSampler *			sampler,
+	const InputDistribution *	distributions,
+	size_t				numberOfDimensions,
+	const double *			correlationMatrix)
+{
+	double	factor[kInputSamplerMaximumDimensions * kInputSamplerMaximumDimensions];
+
+	if (numberOfDimensions > kInputSamplerMaximumDimensions)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	memset(sampler, 0, sizeof(InputSampler));
+	sampler->numberOfDimensions = numberOfDimensions;
+	memcpy(sampler->distributions, distributions, numberOfDimensions * sizeof(InputDistribution));
+	samplerZigguratInit(&sampler->ziggurat);
+	for (size_t i = 0; i < numberOfDimensions; i++)
+	{
+		InputDistribution *	distribution = &sampler->distributions[i];
+		double			weights[kInputDistributionMaximumMixtureComponents];
+
+		if (distribution->kind != kInputDistributionKindGaussianMixture)
+		{
+			continue;
+		}
+
+		memcpy(weights, distribution->weights, distribution->numberOfComponents * sizeof(double));
+		if (distribution->isTruncated)
+		{
+			inputDistributionInitTruncation(distribution, weights);
+		}
+		inputDistributionInitAliasTable(distribution, weights);
+	}
+
+	if (correlationMatrix == NULL)
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	if (choleskyDecompose(correlationMatrix, factor, numberOfDimensions) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; i < numberOfDimensions; i++)
+	{
+		for (size_t j = 0; j < numberOfDimensions; j++)
+		{
+			sampler->choleskyFactor[i][j] = factor[i * numberOfDimensions + j];
+			if ((i != j) && (correlationMatrix[i * numberOfDimensions + j] != 0.0))
+			{
+				sampler->isCorrelated[i] = true;
+				sampler->isCopulaEnabled = true;
+			}
+		}
+
+		if (sampler->isCorrelated[i] && (sampler->distributions[i].kind == kInputDistributionKindGaussianMixture))
+		{
+			samplerQuantileTableInit(&sampler->quantileTables[i], &sampler->distributions[i]);
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Draw `count` independent samples of a truncated mixture by inverse CDF over the
+ *	truncated range of an alias-selected component, so that every sample costs the
+ *	same and no candidate is rejected. The first loop picks the components and the
+ *	target probabilities, the second applies Φ⁻¹, and the third scales the result
+ *	into the bounds. The uniforms and block->normals[0] are scratch space for the
+ *	means and signed standard deviations of the chosen components.
+ */
+static void
+inputSamplerFillTruncatedMixture(
+	const InputDistribution *	distribution,
+	SamplerRandomNumberGenerator *	generator,
+	InputSampleBlock *		block,
+	double *			values,
+	size_t				count)
+{
+	double *	uniforms = block->uniforms;
+	double *	positions = block->normals[0];
+	size_t		numberOfComponents = distribution->numberOfComponents;
+
+	samplerFillUniforms(generator, uniforms, count);
+	samplerFillUniforms(generator, positions, count);
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		double	scaled = uniforms[i] * numberOfComponents;
+		size_t	column = (size_t) scaled;
+		size_t	k;
+
+		column = (column < numberOfComponents) ? column : (numberOfComponents - 1);
+		k = (scaled - column < distribution->aliasProbabilities[column]) ? column : distribution->aliasIndices[column];
+		values[i] = distribution->truncationBases[k] + positions[i] * distribution->truncationSpans[k];
+		uniforms[i] = distribution->means[k];
+		positions[i] = distribution->truncationSigns[k] * distribution->standardDeviations[k];
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		values[i] = standardNormalQuantile(values[i]);
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		values[i] = fmin(fmax(uniforms[i] + positions[i] * values[i], distribution->truncationLower), distribution->truncationUpper);
+	}
+
+	return;
+}
+
+/*
+ *	Draw `count` independent samples of one input.
+ */
+static void
+inputSamplerFillIndependent(
+	const InputDistribution *	distribution,
+	const SamplerZiggurat *		ziggurat,
+	SamplerRandomNumberGenerator *	generator,
+	InputSampleBlock *		block,
+	double *			values,
+	size_t				count)
+{
+	double *	uniforms = block->uniforms;
+	double *	normals = block->normals[0];
+
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			for (size_t i = 0; i < count; i++)
+			{
+				values[i] = distribution->value;
+			}
+			break;
+
+		case kInputDistributionKindUniform:
+			samplerFillUniforms(generator, uniforms, count);
+			#pragma omp simd
+			for (size_t i = 0; i < count; i++)
+			{
+				values[i] = distribution->min + (distribution->max - distribution->min) * uniforms[i];
+			}
+			break;
+
+		/*
+		 *	The integer part of `u * K` picks a column of the alias table and the
+		 *	fractional part picks between its two components, so the cost per sample
+		 *	does not depend on the number of components.
+		 */
+		case kInputDistributionKindGaussianMixture:
+			if (distribution->isTruncated)
+			{
+				inputSamplerFillTruncatedMixture(distribution, generator, block, values, count);
+				break;
+			}
+
+			samplerFillUniforms(generator, uniforms, count);
+			samplerFillStandardNormalsZiggurat(generator, ziggurat, normals, count);
+			#pragma omp simd
+			for (size_t i = 0; i < count; i++)
+			{
+				double	scaled = uniforms[i] * distribution->numberOfComponents;
+				size_t	column = (size_t) scaled;
+				size_t	k;
+
+				column = (column < distribution->numberOfComponents) ? column : (distribution->numberOfComponents - 1);
+				k = (scaled - column < distribution->aliasProbabilities[column]) ? column : distribution->aliasIndices[column];
+				values[i] = distribution->means[k] + distribution->standardDeviations[k] * normals[i];
+			}
+			break;
+	}
+
+	return;
+}
+
+/*
+ *	Map correlated normals through a quantile table by cubic Hermite interpolation,
+ *	followed by one Newton step on `F(x) = Φ(z)`. Within the truncation bounds, the
+ *	CDF of a truncated mixture is Σ w_k s_k (Φ(s_k z_k) - Φ(s_k zLower_k)) / mass with
+ *	the signs of inputDistributionInitTruncation, which the Newton step evaluates for
+ *	all components at once. The rare normals beyond the table take the scalar
+ *	quantile function.
+ */
+static void
+samplerQuantileTableFill(
+	const SamplerQuantileTable *	table,
+	const InputDistribution *	distribution,
+	const double *			normals,
+	double *			values,
+	size_t				count)
+{
+	double	step = 2.0 * kSamplerQuantileTableNormalBound / kSamplerQuantileTableNumberOfIntervals;
+	double	signs[kInputDistributionMaximumMixtureComponents];
+	double	bases[kInputDistributionMaximumMixtureComponents];
+	double	densityScales[kInputDistributionMaximumMixtureComponents];
+	double	inverseMass = distribution->isTruncated ? (1.0 / gaussianMixtureTruncatedMass(distribution)) : 1.0;
+	double	lower = distribution->isTruncated ? distribution->truncationLower : -INFINITY;
+	double	upper = distribution->isTruncated ? distribution->truncationUpper : INFINITY;
+	size_t	numberOfComponents = distribution->numberOfComponents;
+
+	for (size_t k = 0; k < numberOfComponents; k++)
+	{
+		signs[k] = distribution->isTruncated ? distribution->truncationSigns[k] : 1.0;
+		bases[k] = distribution->isTruncated ? distribution->truncationBases[k] : 0.0;
+		densityScales[k] = distribution->weights[k] / (distribution->standardDeviations[k] * sqrt(2.0 * M_PI));
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		double	t = fmin(fmax((normals[i] + kSamplerQuantileTableNormalBound) / step, 0.0), kSamplerQuantileTableNumberOfIntervals);
+		size_t	j = (size_t)fmin(t, kSamplerQuantileTableNumberOfIntervals - 1);
+		double	s = t - (double)j;
+		double	s2 = s * s;
+		double	s3 = s2 * s;
+		double	x = (2.0 * s3 - 3.0 * s2 + 1.0) * table->values[j]
+			+ (s3 - 2.0 * s2 + s) * step * table->slopes[j]
+			+ (3.0 * s2 - 2.0 * s3) * table->values[j + 1]
+			+ (s3 - s2) * step * table->slopes[j + 1];
+		double	cdf = 0.0;
+		double	pdf = 0.0;
+
+		for (size_t k = 0; k < numberOfComponents; k++)
+		{
+			double	z = (x - distribution->means[k]) / distribution->standardDeviations[k];
+
+			cdf += distribution->weights[k] * signs[k] * (0.5 * erfc(-signs[k] * z * M_SQRT1_2) - bases[k]);
+			pdf += densityScales[k] * exp(-0.5 * z * z);
+		}
+
+		if (pdf > 0.0)
+		{
+			x -= (cdf - standardNormalCdf(normals[i]) / inverseMass) / pdf;
+		}
+
+		values[i] = fmin(fmax(x, lower), upper);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (fabs(normals[i]) >= kSamplerQuantileTableNormalBound)
+		{
+			values[i] = inputDistributionQuantile(distribution, standardNormalCdf(normals[i]));
+		}
+	}
+
+	return;
+}
+
+void
+inputSamplerFillBlock(
+	const InputSampler *		sampler,
+	SamplerRandomNumberGenerator *	generator,
+	InputSampleBlock *		block,
+	size_t				count)
+{
+	/*
+	 *	Inputs that take part in no correlation are drawn independently. The
+	 *	normals of block->normals[0] are scratch space for that.
+	 */
+	for (size_t d = 0; d < sampler->numberOfDimensions; d++)
+	{
+		if (!sampler->isCorrelated[d])
+		{
+			inputSamplerFillIndependent(&sampler->distributions[d], &sampler->ziggurat, generator, block, block->values[d], count);
+		}
+	}
+
+	if (!sampler->isCopulaEnabled)
+	{
+		return;
+	}
+
+	/*
+	 *	Gaussian copula: draw independent normals, correlate them with the
+	 *	precomputed Cholesky factor, map them to uniforms with Φ, and apply the
+	 *	inverse CDF of each marginal.
+	 */
+	for (size_t d = 0; d < sampler->numberOfDimensions; d++)
+	{
+		if (sampler->isCorrelated[d])
+		{
+			samplerFillStandardNormals(generator, block->normals[d], count);
+		}
+	}
+
+	for (size_t d = sampler->numberOfDimensions; d-- > 0;)
+	{
+		double *	correlated = block->normals[d];
+
+		if (!sampler->isCorrelated[d])
+		{
+			continue;
+		}
+
+		/*
+		 *	Going from the last row up, row `d` only reads rows `k <= d`, which
+		 *	still hold independent normals, so the product is done in place.
+		 */
+		#pragma omp simd
+		for (size_t i = 0; i < count; i++)
+		{
+			correlated[i] *= sampler->choleskyFactor[d][d];
+		}
+
+		for (size_t k = 0; k < d; k++)
+		{
+			const double *	independent = block->normals[k];
+			double		coefficient = sampler->choleskyFactor[d][k];
+
+			if (!sampler->isCorrelated[k] || (coefficient == 0.0))
+			{
+				continue;
+			}
+
+			#pragma omp simd
+			for (size_t i = 0; i < count; i++)
+			{
+				correlated[i] += coefficient * independent[i];
+			}
+		}
+	}
+
+	for (size_t d = 0; d < sampler->numberOfDimensions; d++)
+	{
+		const InputDistribution *	distribution = &sampler->distributions[d];
+		double *			values = block->values[d];
+		const double *			correlated = block->normals[d];
+
+		if (!sampler->isCorrelated[d])
+		{
+			continue;
+		}
+
+		switch (distribution->kind)
+		{
+			case kInputDistributionKindConstant:
+				for (size_t i = 0; i < count; i++)
+				{
+					values[i] = distribution->value;
+				}
+				break;
+
+			case kInputDistributionKindUniform:
+				for (size_t i = 0; i < count; i++)
+				{
+					values[i] = distribution->min + (distribution->max - distribution->min) * standardNormalCdf(correlated[i]);
+				}
+				break;
+
+			case kInputDistributionKindGaussianMixture:
+				samplerQuantileTableFill(&sampler->quantileTables[d], distribution, correlated, values, count);
+				break;
+		}
+	}
+
+	return;
+}
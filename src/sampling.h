@@ -0,0 +1,389 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+
+#define	kInputSamplerMaximumDimensions			(8)
+#define	kInputSampleBlockSize				(1024)
+#define	kInputDistributionMaximumMixtureComponents	(8)
+#define	kSamplerZigguratNumberOfLayers			(128)
+#define	kSamplerDefaultSeed				(UINT64_C(0x5EED0BA5E5EED0B5))
+#define	kSamplerQuantileTableNumberOfIntervals		(2048)
+#define	kSamplerQuantileTableNormalBound		(8.0)
+
+/*
+ *	Version of the samples that a sampler draws for a given seed and configuration.
+ *	Bump it with any change that alters them, so that the result cache does not serve
+ *	results of the old sampler.
+ */
+#define	kInputSamplerVersion				(1)
+
+typedef enum
+{
+	kInputDistributionKindConstant	= 0,
+	kInputDistributionKindUniform,
+	kInputDistributionKindGaussianMixture,
+} InputDistributionKind;
+
+/*
+ *	Parametric description of one input distribution, for the native sampler.
+ *	A Gaussian mixture can be truncated to `[truncationLower, truncationUpper]`.
+ *	`inputSamplerInit()` fills the alias table of a Gaussian mixture, which picks
+ *	the component of a sample with one uniform in constant time, and, for a
+ *	truncated mixture, the probabilities that each component puts below and
+ *	within the bounds, which map a uniform onto its truncated range.
+ */
+typedef struct InputDistribution
+{
+	InputDistributionKind	kind;
+	double			value;
+	double			min;
+	double			max;
+	size_t			numberOfComponents;
+	double			weights[kInputDistributionMaximumMixtureComponents];
+	double			means[kInputDistributionMaximumMixtureComponents];
+	double			standardDeviations[kInputDistributionMaximumMixtureComponents];
+	bool			isTruncated;
+	double			truncationLower;
+	double			truncationUpper;
+	double			truncationBases[kInputDistributionMaximumMixtureComponents];
+	double			truncationSpans[kInputDistributionMaximumMixtureComponents];
+	double			truncationSigns[kInputDistributionMaximumMixtureComponents];
+	double			aliasProbabilities[kInputDistributionMaximumMixtureComponents];
+	size_t			aliasIndices[kInputDistributionMaximumMixtureComponents];
+} InputDistribution;
+
+/*
+ *	xoshiro256** pseudo-random number generator. Each block of samples is drawn
+ *	from its own stream, seeded from the run seed and the block index, so results
+ *	do not depend on how blocks are distributed across threads.
+ */
+typedef struct SamplerRandomNumberGenerator
+{
+	uint64_t	state[4];
+} SamplerRandomNumberGenerator;
+
+/*
+ *	Tables of the ziggurat method for standard normals (Marsaglia and Tsang, with
+ *	Doornik's correction): the right edges `x` of the layers of equal area and the
+ *	ratios of consecutive edges, below which a candidate is accepted outright.
+ */
+typedef struct SamplerZiggurat
+{
+	double	edges[kSamplerZigguratNumberOfLayers + 1];
+	double	ratios[kSamplerZigguratNumberOfLayers];
+} SamplerZiggurat;
+
+/*
+ *	Table of `x(z) = F⁻¹(Φ(z))` for one input, at evenly spaced `z` in
+ *	[-kSamplerQuantileTableNormalBound, kSamplerQuantileTableNormalBound], with the
+ *	exact derivatives `φ(z) / f(x)`, for cubic Hermite interpolation. The Gaussian
+ *	copula maps correlated normals through it instead of solving for F⁻¹ per sample.
+ */
+typedef struct SamplerQuantileTable
+{
+	double	values[kSamplerQuantileTableNumberOfIntervals + 1];
+	double	slopes[kSamplerQuantileTableNumberOfIntervals + 1];
+} SamplerQuantileTable;
+
+/*
+ *	Sampler state that is fixed for a run: the marginals, the ziggurat tables, and,
+ *	for correlated sampling, the Cholesky factor of the Gaussian-copula correlation matrix
+ *	and the quantile tables of the correlated Gaussian mixtures.
+ */
+typedef struct InputSampler
+{
+	SamplerZiggurat		ziggurat;
+	size_t			numberOfDimensions;
+	InputDistribution	distributions[kInputSamplerMaximumDimensions];
+	bool			isCorrelated[kInputSamplerMaximumDimensions];
+	bool			isCopulaEnabled;
+	double			choleskyFactor[kInputSamplerMaximumDimensions][kInputSamplerMaximumDimensions];
+	SamplerQuantileTable	quantileTables[kInputSamplerMaximumDimensions];
+} InputSampler;
+
+/*
+ *	A block of input samples, one array per dimension (structure-of-arrays).
+ */
+typedef struct InputSampleBlock
+{
+	double	values[kInputSamplerMaximumDimensions][kInputSampleBlockSize];
+	double	normals[kInputSamplerMaximumDimensions][kInputSampleBlockSize];
+	double	uniforms[kInputSampleBlockSize];
+} InputSampleBlock;
+
+/**
+ *	@brief	Seed a random number generator for one stream of a run.
+ *
+ *	@param	generator	: Pointer to the generator.
+ *	@param	seed		: Seed of the run.
+ *	@param	streamIndex	: Index of the stream (e.g., the block index).
+ */
+void	samplerRandomNumberGeneratorInit(
+		SamplerRandomNumberGenerator *	generator,
+		uint64_t			seed,
+		uint64_t			streamIndex);
+
+/**
+ *	@brief	Get the next 64 random bits from a generator.
+ *
+ *	@param	generator	: Pointer to the generator.
+ *	@return			: 64 random bits.
+ */
+static inline uint64_t
+samplerRandomNumberGeneratorNext(SamplerRandomNumberGenerator *  generator)
+{
+	uint64_t *	s = generator->state;
+	uint64_t	product = s[1] * 5;
+	uint64_t	result = ((product << 7) | (product >> 57)) * 9;
+	uint64_t	t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = (s[3] << 45) | (s[3] >> 19);
+
+	return result;
+}
+
+/**
+ *	@brief	Fill an array with uniform samples in (0, 1).
+ *
+ *	@param	generator	: Pointer to the generator.
+ *	@param	uniforms	: Array to fill.
+ *	@param	count		: Number of samples.
+ */
+void	samplerFillUniforms(
+		SamplerRandomNumberGenerator *	generator,
+		double *			uniforms,
+		size_t				count);
+
+/**
+ *	@brief	Fill an array with standard normal samples.
+ *
+ *	@param	generator	: Pointer to the generator.
+ *	@param	normals		: Array to fill.
+ *	@param	count		: Number of samples.
+ */
+void	samplerFillStandardNormals(
+		SamplerRandomNumberGenerator *	generator,
+		double *			normals,
+		size_t				count);
+
+/**
+ *	@brief	Compute the tables of the ziggurat method.
+ *
+ *	@param	ziggurat	: Pointer to the tables.
+ */
+void	samplerZigguratInit(SamplerZiggurat *  ziggurat);
+
+/**
+ *	@brief	Fill an array with standard normal samples by the ziggurat method. The candidates
+ *		of a batch are drawn and scaled in one vectorized loop. The few that fall outside
+ *		the rectangle of their layer (about 1%) are then resolved one at a time.
+ *
+ *	@param	generator	: Pointer to the generator.
+ *	@param	ziggurat	: Pointer to the tables.
+ *	@param	normals		: Array to fill.
+ *	@param	count		: Number of samples.
+ */
+void	samplerFillStandardNormalsZiggurat(
+		SamplerRandomNumberGenerator *	generator,
+		const SamplerZiggurat *		ziggurat,
+		double *			normals,
+		size_t				count);
+
+/**
+ *	@brief	Standard normal cumulative distribution function.
+ *
+ *	@param	x	: Argument.
+ *	@return		: Φ(x).
+ */
+double	standardNormalCdf(double x);
+
+/**
+ *	@brief	Standard normal quantile function (Wichura's AS241 algorithm).
+ *
+ *	@param	p	: Probability in (0, 1).
+ *	@return		: Φ⁻¹(p).
+ */
+double	standardNormalQuantile(double p);
+
+/**
+ *	@brief	Cumulative distribution function of an input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	x		: Argument.
+ *	@return			: F(x).
+ */
+double	inputDistributionCdf(const InputDistribution *  distribution, double x);
+
+/**
+ *	@brief	Probability density function of an input distribution. A constant has no
+ *		density, so the result for a constant is NAN.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	x		: Argument.
+ *	@return			: f(x).
+ */
+double	inputDistributionPdf(const InputDistribution *  distribution, double x);
+
+/**
+ *	@brief	Quantile function of an input distribution.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	p		: Probability in (0, 1).
+ *	@return			: F⁻¹(p).
+ */
+double	inputDistributionQuantile(const InputDistribution *  distribution, double p);
+
+/**
+ *	@brief	Probability that a Gaussian mixture, ignoring its truncation, puts between
+ *		`truncationLower` and `truncationUpper`, computed from the upper tail of the
+ *		components whose means lie below the range so that it does not cancel to zero.
+ *		Any other distribution has a mass of one.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@return			: The truncated mass.
+ */
+double	inputDistributionGetTruncatedMass(const InputDistribution *  distribution);
+
+/**
+ *	@brief	Get the number of parameters of an input distribution: the value of a constant,
+ *		the bounds of a uniform, and the means, standard deviations, and all but the last
+ *		weight of the components of a Gaussian mixture.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@return			: The number of parameters.
+ */
+size_t	inputDistributionGetNumberOfParameters(const InputDistribution *  distribution);
+
+/**
+ *	@brief	Get the name of a parameter of an input distribution (e.g., "Min" or "Mean2").
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	parameterIndex	: Index of the parameter.
+ *	@param	name		: Buffer to store the name.
+ *	@param	size		: Size of `name`.
+ */
+void	inputDistributionGetParameterName(
+		const InputDistribution *	distribution,
+		size_t				parameterIndex,
+		char *				name,
+		size_t				size);
+
+/**
+ *	@brief	Get the derivatives of samples of an input distribution with respect to one of
+ *		its parameters, with the uniform variate of each sample held fixed. The last
+ *		weight of a Gaussian mixture is one minus the others, so it changes with them.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	parameterIndex	: Index of the parameter.
+ *	@param	samples		: Array of samples of the distribution.
+ *	@param	derivatives	: Array to store the derivatives.
+ *	@param	count		: Number of samples.
+ */
+void	inputDistributionFillSampleDerivatives(
+		const InputDistribution *	distribution,
+		size_t				parameterIndex,
+		const double *			samples,
+		double *			derivatives,
+		size_t				count);
+
+/**
+ *	@brief	Get the score `∂log f(x)/∂w_k` of samples of a Gaussian mixture with respect to
+ *		the weight of component `k`, with the last weight one minus the others. Unlike
+ *		the sample derivative, the score is bounded, by `1 / w_k + 1 / w_last`.
+ *
+ *	@param	distribution	: Pointer to the distribution.
+ *	@param	componentIndex	: Index of the component, less than the number of components minus one.
+ *	@param	samples		: Array of samples of the distribution.
+ *	@param	scores		: Array to store the scores.
+ *	@param	count		: Number of samples.
+ */
+void	inputDistributionFillWeightScores(
+		const InputDistribution *	distribution,
+		size_t				componentIndex,
+		const double *			samples,
+		double *			scores,
+		size_t				count);
+
+/**
+ *	@brief	Extend a 64-bit FNV-1a hash with the parameters of an input distribution.
+ *
+ *	@param	hash		: Hash so far.
+ *	@param	distribution	: Pointer to the distribution.
+ *	@return			: The extended hash.
+ */
+uint64_t	inputDistributionGetHash(uint64_t hash, const InputDistribution *  distribution);
+
+/**
+ *	@brief	Cholesky decomposition of a symmetric positive-definite matrix.
+ *
+ *	@param	matrix		: Row-major `n`×`n` matrix.
+ *	@param	factor		: Row-major `n`×`n` array to store the lower-triangular factor.
+ *	@param	n		: Dimension of the matrix.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if the matrix is positive definite, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	choleskyDecompose(const double *  matrix, double *  factor, size_t n);
+
+/**
+ *	@brief	Initialize an input sampler.
+ *
+ *	@param	sampler			: Pointer to the sampler.
+ *	@param	distributions		: Array of `numberOfDimensions` marginal distributions.
+ *	@param	numberOfDimensions	: Number of inputs.
+ *	@param	correlationMatrix	: Row-major `numberOfDimensions`×`numberOfDimensions` Gaussian-copula
+ *					  correlation matrix, or NULL for independent sampling.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`
+ *					  if there are more than `kInputSamplerMaximumDimensions` inputs or the
+ *					  correlation matrix is not positive definite. It prints nothing; the caller
+ *					  reports the error.
+ */
+CommonConstantReturnType	inputSamplerInit(
+					InputSampler *			sampler,
+					const InputDistribution *	distributions,
+					size_t				numberOfDimensions,
+					const double *			correlationMatrix);
+
+/**
+ *	@brief	Draw a block of input samples.
+ *
+ *	@param	sampler		: Pointer to the sampler.
+ *	@param	generator	: Pointer to the generator of the block's stream.
+ *	@param	block		: Pointer to the block to fill.
+ *	@param	count		: Number of samples (at most `kInputSampleBlockSize`).
+ */
+void	inputSamplerFillBlock(
+		const InputSampler *		sampler,
+		SamplerRandomNumberGenerator *	generator,
+		InputSampleBlock *		block,
+		size_t				count);
@@ -0,0 +1,230 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "temperatureSweep.h"
+#include "histogram.h"
+#include "sampling.h"
+#include "common.h"
+
+
+/*
+ *	Per-sample terms of the kernel that do not depend on the temperature.
+ */
+typedef struct TemperatureSweepBlock
+{
+	InputSampleBlock	inputs;
+	double			prefactor[kInputSampleBlockSize];
+	double			sqrtNumerator[kInputSampleBlockSize];
+	double			shearModulusSlope[kInputSampleBlockSize];
+	double			sigmaCMpa[kInputSampleBlockSize];
+} TemperatureSweepBlock;
+
+static void
+prepareTemperatureSweepBlock(TemperatureSweepBlock *  block, size_t count)
+{
+	double (*	values)[kInputSampleBlockSize] = block->inputs.values;
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		double	gamma = values[kInputDistributionIndexGamma][i];
+		double	phi = values[kInputDistributionIndexPhi][i];
+		double	Rs = values[kInputDistributionIndexRs][i];
+		double	b = values[kInputDistributionIndexB][i];
+		double	M = values[kInputDistributionIndexM][i];
+
+		block->prefactor[i] = (M * gamma) / (2.0 * b);
+		block->sqrtNumerator[i] = (8.0 * gamma * phi * Rs) / (M_PI * (b * b));
+	}
+
+	return;
+}
+
+static void
+evaluateTemperatureSweepBlock(TemperatureSweepBlock *  block, double temperatureOffset, size_t count)
+{
+	const double *	phi = block->inputs.values[kInputDistributionIndexPhi];
+	const double *	G0 = block->inputs.values[kInputDistributionIndexG];
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		double	G = G0[i] + block->shearModulusSlope[i] * temperatureOffset;
+
+		block->sigmaCMpa[i] = block->prefactor[i] * (sqrt(block->sqrtNumerator[i] / G) - phi[i]) / 1000000;
+	}
+
+	return;
+}
+
+static double
+getSweepTemperature(const CommandLineArguments *  arguments, size_t index)
+{
+	if (arguments->temperatureSweepNumberOfTemperatures == 1)
+	{
+		return arguments->temperatureSweepMin;
+	}
+
+	return arguments->temperatureSweepMin +
+		(arguments->temperatureSweepMax - arguments->temperatureSweepMin) * index / (arguments->temperatureSweepNumberOfTemperatures - 1);
+}
+
+CommonConstantReturnType
+runTemperatureSweep(const CommandLineArguments *  arguments)
+{
+	InputSampler		sampler;
+	size_t			numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	size_t			numberOfBlocks = (numberOfSamples + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+	size_t			numberOfTemperatures = arguments->temperatureSweepNumberOfTemperatures;
+	size_t			numberOfThreads = 1;
+	StreamingHistogram *	histograms;
+	FILE *			stream = stdout;
+	clock_t			start = clock();
+	double			cpuTimeUsedInSeconds;
+
+	if (inputSamplerInit(
+			&sampler,
+			arguments->samplingDistributions,
+			kInputDistributionIndexMax,
+			arguments->isCorrelatedSamplingEnabled ? &arguments->correlationMatrix[0][0] : NULL) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: The correlation matrix is not positive definite.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#ifdef _OPENMP
+	numberOfThreads = (size_t) omp_get_max_threads();
+#endif
+
+	/*
+	 *	One histogram per temperature and thread. Thread `t` owns the row starting
+	 *	at `histograms[t * numberOfTemperatures]`.
+	 */
+	histograms = (StreamingHistogram *) checkedMalloc(
+							numberOfThreads * numberOfTemperatures * sizeof(StreamingHistogram),
+							__FILE__,
+							__LINE__);
+	for (size_t i = 0; i < numberOfThreads * numberOfTemperatures; i++)
+	{
+		streamingHistogramInit(&histograms[i]);
+	}
+
+	#pragma omp parallel
+	{
+		size_t				threadIndex = 0;
+		StreamingHistogram *		threadHistograms;
+		TemperatureSweepBlock *		block = (TemperatureSweepBlock *) checkedMalloc(sizeof(TemperatureSweepBlock), __FILE__, __LINE__);
+		SamplerRandomNumberGenerator	generator;
+
+#ifdef _OPENMP
+		threadIndex = (size_t) omp_get_thread_num();
+#endif
+		threadHistograms = &histograms[threadIndex * numberOfTemperatures];
+
+		#pragma omp for schedule(static)
+		for (size_t blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+		{
+			size_t	first = blockIndex * kInputSampleBlockSize;
+			size_t	count = (numberOfSamples - first < kInputSampleBlockSize) ? (numberOfSamples - first) : kInputSampleBlockSize;
+
+			/*
+			 *	Sample the inputs, including the shear modulus `G0` at the reference
+			 *	temperature, and the slope of `G(T)` once per sample.
+			 */
+			samplerRandomNumberGeneratorInit(&generator, arguments->seed, blockIndex);
+			inputSamplerFillBlock(&sampler, &generator, &block->inputs, count);
+			samplerFillUniforms(&generator, block->shearModulusSlope, count);
+			for (size_t i = 0; i < count; i++)
+			{
+				block->shearModulusSlope[i] = arguments->shearModulusSlopeMin +
+								(arguments->shearModulusSlopeMax - arguments->shearModulusSlopeMin) * block->shearModulusSlope[i];
+			}
+			prepareTemperatureSweepBlock(block, count);
+
+			/*
+			 *	Evaluate the block at every temperature while it is in cache.
+			 */
+			for (size_t j = 0; j < numberOfTemperatures; j++)
+			{
+				evaluateTemperatureSweepBlock(block, getSweepTemperature(arguments, j) - kDemoSpecificConstantReferenceTemperature, count);
+				streamingHistogramAddArray(&threadHistograms[j], block->sigmaCMpa, count);
+			}
+		}
+
+		free(block);
+	}
+
+	for (size_t t = 1; t < numberOfThreads; t++)
+	{
+		for (size_t j = 0; j < numberOfTemperatures; j++)
+		{
+			streamingHistogramMerge(&histograms[j], &histograms[t * numberOfTemperatures + j]);
+		}
+	}
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	if (arguments->common.isWriteToFileEnabled)
+	{
+		stream = fopen(arguments->common.outputFilePath, "w");
+		if (stream == NULL)
+		{
+			fprintf(stderr, "Error: Could not write to output CSV file \"%s\".\n", arguments->common.outputFilePath);
+			free(histograms);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	streamingHistogramPrintSummaryHeader(stream, "temperature", arguments->common.isWriteToFileEnabled);
+	for (size_t j = 0; j < numberOfTemperatures; j++)
+	{
+		char	temperature[32];
+
+		snprintf(temperature, sizeof(temperature), "%lf", getSweepTemperature(arguments, j));
+		streamingHistogramPrintSummaryRow(stream, temperature, &histograms[j], arguments->common.isWriteToFileEnabled);
+	}
+
+	if (stream != stdout)
+	{
+		fclose(stream);
+	}
+
+	if (arguments->common.isTimingEnabled)
+	{
+		printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+	}
+
+	free(histograms);
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,534 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <float.h>
+#include <stddef.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "sampleAnalysis.h"
+#include "sampleFile.h"
+#include "common.h"
+
+
+static const double		kSampleAnalysisProbabilities[] = {0.01, 0.05, 0.25, 0.50, 0.75, 0.95, 0.99};
+static const char * const	kSampleAnalysisQuantileNames[] = {"p01", "p05", "p25", "p50", "p75", "p95", "p99"};
+
+#define	kSampleAnalysisNumberOfQuantiles	(sizeof(kSampleAnalysisProbabilities) / sizeof(kSampleAnalysisProbabilities[0]))
+#define	kSampleAnalysisInsertionSortSize	(32)
+#define	kSampleAnalysisParallelSelectSize	(1 << 16)
+
+static size_t
+getMaximumNumberOfThreads(void)
+{
+#ifdef _OPENMP
+	return (size_t) omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+static void
+printSampleAnalysisUsage(void)
+{
+	fprintf(stderr, "Usage: sample-tool analyze [options] <file>\n");
+	fprintf(stderr,
+		"\t[-j, --json] (Print output in JSON format.)\n"
+		"\t[-h, --help] (Display this help message.)\n");
+
+	return;
+}
+
+/*
+ *	Combine the moments of two disjoint sets of samples into `destination`.
+ */
+static void
+sampleMomentsCombine(SampleMoments *  destination, const SampleMoments *  source)
+{
+	double	countA = (double) destination->count;
+	double	countB = (double) source->count;
+	double	count = countA + countB;
+	double	delta;
+	double	delta2;
+
+	destination->nonFiniteCount += source->nonFiniteCount;
+	if (source->count == 0)
+	{
+		return;
+	}
+	if (destination->count == 0)
+	{
+		uint64_t	nonFiniteCount = destination->nonFiniteCount;
+
+		*destination = *source;
+		destination->nonFiniteCount = nonFiniteCount;
+
+		return;
+	}
+
+	delta = source->mean - destination->mean;
+	delta2 = delta * delta;
+
+	/*
+	 *	The higher sums use the lower sums of both sides, so update M4, M3, then M2.
+	 */
+	destination->m4 += source->m4
+			+ delta2 * delta2 * countA * countB * (countA * countA - countA * countB + countB * countB) / (count * count * count)
+			+ 6.0 * delta2 * (countA * countA * source->m2 + countB * countB * destination->m2) / (count * count)
+			+ 4.0 * delta * (countA * source->m3 - countB * destination->m3) / count;
+	destination->m3 += source->m3
+			+ delta2 * delta * countA * countB * (countA - countB) / (count * count)
+			+ 3.0 * delta * (countA * source->m2 - countB * destination->m2) / count;
+	destination->m2 += source->m2 + delta2 * countA * countB / count;
+	destination->mean += delta * countB / count;
+	destination->count += source->count;
+	destination->min = (source->min < destination->min) ? source->min : destination->min;
+	destination->max = (source->max > destination->max) ? source->max : destination->max;
+
+	return;
+}
+
+/*
+ *	Two SIMD passes over one cache-resident block: the sum and extremes, then the
+ *	central moment sums. Non-finite samples are masked out rather than branched on.
+ */
+static void
+accumulateBlock(const double *  samples, size_t count, SampleMoments *  block)
+{
+	double	sum = 0.0;
+	double	numberOfFinite = 0.0;
+	double	minimum = INFINITY;
+	double	maximum = -INFINITY;
+	double	mean;
+	double	m2 = 0.0;
+	double	m3 = 0.0;
+	double	m4 = 0.0;
+
+	#pragma omp simd reduction(+:sum, numberOfFinite) reduction(min:minimum) reduction(max:maximum)
+	for (size_t i = 0; i < count; i++)
+	{
+		bool	isFinite = (fabs(samples[i]) <= DBL_MAX);
+		double	value = isFinite ? samples[i] : 0.0;
+
+		sum += value;
+		numberOfFinite += isFinite ? 1.0 : 0.0;
+		minimum = (isFinite && (value < minimum)) ? value : minimum;
+		maximum = (isFinite && (value > maximum)) ? value : maximum;
+	}
+
+	mean = (numberOfFinite > 0.0) ? (sum / numberOfFinite) : 0.0;
+
+	#pragma omp simd reduction(+:m2, m3, m4)
+	for (size_t i = 0; i < count; i++)
+	{
+		double	delta = (fabs(samples[i]) <= DBL_MAX) ? (samples[i] - mean) : 0.0;
+		double	delta2 = delta * delta;
+
+		m2 += delta2;
+		m3 += delta2 * delta;
+		m4 += delta2 * delta2;
+	}
+
+	*block = (SampleMoments) {
+		.count		= (uint64_t) numberOfFinite,
+		.nonFiniteCount	= count - (uint64_t) numberOfFinite,
+		.mean		= mean,
+		.m2		= m2,
+		.m3		= m3,
+		.m4		= m4,
+		.min		= minimum,
+		.max		= maximum,
+	};
+
+	return;
+}
+
+void
+sampleMomentsCompute(const double *  samples, size_t count, SampleMoments *  moments)
+{
+	size_t		numberOfThreads = getMaximumNumberOfThreads();
+	size_t		numberOfBlocks = (count + kSampleAnalysisBlockSize - 1) / kSampleAnalysisBlockSize;
+	size_t		blocksPerThread = (numberOfBlocks + numberOfThreads - 1) / numberOfThreads;
+	SampleMoments *	threadMoments = (SampleMoments *) checkedMalloc(numberOfThreads * sizeof(SampleMoments), __FILE__, __LINE__);
+
+	#pragma omp parallel for schedule(static)
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		threadMoments[t] = (SampleMoments) {.min = INFINITY, .max = -INFINITY};
+		for (size_t b = t * blocksPerThread; (b < (t + 1) * blocksPerThread) && (b < numberOfBlocks); b++)
+		{
+			size_t		first = b * kSampleAnalysisBlockSize;
+			SampleMoments	block;
+
+			accumulateBlock(&samples[first], (count - first < kSampleAnalysisBlockSize) ? (count - first) : kSampleAnalysisBlockSize, &block);
+			sampleMomentsCombine(&threadMoments[t], &block);
+		}
+	}
+
+	*moments = (SampleMoments) {.min = INFINITY, .max = -INFINITY};
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		sampleMomentsCombine(moments, &threadMoments[t]);
+	}
+	free(threadMoments);
+
+	return;
+}
+
+void
+sampleMomentsGetShape(const SampleMoments *  moments, double *  variance, double *  skewness, double *  kurtosis)
+{
+	double	count = (double) moments->count;
+
+	*variance = (moments->count > 1) ? (moments->m2 / (count - 1.0)) : 0.0;
+	*skewness = (moments->m2 > 0.0) ? (sqrt(count) * moments->m3 / pow(moments->m2, 1.5)) : NAN;
+	*kurtosis = (moments->m2 > 0.0) ? (count * moments->m4 / (moments->m2 * moments->m2) - 3.0) : NAN;
+
+	return;
+}
+
+size_t
+sampleAnalysisCopyFinite(const double *  samples, size_t count, double *  finiteSamples)
+{
+	size_t		numberOfThreads = getMaximumNumberOfThreads();
+	size_t		sliceSize = (count + numberOfThreads - 1) / numberOfThreads;
+	size_t *	offsets = (size_t *) checkedMalloc((numberOfThreads + 1) * sizeof(size_t), __FILE__, __LINE__);
+	size_t		numberOfFinite;
+
+	memset(offsets, 0, (numberOfThreads + 1) * sizeof(size_t));
+
+	#pragma omp parallel for schedule(static)
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		for (size_t i = t * sliceSize; (i < (t + 1) * sliceSize) && (i < count); i++)
+		{
+			offsets[t + 1] += (fabs(samples[i]) <= DBL_MAX);
+		}
+	}
+
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		offsets[t + 1] += offsets[t];
+	}
+
+	#pragma omp parallel for schedule(static)
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		size_t	next = offsets[t];
+
+		for (size_t i = t * sliceSize; (i < (t + 1) * sliceSize) && (i < count); i++)
+		{
+			if (fabs(samples[i]) <= DBL_MAX)
+			{
+				finiteSamples[next++] = samples[i];
+			}
+		}
+	}
+
+	numberOfFinite = offsets[numberOfThreads];
+	free(offsets);
+
+	return numberOfFinite;
+}
+
+/*
+ *	Partially sort `samples[first..last]` so that the samples at each of `ranks`
+ *	(in increasing order) are in their sorted positions. Hoare partitioning around
+ *	a median-of-three pivot puts every sample of the left part at or below every
+ *	sample of the right part, and each part only continues with the ranks it holds.
+ */
+static void
+selectRanks(double *  samples, ptrdiff_t first, ptrdiff_t last, const size_t *  ranks, size_t numberOfRanks)
+{
+	while ((numberOfRanks > 0) && (last - first >= kSampleAnalysisInsertionSortSize))
+	{
+		double		a = samples[first];
+		double		b = samples[first + (last - first) / 2];
+		double		c = samples[last];
+		double		pivot = (a < b) ? ((b < c) ? b : ((a < c) ? c : a)) : ((a < c) ? a : ((b < c) ? c : b));
+		ptrdiff_t	i = first - 1;
+		ptrdiff_t	j = last + 1;
+		size_t		numberOfLeftRanks = 0;
+
+		for (;;)
+		{
+			double	swap;
+
+			do
+			{
+				i++;
+			} while (samples[i] < pivot);
+			do
+			{
+				j--;
+			} while (samples[j] > pivot);
+			if (i >= j)
+			{
+				break;
+			}
+			swap = samples[i];
+			samples[i] = samples[j];
+			samples[j] = swap;
+		}
+
+		while ((numberOfLeftRanks < numberOfRanks) && ((ptrdiff_t) ranks[numberOfLeftRanks] <= j))
+		{
+			numberOfLeftRanks++;
+		}
+
+		if (numberOfLeftRanks > 0)
+		{
+			#pragma omp task if (j - first > kSampleAnalysisParallelSelectSize)
+			selectRanks(samples, first, j, ranks, numberOfLeftRanks);
+		}
+		first = j + 1;
+		ranks += numberOfLeftRanks;
+		numberOfRanks -= numberOfLeftRanks;
+	}
+
+	if (numberOfRanks > 0)
+	{
+		for (ptrdiff_t i = first + 1; i <= last; i++)
+		{
+			double		value = samples[i];
+			ptrdiff_t	k = i;
+
+			for (; (k > first) && (samples[k - 1] > value); k--)
+			{
+				samples[k] = samples[k - 1];
+			}
+			samples[k] = value;
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Interpolate quantiles from an array whose samples at the needed ranks are in
+ *	their sorted positions.
+ */
+static void
+interpolateQuantiles(
+	const double *	samples,
+	size_t		count,
+	const double *	probabilities,
+	size_t		numberOfProbabilities,
+	double *	quantiles)
+{
+	for (size_t j = 0; j < numberOfProbabilities; j++)
+	{
+		double	position = fmin(fmax(probabilities[j], 0.0), 1.0) * (count - 1);
+		size_t	rank = (size_t) position;
+
+		if (count == 0)
+		{
+			quantiles[j] = NAN;
+		}
+		else
+		{
+			quantiles[j] = (rank + 1 < count) ?
+					(samples[rank] + (position - rank) * (samples[rank + 1] - samples[rank])) :
+					samples[rank];
+		}
+	}
+
+	return;
+}
+
+void
+sampleAnalysisSelectQuantiles(
+	double *	samples,
+	size_t		count,
+	const double *	probabilities,
+	size_t		numberOfProbabilities,
+	double *	quantiles)
+{
+	size_t *	ranks;
+	size_t		numberOfRanks = 0;
+
+	if (count == 0)
+	{
+		interpolateQuantiles(samples, count, probabilities, numberOfProbabilities, quantiles);
+
+		return;
+	}
+
+	ranks = (size_t *) checkedMalloc(2 * numberOfProbabilities * sizeof(size_t), __FILE__, __LINE__);
+	for (size_t j = 0; j < numberOfProbabilities; j++)
+	{
+		size_t	rank = (size_t) (fmin(fmax(probabilities[j], 0.0), 1.0) * (count - 1));
+
+		for (size_t k = rank; (k <= rank + 1) && (k < count); k++)
+		{
+			if ((numberOfRanks == 0) || (ranks[numberOfRanks - 1] < k))
+			{
+				ranks[numberOfRanks++] = k;
+			}
+		}
+	}
+
+	#pragma omp parallel
+	#pragma omp single
+	selectRanks(samples, 0, (ptrdiff_t) count - 1, ranks, numberOfRanks);
+
+	interpolateQuantiles(samples, count, probabilities, numberOfProbabilities, quantiles);
+	free(ranks);
+
+	return;
+}
+
+CommonConstantReturnType
+runSampleAnalysis(int argc, char *  argv[])
+{
+	const struct option	longOptions[] = {
+					{"json",	no_argument,	NULL,	'j'},
+					{"help",	no_argument,	NULL,	'h'},
+					{0},
+				};
+	int			option;
+	bool			isOutputJSONMode = false;
+	SampleFile		file;
+	SampleMoments		moments;
+	double			quantiles[kSampleAnalysisNumberOfQuantiles];
+	double			statistics[6];
+	uint64_t		numberOfSamples;
+	uint64_t		numberOfNonFiniteSamples;
+
+	while ((option = getopt_long(argc, argv, "jh", longOptions, NULL)) != -1)
+	{
+		switch (option)
+		{
+			case 'j':
+				isOutputJSONMode = true;
+				break;
+
+			case 'h':
+				printSampleAnalysisUsage();
+
+				exit(EXIT_SUCCESS);
+
+			default:
+				printSampleAnalysisUsage();
+
+				return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (optind + 1 != argc)
+	{
+		fprintf(stderr, "Error: Expected exactly one sample file to analyze.\n");
+		printSampleAnalysisUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (sampleFileMap(argv[optind], &file) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	sampleMomentsCompute(file.samples, file.numberOfSamples, &moments);
+
+	/*
+	 *	A sorted file without non-finite samples (e.g., from `merge -o`) already has
+	 *	its ranks in place. Otherwise, select them in a copy of the finite samples.
+	 */
+	if (file.isSorted && (moments.nonFiniteCount == 0))
+	{
+		interpolateQuantiles(file.samples, file.numberOfSamples, kSampleAnalysisProbabilities, kSampleAnalysisNumberOfQuantiles, quantiles);
+	}
+	else
+	{
+		double *	finiteSamples = (double *) checkedMalloc((moments.count + 1) * sizeof(double), __FILE__, __LINE__);
+
+		sampleAnalysisCopyFinite(file.samples, file.numberOfSamples, finiteSamples);
+		sampleAnalysisSelectQuantiles(finiteSamples, moments.count, kSampleAnalysisProbabilities, kSampleAnalysisNumberOfQuantiles, quantiles);
+		free(finiteSamples);
+	}
+
+	statistics[0] = (moments.count > 0) ? moments.mean : NAN;
+	sampleMomentsGetShape(&moments, &statistics[1], &statistics[2], &statistics[3]);
+	statistics[4] = (moments.count > 0) ? moments.min : NAN;
+	statistics[5] = (moments.count > 0) ? moments.max : NAN;
+	numberOfSamples = moments.count;
+	numberOfNonFiniteSamples = moments.nonFiniteCount;
+
+	if (isOutputJSONMode)
+	{
+		JSONVariable	variables[] = {
+			{
+				.variableSymbol = "sigmaCMpa",
+				.variableDescription = "Cutting stress (σc) (mean, variance, skewness, excess kurtosis, min, max)",
+				.values = (JSONVariablePointer) { .asDouble = statistics},
+				.type = kJSONVariableTypeDouble,
+				.size = 6,
+			},
+			{
+				.variableSymbol = "sigmaCMpaQuantiles",
+				.variableDescription = "Cutting stress (σc) (1st, 5th, 25th, 50th, 75th, 95th, and 99th percentiles)",
+				.values = (JSONVariablePointer) { .asDouble = quantiles},
+				.type = kJSONVariableTypeDouble,
+				.size = kSampleAnalysisNumberOfQuantiles,
+			},
+			{
+				.variableSymbol = "numberOfSamples",
+				.variableDescription = "Number of finite samples",
+				.values = (JSONVariablePointer) { .asUint64 = &numberOfSamples},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "numberOfNonFiniteSamples",
+				.variableDescription = "Number of non-finite samples",
+				.values = (JSONVariablePointer) { .asUint64 = &numberOfNonFiniteSamples},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+		};
+
+		printJSONVariables(variables, sizeof(variables) / sizeof(variables[0]), "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	}
+	else
+	{
+		printf("Analyzed %" PRIu64 " samples (%" PRIu64 " non-finite) of \"%s\".\n", numberOfSamples, numberOfNonFiniteSamples, file.path);
+		printf("Cutting stress (σc): mean %le MPa, variance %le MPa^2, skewness %le, excess kurtosis %le\n",
+			statistics[0], statistics[1], statistics[2], statistics[3]);
+		printf("Cutting stress (σc) min = %le MPa\n", statistics[4]);
+		for (size_t j = 0; j < kSampleAnalysisNumberOfQuantiles; j++)
+		{
+			printf("Cutting stress (σc) %s = %le MPa\n", kSampleAnalysisQuantileNames[j], quantiles[j]);
+		}
+		printf("Cutting stress (σc) max = %le MPa\n", statistics[5]);
+	}
+
+	sampleFileUnmap(&file);
+
+	return kCommonConstantReturnTypeSuccess;
+}
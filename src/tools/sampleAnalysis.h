@@ -0,0 +1,106 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "common.h"
+
+
+#define	kSampleAnalysisBlockSize	(4096)
+
+/*
+ *	Count, mean, and central moment sums (M2 = Σ(x - mean)^2, and so on) of the
+ *	finite samples of a file, with its extremes and its number of non-finite samples.
+ */
+typedef struct SampleMoments
+{
+	uint64_t	count;
+	uint64_t	nonFiniteCount;
+	double		mean;
+	double		m2;
+	double		m3;
+	double		m4;
+	double		min;
+	double		max;
+} SampleMoments;
+
+/**
+ *	@brief	Compute the moments of an array of samples in one pass. Each thread takes a
+ *		contiguous slice and reduces it one cache-sized block at a time with SIMD loops,
+ *		and the block and thread results are combined in order (Pébay's formulas).
+ *
+ *	@param	samples		: Array of samples.
+ *	@param	count		: Number of samples in `samples`.
+ *	@param	moments		: Pointer to the moments to fill.
+ */
+void	sampleMomentsCompute(const double *  samples, size_t count, SampleMoments *  moments);
+
+/**
+ *	@brief	Get the unbiased variance, the skewness, and the excess kurtosis from moments.
+ *
+ *	@param	moments		: Pointer to the moments.
+ *	@param	variance	: Pointer to the variance to fill.
+ *	@param	skewness	: Pointer to the skewness to fill.
+ *	@param	kurtosis	: Pointer to the excess kurtosis to fill.
+ */
+void	sampleMomentsGetShape(const SampleMoments *  moments, double *  variance, double *  skewness, double *  kurtosis);
+
+/**
+ *	@brief	Copy the finite samples of an array, in parallel and in order.
+ *
+ *	@param	samples		: Array of samples.
+ *	@param	count		: Number of samples in `samples`.
+ *	@param	finiteSamples	: Array with room for the finite samples.
+ *	@return			: Number of finite samples copied.
+ */
+size_t	sampleAnalysisCopyFinite(const double *  samples, size_t count, double *  finiteSamples);
+
+/**
+ *	@brief	Compute exact quantiles by partitioning an array in place (multi-quickselect),
+ *		with the larger partitions split in parallel. The quantile at probability `p`
+ *		interpolates linearly between the samples at ranks floor(p(n - 1)) and the next.
+ *
+ *	@param	samples			: Array of finite samples, which is reordered.
+ *	@param	count			: Number of samples in `samples`.
+ *	@param	probabilities		: Array of probabilities in [0, 1], in increasing order.
+ *	@param	numberOfProbabilities	: Number of probabilities.
+ *	@param	quantiles		: Array of `numberOfProbabilities` quantiles to fill (NAN if `count` is 0).
+ */
+void	sampleAnalysisSelectQuantiles(
+		double *	samples,
+		size_t		count,
+		const double *	probabilities,
+		size_t		numberOfProbabilities,
+		double *	quantiles);
+
+/**
+ *	@brief	Analyze a `data.out` file: its mean, variance, skewness, kurtosis, extremes,
+ *		and exact quantiles.
+ *
+ *	@param	argc	: Argument count of the `analyze` subcommand, including its name.
+ *	@param	argv	: Argument vector of the `analyze` subcommand.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runSampleAnalysis(int argc, char *  argv[]);
@@ -0,0 +1,575 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "sampleComparison.h"
+#include "sampleAnalysis.h"
+#include "sampleFile.h"
+#include "externalSort.h"
+#include "common.h"
+
+
+#define	kSampleComparisonStreamBufferSize	(16 * kExternalSortMergeBufferSize)
+
+typedef struct SampleComparisonOptions
+{
+	double		kolmogorovSmirnovThreshold;
+	double		andersonDarlingThreshold;
+	double		wassersteinThreshold;
+	double		meanThreshold;
+	double		standardDeviationThreshold;
+	const char *	directory;
+	size_t		memoryLimit;
+	bool		isOutputJSONMode;
+} SampleComparisonOptions;
+
+/*
+ *	The finite samples of one file in increasing order, read through `values`.
+ *	Samples that fit in memory are all in `values`. Otherwise, they are in a sorted
+ *	temporary file and `values` is a buffer that is refilled from it.
+ */
+typedef struct SortedSamples
+{
+	double *	values;
+	size_t		count;
+	size_t		position;
+	SortedRunFile	sortedFile;
+	uint64_t	numberOfUnreadSamples;
+	uint64_t	numberOfSamples;
+	SampleMoments	moments;
+	double		median;
+} SortedSamples;
+
+typedef struct ComparisonStatistics
+{
+	double	kolmogorovSmirnov;
+	double	wasserstein;
+	double	andersonDarling;
+} ComparisonStatistics;
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	valueA = *(const double *) a;
+	double	valueB = *(const double *) b;
+
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+static void
+printSampleComparisonUsage(void)
+{
+	fprintf(stderr, "Usage: sample-tool compare [options] <reference file> <candidate file>\n");
+	fprintf(stderr,
+		"\t[-k, --ks <D : double> (Default: the 5%% critical value, %.3lf * sqrt((n + m) / (n * m)))] (Threshold of the Kolmogorov–Smirnov statistic.)\n"
+		"\t[-a, --anderson-darling <A2 : double> (Default: %.3lf)] (Threshold of the Anderson–Darling statistic.)\n"
+		"\t[-w, --wasserstein <MPa : double>] (Threshold of the 1-Wasserstein distance.)\n"
+		"\t[-e, --mean <MPa : double>] (Threshold of the absolute difference of the means.)\n"
+		"\t[-s, --standard-deviation <MPa : double>] (Threshold of the absolute difference of the standard deviations.)\n"
+		"\t[-d, --directory <Path to directory : str> (Default: %s)] (Directory for the temporary sorted runs.)\n"
+		"\t[-m, --memory <MiB : int> (Default: %d)] (Memory limit for sorting.)\n"
+		"\t[-j, --json] (Print output in JSON format.)\n"
+		"\t[-h, --help] (Display this help message.)\n",
+		kSampleComparisonKolmogorovSmirnovCoefficient,
+		kSampleComparisonDefaultAndersonDarlingThreshold,
+		kExternalSortDefaultDirectory,
+		kSampleComparisonDefaultMemoryLimitMiB);
+
+	return;
+}
+
+static CommonConstantReturnType
+parseThreshold(const char *  argument, const char *  name, double *  threshold)
+{
+	if ((parseDoubleChecked(argument, threshold) != kCommonConstantReturnTypeSuccess) || !(*threshold >= 0.0))
+	{
+		fprintf(stderr, "Error: The %s threshold must be a non-negative number.\n", name);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static CommonConstantReturnType
+getSampleComparisonOptions(int argc, char *  argv[], SampleComparisonOptions *  options)
+{
+	const struct option	longOptions[] = {
+					{"ks",			required_argument,	NULL,	'k'},
+					{"anderson-darling",	required_argument,	NULL,	'a'},
+					{"wasserstein",		required_argument,	NULL,	'w'},
+					{"mean",		required_argument,	NULL,	'e'},
+					{"standard-deviation",	required_argument,	NULL,	's'},
+					{"directory",		required_argument,	NULL,	'd'},
+					{"memory",		required_argument,	NULL,	'm'},
+					{"json",		no_argument,		NULL,	'j'},
+					{"help",		no_argument,		NULL,	'h'},
+					{0},
+				};
+	int			option;
+	int			memoryLimitMiB;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	/*
+	 *	A NAN threshold is not checked, except for the Kolmogorov–Smirnov one, which
+	 *	then defaults to the critical value for the sizes of the two files.
+	 */
+	*options = (SampleComparisonOptions) {
+		.kolmogorovSmirnovThreshold	= NAN,
+		.andersonDarlingThreshold	= kSampleComparisonDefaultAndersonDarlingThreshold,
+		.wassersteinThreshold		= NAN,
+		.meanThreshold			= NAN,
+		.standardDeviationThreshold	= NAN,
+		.directory			= kExternalSortDefaultDirectory,
+		.memoryLimit			= (size_t) kSampleComparisonDefaultMemoryLimitMiB << 20,
+	};
+
+	while ((result == kCommonConstantReturnTypeSuccess) && ((option = getopt_long(argc, argv, "k:a:w:e:s:d:m:jh", longOptions, NULL)) != -1))
+	{
+		switch (option)
+		{
+			case 'k':
+				result = parseThreshold(optarg, "Kolmogorov–Smirnov", &options->kolmogorovSmirnovThreshold);
+				break;
+
+			case 'a':
+				result = parseThreshold(optarg, "Anderson–Darling", &options->andersonDarlingThreshold);
+				break;
+
+			case 'w':
+				result = parseThreshold(optarg, "Wasserstein", &options->wassersteinThreshold);
+				break;
+
+			case 'e':
+				result = parseThreshold(optarg, "mean", &options->meanThreshold);
+				break;
+
+			case 's':
+				result = parseThreshold(optarg, "standard deviation", &options->standardDeviationThreshold);
+				break;
+
+			case 'd':
+				options->directory = optarg;
+				break;
+
+			case 'm':
+				if ((parseIntChecked(optarg, &memoryLimitMiB) != kCommonConstantReturnTypeSuccess) || (memoryLimitMiB < 1))
+				{
+					fprintf(stderr, "Error: The memory limit must be an integer number of MiB of at least 1.\n");
+
+					return kCommonConstantReturnTypeError;
+				}
+				options->memoryLimit = (size_t) memoryLimitMiB << 20;
+				break;
+
+			case 'j':
+				options->isOutputJSONMode = true;
+				break;
+
+			case 'h':
+				printSampleComparisonUsage();
+
+				exit(EXIT_SUCCESS);
+
+			default:
+				printSampleComparisonUsage();
+
+				return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((result == kCommonConstantReturnTypeSuccess) && (optind + 2 != argc))
+	{
+		fprintf(stderr, "Error: Expected a reference and a candidate sample file.\n");
+		printSampleComparisonUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return result;
+}
+
+/*
+ *	Map a file, compute its moments, and sort its finite samples: in memory if
+ *	they fit in half the memory limit, else as sorted chunks of the memory limit
+ *	that are merged into one sorted run. Only one file is mapped at a time.
+ */
+static CommonConstantReturnType
+sortedSamplesPrepare(const char *  path, const SampleComparisonOptions *  options, SortedSamples *  sorted)
+{
+	static const double		kMedianProbability[] = {0.5};
+	SampleFile			file;
+	size_t				workspaceSize = options->memoryLimit / sizeof(double);
+	double *			workspace;
+	SortedRunFile			spillFile = {0};
+	SortedRun *			runs = NULL;
+	size_t				numberOfRuns = 0;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	memset(sorted, 0, sizeof(SortedSamples));
+	if (sampleFileMap(path, &file) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	sampleMomentsCompute(file.samples, file.numberOfSamples, &sorted->moments);
+	sorted->numberOfSamples = sorted->moments.count;
+	if (sorted->numberOfSamples == 0)
+	{
+		fprintf(stderr, "Error: \"%s\" has no finite samples.\n", path);
+		sampleFileUnmap(&file);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (sorted->numberOfSamples <= workspaceSize / 2)
+	{
+		sorted->values = (double *) checkedMalloc(sorted->numberOfSamples * sizeof(double), __FILE__, __LINE__);
+		sorted->count = sampleAnalysisCopyFinite(file.samples, file.numberOfSamples, sorted->values);
+		if (!file.isSorted)
+		{
+			qsort(sorted->values, sorted->count, sizeof(double), compareDoubles);
+		}
+		sorted->median = (sorted->count % 2 == 1) ?
+					sorted->values[sorted->count / 2] :
+					(0.5 * (sorted->values[sorted->count / 2 - 1] + sorted->values[sorted->count / 2]));
+		sampleFileUnmap(&file);
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	workspace = (double *) checkedMalloc(workspaceSize * sizeof(double), __FILE__, __LINE__);
+	runs = (SortedRun *) checkedMalloc(((file.numberOfSamples + workspaceSize - 1) / workspaceSize) * sizeof(SortedRun), __FILE__, __LINE__);
+	result = sortedRunFileCreate(&spillFile, options->directory);
+	for (size_t first = 0; (first < file.numberOfSamples) && (result == kCommonConstantReturnTypeSuccess); first += workspaceSize)
+	{
+		size_t	count = (file.numberOfSamples - first < workspaceSize) ? (file.numberOfSamples - first) : workspaceSize;
+		size_t	numberOfFinite = sampleAnalysisCopyFinite(&file.samples[first], count, workspace);
+
+		qsort(workspace, numberOfFinite, sizeof(double), compareDoubles);
+		sortedRunCreate(&runs[numberOfRuns], &spillFile);
+		result = sortedRunAppend(&runs[numberOfRuns++], workspace, numberOfFinite);
+	}
+	sampleFileUnmap(&file);
+
+	if ((result == kCommonConstantReturnTypeSuccess) &&
+		((sortedRunFileCreate(&sorted->sortedFile, options->directory) != kCommonConstantReturnTypeSuccess) ||
+		(sortedRunsMerge(
+			runs,
+			numberOfRuns,
+			options->directory,
+			workspace,
+			workspaceSize,
+			kMedianProbability,
+			1,
+			&sorted->median,
+			sorted->sortedFile.file,
+			NULL) != kCommonConstantReturnTypeSuccess)))
+	{
+		result = kCommonConstantReturnTypeError;
+	}
+	sortedRunFileFree(&spillFile);
+	free(workspace);
+	free(runs);
+
+	if (result == kCommonConstantReturnTypeSuccess)
+	{
+		rewind(sorted->sortedFile.file);
+		sorted->numberOfUnreadSamples = sorted->numberOfSamples;
+		sorted->values = (double *) checkedMalloc(kSampleComparisonStreamBufferSize * sizeof(double), __FILE__, __LINE__);
+	}
+
+	return result;
+}
+
+static void
+sortedSamplesFree(SortedSamples *  sorted)
+{
+	free(sorted->values);
+	sorted->values = NULL;
+	sortedRunFileFree(&sorted->sortedFile);
+
+	return;
+}
+
+/*
+ *	Get the next sample without consuming it, refilling the buffer from the sorted
+ *	run if needed. Returns false when the samples are exhausted or cannot be read.
+ */
+static bool
+sortedSamplesPeek(SortedSamples *  sorted, double *  value)
+{
+	if ((sorted->position == sorted->count) && (sorted->numberOfUnreadSamples > 0))
+	{
+		size_t	count = (sorted->numberOfUnreadSamples < kSampleComparisonStreamBufferSize) ?
+					(size_t) sorted->numberOfUnreadSamples : kSampleComparisonStreamBufferSize;
+
+		if (fread(sorted->values, sizeof(double), count, sorted->sortedFile.file) != count)
+		{
+			fprintf(stderr, "Error: Could not read a sorted run.\n");
+			sorted->numberOfUnreadSamples = 0;
+
+			return false;
+		}
+		sorted->count = count;
+		sorted->position = 0;
+		sorted->numberOfUnreadSamples -= count;
+	}
+
+	if (sorted->position == sorted->count)
+	{
+		return false;
+	}
+	*value = sorted->values[sorted->position];
+
+	return true;
+}
+
+/*
+ *	Merge the two sorted sequences once, visiting each distinct value `z` with the
+ *	numbers of samples of each file at or below it. Between consecutive values the
+ *	empirical distribution functions are constant, which gives the Wasserstein
+ *	integral exactly. The Anderson–Darling statistic is the k-sample one of Scholz
+ *	and Stephens (1987) for k = 2, in its midrank form for ties.
+ */
+static CommonConstantReturnType
+compareSortedSamples(SortedSamples *  reference, SortedSamples *  candidate, ComparisonStatistics *  statistics)
+{
+	double		n = (double) reference->numberOfSamples;
+	double		m = (double) candidate->numberOfSamples;
+	double		total = n + m;
+	uint64_t	countReference = 0;
+	uint64_t	countCandidate = 0;
+	double		previous = 0.0;
+	double		andersonDarlingSum = 0.0;
+
+	*statistics = (ComparisonStatistics) {0};
+
+	for (;;)
+	{
+		double		valueReference;
+		double		valueCandidate;
+		bool		hasReference = sortedSamplesPeek(reference, &valueReference);
+		bool		hasCandidate = sortedSamplesPeek(candidate, &valueCandidate);
+		double		value;
+		uint64_t	tiesReference = 0;
+		uint64_t	tiesCandidate = 0;
+		double		ties;
+		double		midrank;
+		double		denominator;
+		double		difference;
+
+		if (!hasReference && !hasCandidate)
+		{
+			break;
+		}
+		value = (hasReference && (!hasCandidate || (valueReference <= valueCandidate))) ? valueReference : valueCandidate;
+
+		if ((countReference + countCandidate) > 0)
+		{
+			statistics->wasserstein += fabs(countReference / n - countCandidate / m) * (value - previous);
+		}
+
+		while (sortedSamplesPeek(reference, &valueReference) && (valueReference == value))
+		{
+			reference->position++;
+			tiesReference++;
+		}
+		while (sortedSamplesPeek(candidate, &valueCandidate) && (valueCandidate == value))
+		{
+			candidate->position++;
+			tiesCandidate++;
+		}
+
+		countReference += tiesReference;
+		countCandidate += tiesCandidate;
+		difference = fabs(countReference / n - countCandidate / m);
+		statistics->kolmogorovSmirnov = (difference > statistics->kolmogorovSmirnov) ? difference : statistics->kolmogorovSmirnov;
+
+		ties = (double) (tiesReference + tiesCandidate);
+		midrank = (double) (countReference + countCandidate) - 0.5 * ties;
+		denominator = midrank * (total - midrank) - total * ties / 4.0;
+		if (denominator > 0.0)
+		{
+			double	deviationReference = total * (countReference - 0.5 * tiesReference) - n * midrank;
+			double	deviationCandidate = total * (countCandidate - 0.5 * tiesCandidate) - m * midrank;
+
+			andersonDarlingSum += ties * (deviationReference * deviationReference / n + deviationCandidate * deviationCandidate / m) / denominator;
+		}
+		previous = value;
+	}
+
+	if ((countReference != reference->numberOfSamples) || (countCandidate != candidate->numberOfSamples))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+	statistics->andersonDarling = (total - 1.0) / (total * total) * andersonDarlingSum;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Check one statistic against its threshold, where a NAN threshold is not checked.
+ */
+static bool
+checkThreshold(const char *  name, double value, double threshold, bool isOutputJSONMode)
+{
+	bool	isPassed = isnan(threshold) || (fabs(value) <= threshold);
+
+	if (!isOutputJSONMode && !isnan(threshold))
+	{
+		printf("Check %s: %le <= %le (%s)\n", name, fabs(value), threshold, isPassed ? "pass" : "FAIL");
+	}
+
+	return isPassed;
+}
+
+CommonConstantReturnType
+runSampleComparison(int argc, char *  argv[])
+{
+	SampleComparisonOptions	options;
+	SortedSamples		reference;
+	SortedSamples		candidate;
+	ComparisonStatistics	statistics;
+	double			shapes[2][3];
+	double			deltas[5];
+	double			values[3];
+	uint64_t		isPassed = 1;
+	uint64_t		numberOfSamples[2];
+
+	if (getSampleComparisonOptions(argc, argv, &options) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (sortedSamplesPrepare(argv[optind], &options, &reference) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+	if (sortedSamplesPrepare(argv[optind + 1], &options, &candidate) != kCommonConstantReturnTypeSuccess)
+	{
+		sortedSamplesFree(&reference);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (compareSortedSamples(&reference, &candidate, &statistics) != kCommonConstantReturnTypeSuccess)
+	{
+		sortedSamplesFree(&reference);
+		sortedSamplesFree(&candidate);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Moment deltas are candidate minus reference.
+	 */
+	sampleMomentsGetShape(&reference.moments, &shapes[0][0], &shapes[0][1], &shapes[0][2]);
+	sampleMomentsGetShape(&candidate.moments, &shapes[1][0], &shapes[1][1], &shapes[1][2]);
+	deltas[0] = candidate.moments.mean - reference.moments.mean;
+	deltas[1] = sqrt(shapes[1][0]) - sqrt(shapes[0][0]);
+	deltas[2] = shapes[1][1] - shapes[0][1];
+	deltas[3] = shapes[1][2] - shapes[0][2];
+	deltas[4] = candidate.median - reference.median;
+	values[0] = statistics.kolmogorovSmirnov;
+	values[1] = statistics.wasserstein;
+	values[2] = statistics.andersonDarling;
+	numberOfSamples[0] = reference.numberOfSamples;
+	numberOfSamples[1] = candidate.numberOfSamples;
+
+	if (isnan(options.kolmogorovSmirnovThreshold))
+	{
+		options.kolmogorovSmirnovThreshold = kSampleComparisonKolmogorovSmirnovCoefficient *
+			sqrt((double) (reference.numberOfSamples + candidate.numberOfSamples) / ((double) reference.numberOfSamples * candidate.numberOfSamples));
+	}
+
+	if (!options.isOutputJSONMode)
+	{
+		printf("Compared %" PRIu64 " reference samples of \"%s\" with %" PRIu64 " candidate samples of \"%s\".\n",
+			numberOfSamples[0], argv[optind], numberOfSamples[1], argv[optind + 1]);
+		printf("Kolmogorov–Smirnov statistic\t= %le\n", statistics.kolmogorovSmirnov);
+		printf("1-Wasserstein distance\t\t= %le MPa\n", statistics.wasserstein);
+		printf("Anderson–Darling statistic\t= %le\n", statistics.andersonDarling);
+		printf("Δ mean\t\t\t\t= %le MPa\n", deltas[0]);
+		printf("Δ standard deviation\t\t= %le MPa\n", deltas[1]);
+		printf("Δ skewness\t\t\t= %le\n", deltas[2]);
+		printf("Δ excess kurtosis\t\t= %le\n", deltas[3]);
+		printf("Δ median\t\t\t= %le MPa\n", deltas[4]);
+	}
+
+	isPassed &= checkThreshold("Kolmogorov–Smirnov", statistics.kolmogorovSmirnov, options.kolmogorovSmirnovThreshold, options.isOutputJSONMode);
+	isPassed &= checkThreshold("Anderson–Darling", statistics.andersonDarling, options.andersonDarlingThreshold, options.isOutputJSONMode);
+	isPassed &= checkThreshold("1-Wasserstein", statistics.wasserstein, options.wassersteinThreshold, options.isOutputJSONMode);
+	isPassed &= checkThreshold("Δ mean", deltas[0], options.meanThreshold, options.isOutputJSONMode);
+	isPassed &= checkThreshold("Δ standard deviation", deltas[1], options.standardDeviationThreshold, options.isOutputJSONMode);
+
+	if (options.isOutputJSONMode)
+	{
+		JSONVariable	variables[] = {
+			{
+				.variableSymbol = "twoSampleStatistics",
+				.variableDescription = "Kolmogorov–Smirnov statistic, 1-Wasserstein distance (MPa), and Anderson–Darling statistic",
+				.values = (JSONVariablePointer) { .asDouble = values},
+				.type = kJSONVariableTypeDouble,
+				.size = 3,
+			},
+			{
+				.variableSymbol = "deltaSigmaCMpa",
+				.variableDescription = "Candidate minus reference cutting stress (σc) (mean, standard deviation, skewness, excess kurtosis, median)",
+				.values = (JSONVariablePointer) { .asDouble = deltas},
+				.type = kJSONVariableTypeDouble,
+				.size = 5,
+			},
+			{
+				.variableSymbol = "numberOfSamples",
+				.variableDescription = "Number of finite samples of the reference and of the candidate",
+				.values = (JSONVariablePointer) { .asUint64 = numberOfSamples},
+				.type = kJSONVariableTypeUint64,
+				.size = 2,
+			},
+			{
+				.variableSymbol = "isPassed",
+				.variableDescription = "Whether all checked statistics are within their thresholds",
+				.values = (JSONVariablePointer) { .asUint64 = &isPassed},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+		};
+
+		printJSONVariables(variables, sizeof(variables) / sizeof(variables[0]), "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	}
+	else
+	{
+		printf("%s\n", isPassed ? "PASS" : "FAIL");
+	}
+
+	sortedSamplesFree(&reference);
+	sortedSamplesFree(&candidate);
+
+	return isPassed ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+}
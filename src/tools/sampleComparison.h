@@ -0,0 +1,45 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "common.h"
+
+
+#define	kSampleComparisonDefaultMemoryLimitMiB		(1024)
+#define	kSampleComparisonDefaultAndersonDarlingThreshold	(2.492)
+#define	kSampleComparisonKolmogorovSmirnovCoefficient	(1.358)
+
+/**
+ *	@brief	Compare the distributions of two sample files (a reference and a candidate) with
+ *		the two-sample Kolmogorov–Smirnov, 1-Wasserstein, and Anderson–Darling statistics
+ *		and the differences of their moments, and check them against thresholds. The
+ *		statistics are exact: each file is sorted in memory if it fits in half the memory
+ *		limit and by an external merge sort otherwise, and the two sorted sequences are
+ *		merged in one streaming pass.
+ *
+ *	@param	argc	: Argument count of the `compare` subcommand, including its name.
+ *	@param	argv	: Argument vector of the `compare` subcommand.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if all checks pass, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runSampleComparison(int argc, char *  argv[]);
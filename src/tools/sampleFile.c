@@ -0,0 +1,294 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "sampleFile.h"
+#include "hash.h"
+#include "common.h"
+
+
+#define	kSampleFileMaximumLineLength		(64)
+
+static const char	kSampleFileMagic[8] = {'B', 'H', 'S', 'A', 'M', 'P', 'L', '\0'};
+
+static size_t
+getMaximumNumberOfThreads(void)
+{
+#ifdef _OPENMP
+	return (size_t) omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+/*
+ *	Offset of the first line that starts at or after `offset`.
+ */
+static size_t
+findLineStart(const char *  text, size_t size, size_t offset)
+{
+	const char *	newline;
+
+	if ((offset == 0) || (offset >= size))
+	{
+		return (offset == 0) ? 0 : size;
+	}
+
+	newline = (const char *) memchr(&text[offset - 1], '\n', size - (offset - 1));
+
+	return (newline == NULL) ? size : (size_t) (newline - text) + 1;
+}
+
+/*
+ *	Parse one line of at most `kSampleFileMaximumLineLength` characters. The
+ *	mapping need not be null-terminated, so the line is copied first.
+ */
+static bool
+parseLine(const char *  line, size_t length, double *  value)
+{
+	char	buffer[kSampleFileMaximumLineLength + 1];
+	char *	end;
+
+	if (length > kSampleFileMaximumLineLength)
+	{
+		return false;
+	}
+
+	memcpy(buffer, line, length);
+	buffer[length] = '\0';
+	*value = strtod(buffer, &end);
+	while ((*end == ' ') || (*end == '\t') || (*end == '\r'))
+	{
+		end++;
+	}
+
+	return (end != buffer) && (*end == '\0');
+}
+
+/*
+ *	Count the non-empty lines of each range of lines in a first pass, then parse
+ *	each range into its place in a second pass.
+ */
+static CommonConstantReturnType
+sampleFileParseText(SampleFile *  file)
+{
+	const char *	text = (const char *) file->mapping;
+	size_t		size = file->mappingSize;
+	const char *	newline = (const char *) memchr(text, '\n', size);
+	size_t		bodyStart = (newline == NULL) ? size : (size_t) (newline - text) + 1;
+	size_t		numberOfThreads = getMaximumNumberOfThreads();
+	size_t *	bounds;
+	size_t *	offsets;
+	bool		isMalformed = false;
+	char		timeBuffer[kSampleFileMaximumLineLength + 1];
+	size_t		timeLength = (newline == NULL) ? size : (size_t) (newline - text);
+
+	if (timeLength > kSampleFileMaximumLineLength)
+	{
+		fprintf(stderr, "Error: The first line of \"%s\" is not a time in microseconds.\n", file->path);
+
+		return kCommonConstantReturnTypeError;
+	}
+	memcpy(timeBuffer, text, timeLength);
+	timeBuffer[timeLength] = '\0';
+	file->timeInMicroseconds = strtoull(timeBuffer, NULL, 10);
+
+	bounds = (size_t *) checkedMalloc((numberOfThreads + 1) * sizeof(size_t), __FILE__, __LINE__);
+	offsets = (size_t *) checkedMalloc((numberOfThreads + 1) * sizeof(size_t), __FILE__, __LINE__);
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		bounds[t] = findLineStart(text, size, bodyStart + t * ((size - bodyStart) / numberOfThreads));
+	}
+	bounds[numberOfThreads] = size;
+
+	#pragma omp parallel for schedule(static)
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		size_t	count = 0;
+
+		for (size_t start = bounds[t]; start < bounds[t + 1];)
+		{
+			const char *	end = (const char *) memchr(&text[start], '\n', bounds[t + 1] - start);
+			size_t		length = (end == NULL) ? (bounds[t + 1] - start) : (size_t) (end - &text[start]);
+
+			count += (length > 0);
+			start += length + 1;
+		}
+		offsets[t + 1] = count;
+	}
+
+	offsets[0] = 0;
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		offsets[t + 1] += offsets[t];
+	}
+	file->numberOfSamples = offsets[numberOfThreads];
+	file->parsedSamples = (double *) checkedMalloc((file->numberOfSamples + 1) * sizeof(double), __FILE__, __LINE__);
+
+	#pragma omp parallel for schedule(static) reduction(||:isMalformed)
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		double *	destination = &file->parsedSamples[offsets[t]];
+
+		for (size_t start = bounds[t]; start < bounds[t + 1];)
+		{
+			const char *	end = (const char *) memchr(&text[start], '\n', bounds[t + 1] - start);
+			size_t		length = (end == NULL) ? (bounds[t + 1] - start) : (size_t) (end - &text[start]);
+
+			if ((length > 0) && !parseLine(&text[start], length, destination++))
+			{
+				isMalformed = true;
+			}
+			start += length + 1;
+		}
+	}
+
+	free(bounds);
+	free(offsets);
+
+	if (isMalformed)
+	{
+		fprintf(stderr, "Error: \"%s\" has a line that is not a sample.\n", file->path);
+
+		return kCommonConstantReturnTypeError;
+	}
+	file->samples = file->parsedSamples;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static CommonConstantReturnType
+sampleFileParseBinary(SampleFile *  file)
+{
+	const SampleFileHeader *	header = (const SampleFileHeader *) file->mapping;
+
+	if ((header->version != kSampleFileVersion) ||
+		(header->numberOfSamples != (file->mappingSize - sizeof(SampleFileHeader)) / sizeof(double)) ||
+		((file->mappingSize - sizeof(SampleFileHeader)) % sizeof(double) != 0))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a valid version %d binary sample file.\n", file->path, kSampleFileVersion);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	file->isSorted = (header->isSorted != 0);
+	file->numberOfSamples = header->numberOfSamples;
+	file->samples = (const double *) ((const char *) file->mapping + sizeof(SampleFileHeader));
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+sampleFileMap(const char *  path, SampleFile *  file)
+{
+	int			fileDescriptor;
+	struct stat		status;
+	CommonConstantReturnType	result;
+	size_t			fingerprintLength;
+
+	memset(file, 0, sizeof(SampleFile));
+	file->path = path;
+
+	fileDescriptor = open(path, O_RDONLY);
+	if ((fileDescriptor < 0) || (fstat(fileDescriptor, &status) != 0) || (status.st_size == 0))
+	{
+		fprintf(stderr, "Error: Could not open \"%s\", or it is empty.\n", path);
+		if (fileDescriptor >= 0)
+		{
+			close(fileDescriptor);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	file->mappingSize = (size_t) status.st_size;
+	file->mapping = mmap(NULL, file->mappingSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	close(fileDescriptor);
+	if (file->mapping == MAP_FAILED)
+	{
+		fprintf(stderr, "Error: Could not map \"%s\" into memory.\n", path);
+		file->mapping = NULL;
+
+		return kCommonConstantReturnTypeError;
+	}
+	madvise(file->mapping, file->mappingSize, MADV_SEQUENTIAL);
+
+	file->isBinary = (file->mappingSize >= sizeof(SampleFileHeader)) &&
+				(memcmp(file->mapping, kSampleFileMagic, sizeof(kSampleFileMagic)) == 0);
+	result = file->isBinary ? sampleFileParseBinary(file) : sampleFileParseText(file);
+	if (result != kCommonConstantReturnTypeSuccess)
+	{
+		sampleFileUnmap(file);
+
+		return result;
+	}
+
+	fingerprintLength = (file->numberOfSamples < kSampleFileFingerprintLength) ? file->numberOfSamples : kSampleFileFingerprintLength;
+	file->fingerprint = hashFnv1aBytes(kHashFnv1aOffsetBasis, file->samples, fingerprintLength * sizeof(double));
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+sampleFileUnmap(SampleFile *  file)
+{
+	if (file->mapping != NULL)
+	{
+		munmap(file->mapping, file->mappingSize);
+		file->mapping = NULL;
+	}
+	free(file->parsedSamples);
+	file->parsedSamples = NULL;
+	file->samples = NULL;
+
+	return;
+}
+
+CommonConstantReturnType
+sampleFileWriteHeader(FILE *  stream, uint64_t numberOfSamples, bool isSorted)
+{
+	SampleFileHeader	header = {
+					.version		= kSampleFileVersion,
+					.numberOfSamples	= numberOfSamples,
+					.isSorted		= isSorted,
+				};
+
+	memcpy(header.magic, kSampleFileMagic, sizeof(kSampleFileMagic));
+	if (fwrite(&header, sizeof(header), 1, stream) != 1)
+	{
+		fprintf(stderr, "Error: Could not write a sample file header.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,93 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+
+#define	kSampleFileVersion			(1)
+#define	kSampleFileFingerprintLength		(16)
+
+/*
+ *	Samples of a `data.out` file, mapped into memory. A text file has the time
+ *	in microseconds on its first line and one sample per line after it. A binary
+ *	file has a `SampleFileHeader` followed by the samples as raw doubles, which
+ *	are used in place, read-only. The fingerprint hashes the first few samples: files
+ *	drawn from the same random-number streams (e.g., the same seed) share it.
+ */
+typedef struct SampleFile
+{
+	const char *	path;
+	void *		mapping;
+	size_t		mappingSize;
+	bool		isBinary;
+	bool		isSorted;
+	uint64_t	timeInMicroseconds;
+	size_t		numberOfSamples;
+	const double *	samples;
+	double *	parsedSamples;
+	uint64_t	fingerprint;
+} SampleFile;
+
+/*
+ *	Fixed-size header of a binary sample file.
+ */
+typedef struct SampleFileHeader
+{
+	char		magic[8];
+	uint64_t	version;
+	uint64_t	numberOfSamples;
+	uint64_t	isSorted;
+} SampleFileHeader;
+
+/**
+ *	@brief	Map a text or binary sample file into memory and parse it. Text files are
+ *		parsed in parallel, one range of lines per thread.
+ *
+ *	@param	path	: Path to the file.
+ *	@param	file	: Pointer to the sample file to fill.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleFileMap(const char *  path, SampleFile *  file);
+
+/**
+ *	@brief	Unmap a sample file and free its parsed samples.
+ *
+ *	@param	file	: Pointer to the sample file.
+ */
+void	sampleFileUnmap(SampleFile *  file);
+
+/**
+ *	@brief	Write the header of a binary sample file.
+ *
+ *	@param	stream		: Stream to write to.
+ *	@param	numberOfSamples	: Number of samples that will follow the header.
+ *	@param	isSorted	: Whether the samples are in increasing order.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleFileWriteHeader(FILE *  stream, uint64_t numberOfSamples, bool isSorted);
@@ -0,0 +1,83 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "shardMerge.h"
+#include "sampleAnalysis.h"
+#include "sampleComparison.h"
+#include "common.h"
+
+
+static void
+printToolUsage(void)
+{
+	fprintf(stderr, "Usage: sample-tool <subcommand> [options] <file> ...\n");
+	fprintf(stderr, "Subcommands for the `data.out` files of native Monte Carlo runs:\n");
+	fprintf(stderr,
+		"\tmerge\t(Merge the statistics of several shards, and optionally their sorted samples.)\n"
+		"\tanalyze\t(Compute the moments and exact quantiles of one sample file.)\n"
+		"\tcompare\t(Compare the distributions of two sample files against thresholds.)\n");
+	fprintf(stderr, "Run `sample-tool <subcommand> -h` for the options of a subcommand.\n");
+
+	return;
+}
+
+int
+main(int argc, char *  argv[])
+{
+	CommonConstantReturnType	result;
+
+	if (argc < 2)
+	{
+		printToolUsage();
+
+		return EXIT_FAILURE;
+	}
+
+	/*
+	 *	Each subcommand parses its own options from the arguments that follow its name.
+	 */
+	if (strcmp(argv[1], "merge") == 0)
+	{
+		result = runShardMerge(argc - 1, &argv[1]);
+	}
+	else if (strcmp(argv[1], "analyze") == 0)
+	{
+		result = runSampleAnalysis(argc - 1, &argv[1]);
+	}
+	else if (strcmp(argv[1], "compare") == 0)
+	{
+		result = runSampleComparison(argc - 1, &argv[1]);
+	}
+	else
+	{
+		fprintf(stderr, "Error: Unknown subcommand \"%s\".\n", argv[1]);
+		printToolUsage();
+
+		return EXIT_FAILURE;
+	}
+
+	return (result == kCommonConstantReturnTypeSuccess) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
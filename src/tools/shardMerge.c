@@ -0,0 +1,577 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "shardMerge.h"
+#include "sampleFile.h"
+#include "histogram.h"
+#include "externalSort.h"
+#include "common.h"
+
+
+static const double	kShardMergeProbabilities[] = {0.0, 0.05, 0.50, 0.95, 1.0};
+
+#define	kShardMergeNumberOfQuantiles	(sizeof(kShardMergeProbabilities) / sizeof(kShardMergeProbabilities[0]))
+
+typedef struct ShardMergeOptions
+{
+	const char *	sortedOutputPath;
+	bool		isTextOutput;
+	const char *	histogramPath;
+	const char *	directory;
+	size_t		memoryLimit;
+	bool		isOutputJSONMode;
+} ShardMergeOptions;
+
+/*
+ *	Sorted runs spilled from the shards into one file, for the merged sorted sample file.
+ */
+typedef struct ShardMergeRuns
+{
+	SortedRunFile	file;
+	SortedRun *	runs;
+	size_t		numberOfRuns;
+	size_t		capacity;
+	double *	chunk;
+	size_t		chunkCapacity;
+} ShardMergeRuns;
+
+static size_t
+getMaximumNumberOfThreads(void)
+{
+#ifdef _OPENMP
+	return (size_t) omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	valueA = *(const double *) a;
+	double	valueB = *(const double *) b;
+
+	return (valueA > valueB) - (valueA < valueB);
+}
+
+static void
+printShardMergeUsage(void)
+{
+	fprintf(stderr, "Usage: sample-tool merge [options] <shard> [<shard> ...]\n");
+	fprintf(stderr,
+		"\t[-o, --sorted-output <Path to merged sample file : str>] (Also write the finite samples of all shards, sorted, and report exact quantiles.)\n"
+		"\t[-f, --format <text | binary> (Default: binary)] (Format of the merged sample file.)\n"
+		"\t[-b, --bins <Path to histogram file : str>] (Write the bins of the merged histogram sketch as `lowerEdge upperEdge count` lines.)\n"
+		"\t[-d, --directory <Path to directory : str> (Default: %s)] (Directory for the temporary sorted runs.)\n"
+		"\t[-m, --memory <MiB : int> (Default: %d)] (Memory limit for sorting.)\n"
+		"\t[-j, --json] (Print output in JSON format.)\n"
+		"\t[-h, --help] (Display this help message.)\n",
+		kExternalSortDefaultDirectory,
+		kShardMergeDefaultMemoryLimitMiB);
+
+	return;
+}
+
+static CommonConstantReturnType
+getShardMergeOptions(int argc, char *  argv[], ShardMergeOptions *  options)
+{
+	const struct option	longOptions[] = {
+					{"sorted-output",	required_argument,	NULL,	'o'},
+					{"format",		required_argument,	NULL,	'f'},
+					{"bins",		required_argument,	NULL,	'b'},
+					{"directory",		required_argument,	NULL,	'd'},
+					{"memory",		required_argument,	NULL,	'm'},
+					{"json",		no_argument,		NULL,	'j'},
+					{"help",		no_argument,		NULL,	'h'},
+					{0},
+				};
+	int			option;
+	int			memoryLimitMiB;
+
+	*options = (ShardMergeOptions) {
+		.directory	= kExternalSortDefaultDirectory,
+		.memoryLimit	= (size_t) kShardMergeDefaultMemoryLimitMiB << 20,
+	};
+
+	while ((option = getopt_long(argc, argv, "o:f:b:d:m:jh", longOptions, NULL)) != -1)
+	{
+		switch (option)
+		{
+			case 'o':
+				options->sortedOutputPath = optarg;
+				break;
+
+			case 'f':
+				if ((strcmp(optarg, "text") != 0) && (strcmp(optarg, "binary") != 0))
+				{
+					fprintf(stderr, "Error: The format of the merged sample file must be `text` or `binary`.\n");
+
+					return kCommonConstantReturnTypeError;
+				}
+				options->isTextOutput = (strcmp(optarg, "text") == 0);
+				break;
+
+			case 'b':
+				options->histogramPath = optarg;
+				break;
+
+			case 'd':
+				options->directory = optarg;
+				break;
+
+			case 'm':
+				if ((parseIntChecked(optarg, &memoryLimitMiB) != kCommonConstantReturnTypeSuccess) || (memoryLimitMiB < 1))
+				{
+					fprintf(stderr, "Error: The memory limit must be an integer number of MiB of at least 1.\n");
+
+					return kCommonConstantReturnTypeError;
+				}
+				options->memoryLimit = (size_t) memoryLimitMiB << 20;
+				break;
+
+			case 'j':
+				options->isOutputJSONMode = true;
+				break;
+
+			case 'h':
+				printShardMergeUsage();
+
+				exit(EXIT_SUCCESS);
+
+			default:
+				printShardMergeUsage();
+
+				return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (optind >= argc)
+	{
+		fprintf(stderr, "Error: No shards to merge.\n");
+		printShardMergeUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Add the samples of a shard to its histogram, with one histogram per thread
+ *	over contiguous slices, merged in order.
+ */
+static void
+sketchShard(const SampleFile *  shard, StreamingHistogram *  histogram)
+{
+	size_t			numberOfThreads = getMaximumNumberOfThreads();
+	size_t			sliceSize = (shard->numberOfSamples + numberOfThreads - 1) / numberOfThreads;
+	StreamingHistogram *	threadHistograms = (StreamingHistogram *) checkedMalloc(numberOfThreads * sizeof(StreamingHistogram), __FILE__, __LINE__);
+
+	#pragma omp parallel for schedule(static)
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		size_t	first = t * sliceSize;
+
+		streamingHistogramInit(&threadHistograms[t]);
+		if (first < shard->numberOfSamples)
+		{
+			streamingHistogramAddArray(
+				&threadHistograms[t],
+				&shard->samples[first],
+				(shard->numberOfSamples - first < sliceSize) ? (shard->numberOfSamples - first) : sliceSize);
+		}
+	}
+
+	streamingHistogramInit(histogram);
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		streamingHistogramMerge(histogram, &threadHistograms[t]);
+	}
+	free(threadHistograms);
+
+	return;
+}
+
+/*
+ *	Spill the finite samples of a shard as sorted runs, one chunk of the memory
+ *	limit at a time, with the chunk sorted in one slice per thread.
+ */
+static CommonConstantReturnType
+spillShard(const SampleFile *  shard, ShardMergeRuns *  runs)
+{
+	size_t	numberOfThreads = getMaximumNumberOfThreads();
+
+	for (size_t first = 0; first < shard->numberOfSamples; first += runs->chunkCapacity)
+	{
+		size_t	count = (shard->numberOfSamples - first < runs->chunkCapacity) ? (shard->numberOfSamples - first) : runs->chunkCapacity;
+		size_t	numberOfFinite = 0;
+		size_t	sliceSize;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (isfinite(shard->samples[first + i]))
+			{
+				runs->chunk[numberOfFinite++] = shard->samples[first + i];
+			}
+		}
+		sliceSize = (numberOfFinite + numberOfThreads - 1) / numberOfThreads;
+
+		#pragma omp parallel for schedule(static)
+		for (size_t t = 0; t < numberOfThreads; t++)
+		{
+			size_t	sliceFirst = t * sliceSize;
+
+			if (sliceFirst < numberOfFinite)
+			{
+				qsort(&runs->chunk[sliceFirst], (numberOfFinite - sliceFirst < sliceSize) ? (numberOfFinite - sliceFirst) : sliceSize, sizeof(double), compareDoubles);
+			}
+		}
+
+		for (size_t sliceFirst = 0; sliceFirst < numberOfFinite; sliceFirst += sliceSize)
+		{
+			if (runs->numberOfRuns == runs->capacity)
+			{
+				runs->capacity = (runs->capacity == 0) ? 64 : (2 * runs->capacity);
+				runs->runs = (SortedRun *) realloc(runs->runs, runs->capacity * sizeof(SortedRun));
+				if (runs->runs == NULL)
+				{
+					fprintf(stderr, "Error: Out of memory while spilling \"%s\".\n", shard->path);
+
+					return kCommonConstantReturnTypeError;
+				}
+			}
+
+			sortedRunCreate(&runs->runs[runs->numberOfRuns], &runs->file);
+			if (sortedRunAppend(
+					&runs->runs[runs->numberOfRuns],
+					&runs->chunk[sliceFirst],
+					(numberOfFinite - sliceFirst < sliceSize) ? (numberOfFinite - sliceFirst) : sliceSize) != kCommonConstantReturnTypeSuccess)
+			{
+				return kCommonConstantReturnTypeError;
+			}
+			runs->numberOfRuns++;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Merge the spilled runs into the sorted sample file. A text file repeats the
+ *	`data.out` format, with the total time of the shards on its first line, so
+ *	the runs are first merged into a temporary binary file and then printed.
+ */
+static CommonConstantReturnType
+writeSortedOutput(
+	ShardMergeRuns *		runs,
+	const ShardMergeOptions *	options,
+	uint64_t			numberOfSamples,
+	uint64_t			timeInMicroseconds,
+	double *			quantiles)
+{
+	FILE *				file = fopen(options->sortedOutputPath, "wb");
+	SortedRunFile			merged = {0};
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", options->sortedOutputPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (options->isTextOutput)
+	{
+		result = sortedRunFileCreate(&merged, options->directory);
+	}
+	else
+	{
+		result = sampleFileWriteHeader(file, numberOfSamples, true);
+	}
+
+	if ((result == kCommonConstantReturnTypeSuccess) &&
+		(sortedRunsMerge(
+			runs->runs,
+			runs->numberOfRuns,
+			options->directory,
+			runs->chunk,
+			runs->chunkCapacity,
+			kShardMergeProbabilities,
+			kShardMergeNumberOfQuantiles,
+			quantiles,
+			options->isTextOutput ? merged.file : file,
+			NULL) != kCommonConstantReturnTypeSuccess))
+	{
+		result = kCommonConstantReturnTypeError;
+	}
+
+	if ((result == kCommonConstantReturnTypeSuccess) && options->isTextOutput)
+	{
+		fprintf(file, "%" PRIu64 "\n", timeInMicroseconds);
+		rewind(merged.file);
+		for (uint64_t first = 0; first < numberOfSamples; first += runs->chunkCapacity)
+		{
+			size_t	count = (numberOfSamples - first < runs->chunkCapacity) ? (size_t) (numberOfSamples - first) : runs->chunkCapacity;
+
+			if (fread(runs->chunk, sizeof(double), count, merged.file) != count)
+			{
+				fprintf(stderr, "Error: Could not read the merged samples.\n");
+				result = kCommonConstantReturnTypeError;
+				break;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				fprintf(file, "%lf\n", runs->chunk[i]);
+			}
+		}
+	}
+
+	sortedRunFileFree(&merged);
+	if ((fclose(file) != 0) && (result == kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Could not write \"%s\".\n", options->sortedOutputPath);
+		result = kCommonConstantReturnTypeError;
+	}
+
+	return result;
+}
+
+/*
+ *	Print the summary row of the merged shards, in the layout of
+ *	streamingHistogramPrintSummaryRow(), with the given min, percentiles, and max.
+ */
+static void
+printMergedSummaryRow(const StreamingHistogram *  merged, const double *  quantiles)
+{
+	printf("%-24s %12" PRIu64 " %14le %14le %14le %14le %14le %14le %14le %12" PRIu64 "\n",
+		"merged",
+		merged->count,
+		merged->mean,
+		sqrt(streamingHistogramVariance(merged)),
+		quantiles[0],
+		quantiles[1],
+		quantiles[2],
+		quantiles[3],
+		quantiles[4],
+		merged->nonFiniteCount);
+
+	return;
+}
+
+CommonConstantReturnType
+runShardMerge(int argc, char *  argv[])
+{
+	ShardMergeOptions	options;
+	size_t			numberOfShards;
+	char * const *		shardPaths;
+	StreamingHistogram *	shardHistograms;
+	uint64_t *		fingerprints;
+	StreamingHistogram	merged;
+	ShardMergeRuns		runs = {0};
+	uint64_t		timeInMicroseconds = 0;
+	uint64_t		numberOfSamples;
+	uint64_t		numberOfNonFiniteSamples;
+	uint64_t		numberOfShardsValue;
+	uint64_t		areQuantilesExact;
+	double			quantiles[kShardMergeNumberOfQuantiles];
+	double			statistics[2 + kShardMergeNumberOfQuantiles];
+
+	if (getShardMergeOptions(argc, argv, &options) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	numberOfShards = (size_t) (argc - optind);
+	shardPaths = &argv[optind];
+	shardHistograms = (StreamingHistogram *) checkedMalloc(numberOfShards * sizeof(StreamingHistogram), __FILE__, __LINE__);
+	fingerprints = (uint64_t *) checkedMalloc(numberOfShards * sizeof(uint64_t), __FILE__, __LINE__);
+	streamingHistogramInit(&merged);
+
+	if (options.sortedOutputPath != NULL)
+	{
+		runs.chunkCapacity = options.memoryLimit / sizeof(double);
+		runs.chunk = (double *) checkedMalloc(runs.chunkCapacity * sizeof(double), __FILE__, __LINE__);
+		if (sortedRunFileCreate(&runs.file, options.directory) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	Shards are processed one at a time, so at most one is mapped, and each is
+	 *	parsed, sketched, and sorted in parallel.
+	 */
+	for (size_t s = 0; s < numberOfShards; s++)
+	{
+		SampleFile	shard;
+
+		if (sampleFileMap(shardPaths[s], &shard) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		/*
+		 *	Each sampler block draws from its own stream, so shards run with the same
+		 *	seed (or copies of one shard) start with the same block of samples.
+		 */
+		fingerprints[s] = shard.fingerprint;
+		for (size_t r = 0; r < s; r++)
+		{
+			if ((fingerprints[r] == fingerprints[s]) && (shard.numberOfSamples > 0))
+			{
+				fprintf(stderr, "Error: Shards \"%s\" and \"%s\" start with the same samples. Were they run with the same seed (`-s`)?\n",
+					shardPaths[r], shardPaths[s]);
+				sampleFileUnmap(&shard);
+
+				return kCommonConstantReturnTypeError;
+			}
+		}
+
+		sketchShard(&shard, &shardHistograms[s]);
+		streamingHistogramMerge(&merged, &shardHistograms[s]);
+		timeInMicroseconds += shard.timeInMicroseconds;
+
+		if ((options.sortedOutputPath != NULL) && (spillShard(&shard, &runs) != kCommonConstantReturnTypeSuccess))
+		{
+			sampleFileUnmap(&shard);
+
+			return kCommonConstantReturnTypeError;
+		}
+		sampleFileUnmap(&shard);
+	}
+
+	numberOfSamples = merged.count;
+	numberOfNonFiniteSamples = merged.nonFiniteCount;
+	areQuantilesExact = (options.sortedOutputPath != NULL);
+
+	if (areQuantilesExact)
+	{
+		if (writeSortedOutput(&runs, &options, numberOfSamples, timeInMicroseconds, quantiles) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else
+	{
+		quantiles[0] = merged.min;
+		quantiles[kShardMergeNumberOfQuantiles - 1] = merged.max;
+		for (size_t j = 1; j + 1 < kShardMergeNumberOfQuantiles; j++)
+		{
+			quantiles[j] = streamingHistogramQuantile(&merged, kShardMergeProbabilities[j]);
+		}
+	}
+
+	if (options.histogramPath != NULL)
+	{
+		FILE *	histogramFile = fopen(options.histogramPath, "w");
+
+		if (histogramFile == NULL)
+		{
+			fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", options.histogramPath);
+
+			return kCommonConstantReturnTypeError;
+		}
+		streamingHistogramWriteBins(&merged, histogramFile);
+		fclose(histogramFile);
+	}
+
+	statistics[0] = merged.mean;
+	statistics[1] = sqrt(streamingHistogramVariance(&merged));
+	memcpy(&statistics[2], quantiles, sizeof(quantiles));
+	numberOfShardsValue = numberOfShards;
+
+	if (options.isOutputJSONMode)
+	{
+		JSONVariable	variables[] = {
+			{
+				.variableSymbol = "sigmaCMpa",
+				.variableDescription = "Cutting stress (σc) of the merged shards (mean, standard deviation, min, 5th, 50th, and 95th percentiles, max)",
+				.values = (JSONVariablePointer) { .asDouble = statistics},
+				.type = kJSONVariableTypeDouble,
+				.size = 2 + kShardMergeNumberOfQuantiles,
+			},
+			{
+				.variableSymbol = "numberOfSamples",
+				.variableDescription = "Number of finite samples in the merged shards",
+				.values = (JSONVariablePointer) { .asUint64 = &numberOfSamples},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "numberOfNonFiniteSamples",
+				.variableDescription = "Number of non-finite samples in the merged shards",
+				.values = (JSONVariablePointer) { .asUint64 = &numberOfNonFiniteSamples},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "numberOfShards",
+				.variableDescription = "Number of merged shards",
+				.values = (JSONVariablePointer) { .asUint64 = &numberOfShardsValue},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+			{
+				.variableSymbol = "areQuantilesExact",
+				.variableDescription = "Whether the quantiles are exact (1) or estimated from the histogram sketch (0)",
+				.values = (JSONVariablePointer) { .asUint64 = &areQuantilesExact},
+				.type = kJSONVariableTypeUint64,
+				.size = 1,
+			},
+		};
+
+		printJSONVariables(variables, sizeof(variables) / sizeof(variables[0]), "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	}
+	else
+	{
+		streamingHistogramPrintSummaryHeader(stdout, "shard", false);
+		for (size_t s = 0; s < numberOfShards; s++)
+		{
+			streamingHistogramPrintSummaryRow(stdout, shardPaths[s], &shardHistograms[s], false);
+		}
+		printMergedSummaryRow(&merged, quantiles);
+
+		if (areQuantilesExact)
+		{
+			printf("Exact quantiles of the %" PRIu64 " merged samples: min %le, p05 %le, p50 %le, p95 %le, max %le\n",
+				numberOfSamples, quantiles[0], quantiles[1], quantiles[2], quantiles[3], quantiles[4]);
+		}
+	}
+
+	sortedRunFileFree(&runs.file);
+	free(runs.chunk);
+	free(runs.runs);
+	free(shardHistograms);
+	free(fingerprints);
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,140 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace.h"
+#include "common.h"
+
+
+static int
+compareTraceRecordsByIteration(const void *  a, const void *  b)
+{
+	const TraceRecord *	recordA = (const TraceRecord *) a;
+	const TraceRecord *	recordB = (const TraceRecord *) b;
+
+	return (recordA->iteration > recordB->iteration) - (recordA->iteration < recordB->iteration);
+}
+
+CommonConstantReturnType
+traceRingBufferInit(
+	TraceRingBuffer *	ringBuffer,
+	size_t			capacity,
+	size_t			samplingInterval)
+{
+	if ((ringBuffer == NULL) || (capacity == 0) || (samplingInterval == 0))
+	{
+		fprintf(stderr, "Error: Invalid trace ring buffer configuration.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	ringBuffer->records = (TraceRecord *) checkedMalloc(capacity * sizeof(TraceRecord), __FILE__, __LINE__);
+	ringBuffer->capacity = capacity;
+	ringBuffer->samplingInterval = samplingInterval;
+	ringBuffer->numberOfRecordsWritten = 0;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+traceRingBufferFree(TraceRingBuffer *	ringBuffer)
+{
+	free(ringBuffer->records);
+	ringBuffer->records = NULL;
+
+	return;
+}
+
+void
+traceRingBufferDecode(
+	const TraceRingBuffer *	ringBuffers,
+	size_t			numberOfRingBuffers,
+	FILE *			stream)
+{
+	TraceRecord *	records;
+	size_t		numberOfRecords = 0;
+	uint64_t	numberOfRecordsWritten = 0;
+
+	for (size_t i = 0; i < numberOfRingBuffers; i++)
+	{
+		numberOfRecordsWritten += ringBuffers[i].numberOfRecordsWritten;
+		numberOfRecords += (ringBuffers[i].numberOfRecordsWritten < ringBuffers[i].capacity) ?
+					ringBuffers[i].numberOfRecordsWritten : ringBuffers[i].capacity;
+	}
+
+	if (numberOfRecords == 0)
+	{
+		return;
+	}
+
+	/*
+	 *	Gather the retained records of each ring buffer, oldest first.
+	 */
+	records = (TraceRecord *) checkedMalloc(numberOfRecords * sizeof(TraceRecord), __FILE__, __LINE__);
+	numberOfRecords = 0;
+	for (size_t i = 0; i < numberOfRingBuffers; i++)
+	{
+		const TraceRingBuffer *	ringBuffer = &ringBuffers[i];
+		uint64_t		first = 0;
+
+		if (ringBuffer->numberOfRecordsWritten > ringBuffer->capacity)
+		{
+			first = ringBuffer->numberOfRecordsWritten - ringBuffer->capacity;
+		}
+
+		for (uint64_t j = first; j < ringBuffer->numberOfRecordsWritten; j++)
+		{
+			records[numberOfRecords++] = ringBuffer->records[j % ringBuffer->capacity];
+		}
+	}
+
+	qsort(records, numberOfRecords, sizeof(TraceRecord), compareTraceRecordsByIteration);
+
+	/*
+	 *	Each ring keeps the tail of its own thread's iterations, so the records
+	 *	shown are not the globally last ones.
+	 */
+	if (numberOfRecords < numberOfRecordsWritten)
+	{
+		fprintf(stream, "Trace: showing the last %zu records of each of %zu threads (%zu of %" PRIu64 " traced iterations).\n",
+			ringBuffers[0].capacity, numberOfRingBuffers, numberOfRecords, numberOfRecordsWritten);
+	}
+
+	for (size_t i = 0; i < numberOfRecords; i++)
+	{
+		const double *	values = records[i].values;
+
+		fprintf(stream, "Iteration %" PRIu64 ":\n", records[i].iteration);
+		fprintf(stream, "Anti-phase boundary energy (γ)\t\t= %le J/m^2\n", values[kTraceValueIndexGamma]);
+		fprintf(stream, "Precipitate volume fraction (φ)\t\t= %le\n", values[kTraceValueIndexPhi]);
+		fprintf(stream, "Mean particle radius on plane (Rs)\t\t= %le m\n", values[kTraceValueIndexRs]);
+		fprintf(stream, "Shear modulus (G)\t\t= %le Pa\n", values[kTraceValueIndexG]);
+		fprintf(stream, "Magnitude of the Burger's vector (b)\t\t= %le m\n", values[kTraceValueIndexB]);
+		fprintf(stream, "Taylor factor (M)\t\t= %le\n", values[kTraceValueIndexM]);
+		fprintf(stream, "Cutting stress (σc)\t\t= %le MPa\n", values[kTraceValueIndexSigma]);
+	}
+
+	free(records);
+
+	return;
+}
@@ -0,0 +1,132 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "common.h"
+
+
+#define	kTraceDefaultCapacity		(4096)
+#define	kTraceDefaultSamplingInterval	(1)
+
+typedef enum
+{
+	kTraceValueIndexGamma	= 0,
+	kTraceValueIndexPhi,
+	kTraceValueIndexRs,
+	kTraceValueIndexG,
+	kTraceValueIndexB,
+	kTraceValueIndexM,
+	kTraceValueIndexSigma,
+	kTraceValueIndexMax,
+} TraceValueIndex;
+
+/*
+ *	One binary trace record. Records are fixed-size so that recording is a
+ *	single store into the ring and decoding can happen after the run.
+ */
+typedef struct TraceRecord
+{
+	uint64_t	iteration;
+	double		values[kTraceValueIndexMax];
+} TraceRecord;
+
+/*
+ *	Ring buffer of trace records. Each thread owns one ring buffer, so recording
+ *	needs no synchronization. When the ring is full, the oldest records are
+ *	overwritten.
+ */
+typedef struct TraceRingBuffer
+{
+	TraceRecord *	records;
+	size_t		capacity;
+	size_t		samplingInterval;
+	uint64_t	numberOfRecordsWritten;
+} TraceRingBuffer;
+
+/**
+ *	@brief	Allocate and initialize a trace ring buffer.
+ *
+ *	@param	ringBuffer		: Pointer to the ring buffer to initialize.
+ *	@param	capacity		: Number of records the ring buffer holds.
+ *	@param	samplingInterval	: Record every `samplingInterval`-th iteration.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	traceRingBufferInit(
+					TraceRingBuffer *	ringBuffer,
+					size_t			capacity,
+					size_t			samplingInterval);
+
+/**
+ *	@brief	Free the records of a trace ring buffer.
+ *
+ *	@param	ringBuffer	: Pointer to the ring buffer.
+ */
+void	traceRingBufferFree(TraceRingBuffer *	ringBuffer);
+
+/**
+ *	@brief	Record the inputs and output of one kernel iteration if the iteration is sampled.
+ *
+ *	@param	ringBuffer	: Pointer to the ring buffer.
+ *	@param	iteration	: Index of the Monte Carlo iteration.
+ *	@param	values		: Array of `kTraceValueIndexMax` values indexed by `TraceValueIndex`.
+ */
+static inline void
+traceRingBufferRecord(
+	TraceRingBuffer *	ringBuffer,
+	uint64_t		iteration,
+	const double *		values)
+{
+	TraceRecord *	record;
+
+	if ((iteration % ringBuffer->samplingInterval) != 0)
+	{
+		return;
+	}
+
+	record = &ringBuffer->records[ringBuffer->numberOfRecordsWritten % ringBuffer->capacity];
+	record->iteration = iteration;
+	for (size_t i = 0; i < kTraceValueIndexMax; i++)
+	{
+		record->values[i] = values[i];
+	}
+	ringBuffer->numberOfRecordsWritten++;
+
+	return;
+}
+
+/**
+ *	@brief	Decode the records held by one or more ring buffers and render them as text,
+ *		in increasing iteration order.
+ *
+ *	@param	ringBuffers		: Array of ring buffers (e.g., one per thread).
+ *	@param	numberOfRingBuffers	: Number of ring buffers in `ringBuffers`.
+ *	@param	stream			: Stream to print to.
+ */
+void	traceRingBufferDecode(
+		const TraceRingBuffer *	ringBuffers,
+		size_t			numberOfRingBuffers,
+		FILE *			stream);
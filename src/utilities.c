@@ -30,9 +30,466 @@
 #include <errno.h>
 #include <uxhw.h>
 #include "utilities.h"
+#include "trace.h"
+#include "interval.h"
+#include "polynomialChaos.h"
+#include "outOfCore.h"
+#include "parameterStudy.h"
+#include "voxelField.h"
 #include "common.h"
 
 
+static const char * const	kInputVariableNames[kInputDistributionIndexMax] = {
+					[kInputDistributionIndexB]	= "b",
+					[kInputDistributionIndexG]	= "G",
+					[kInputDistributionIndexGamma]	= "gamma",
+					[kInputDistributionIndexM]	= "M",
+					[kInputDistributionIndexPhi]	= "phi",
+					[kInputDistributionIndexRs]	= "Rs",
+				};
+
+/**
+ *	@brief	Parse a non-negative integer. Accepts decimal, or hexadecimal with a `0x` prefix.
+ *
+ *	@param	string	: String to parse.
+ *	@param	value	: Pointer to store the parsed value.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseUint64Checked(const char *  string, uint64_t *  value)
+{
+	char *			end;
+	unsigned long long	parsed;
+
+	if ((string == NULL) || !isdigit((unsigned char) string[0]))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	errno = 0;
+	parsed = strtoull(string, &end, 0);
+	if ((errno != 0) || (*end != '\0') || (parsed > UINT64_MAX))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	*value = (uint64_t) parsed;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse a non-negative integer that fits in a `size_t`.
+ *
+ *	@param	string	: String to parse.
+ *	@param	value	: Pointer to store the parsed value.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseSizeChecked(const char *  string, size_t *  value)
+{
+	uint64_t	parsed;
+
+	if ((parseUint64Checked(string, &parsed) != kCommonConstantReturnTypeSuccess) || (parsed > SIZE_MAX))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	*value = (size_t) parsed;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Look up an input variable by name.
+ *
+ *	@param	name	: Name of the variable (e.g., "gamma").
+ *	@param	length	: Length of `name`.
+ *	@return		: The index of the variable, or `kInputDistributionIndexMax` if there is no such variable.
+ */
+static InputDistributionIndex
+getInputDistributionIndexFromName(const char *  name, size_t length)
+{
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		if ((strlen(kInputVariableNames[i]) == length) && (strncmp(kInputVariableNames[i], name, length) == 0))
+		{
+			return (InputDistributionIndex) i;
+		}
+	}
+
+	return kInputDistributionIndexMax;
+}
+
+/**
+ *	@brief	Parse a list of pairwise correlations of the form `gamma:phi=0.5,G:M=0.3` into
+ *		a correlation matrix. Pairs that are not listed are uncorrelated.
+ *
+ *	@param	string			: String to parse.
+ *	@param	correlationMatrix	: Correlation matrix to fill.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseCorrelations(
+	const char *	string,
+	double		correlationMatrix[kInputDistributionIndexMax][kInputDistributionIndexMax])
+{
+	const char *	cursor = string;
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		for (size_t j = 0; j < kInputDistributionIndexMax; j++)
+		{
+			correlationMatrix[i][j] = (i == j) ? 1.0 : 0.0;
+		}
+	}
+
+	while (*cursor != '\0')
+	{
+		const char *		colon = strchr(cursor, ':');
+		const char *		equals = strchr(cursor, '=');
+		char *			end;
+		InputDistributionIndex	first;
+		InputDistributionIndex	second;
+		double			correlation;
+
+		if ((colon == NULL) || (equals == NULL) || (colon > equals))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		first = getInputDistributionIndexFromName(cursor, colon - cursor);
+		second = getInputDistributionIndexFromName(colon + 1, equals - colon - 1);
+		errno = 0;
+		correlation = strtod(equals + 1, &end);
+
+		if ((first == kInputDistributionIndexMax) || (second == kInputDistributionIndexMax) || (first == second) ||
+			(errno != 0) || (end == equals + 1) || ((*end != ',') && (*end != '\0')) || !(fabs(correlation) < 1.0))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		correlationMatrix[first][second] = correlation;
+		correlationMatrix[second][first] = correlation;
+		cursor = (*end == ',') ? (end + 1) : end;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse a colon-separated list of real numbers such as `3.6e5:10:5e-29:2e-28`.
+ *
+ *	@param	string			: String to parse.
+ *	@param	values			: Array to store the parsed values.
+ *	@param	maximumNumberOfValues	: Capacity of `values`.
+ *	@param	numberOfValues		: Pointer to store the number of parsed values.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseColonSeparatedDoubles(
+	const char *	string,
+	double *	values,
+	size_t		maximumNumberOfValues,
+	size_t *	numberOfValues)
+{
+	const char *	cursor = string;
+
+	*numberOfValues = 0;
+	while (true)
+	{
+		char *	end;
+
+		if (*numberOfValues == maximumNumberOfValues)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		errno = 0;
+		values[*numberOfValues] = strtod(cursor, &end);
+		if ((errno != 0) || (end == cursor) || ((*end != ':') && (*end != '\0')) || !isfinite(values[*numberOfValues]))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		(*numberOfValues)++;
+
+		if (*end == '\0')
+		{
+			return kCommonConstantReturnTypeSuccess;
+		}
+		cursor = end + 1;
+	}
+}
+
+/**
+ *	@brief	Read the components of a Gaussian mixture from a file with one
+ *		`<weight>,<mean>,<standardDeviation>` line per component. Blank lines and lines
+ *		starting with `#` are skipped.
+ *
+ *	@param	path		: Path of the file.
+ *	@param	values		: Array of `3 * kInputDistributionMaximumMixtureComponents` values to fill.
+ *	@param	numberOfValues	: Pointer to store the number of values read.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseMixtureFile(const char *  path, double *  values, size_t *  numberOfValues)
+{
+	FILE *	file = fopen(path, "r");
+	char	line[256];
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the mixture file \"%s\".\n", path);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*numberOfValues = 0;
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		const char *	cursor = line + strspn(line, " \t");
+
+		if ((*cursor == '#') || (*cursor == '\n') || (*cursor == '\r') || (*cursor == '\0'))
+		{
+			continue;
+		}
+
+		if ((*numberOfValues == 3 * kInputDistributionMaximumMixtureComponents) ||
+			(sscanf(cursor, "%lf , %lf , %lf", &values[*numberOfValues], &values[*numberOfValues + 1], &values[*numberOfValues + 2]) != 3))
+		{
+			fclose(file);
+
+			return kCommonConstantReturnTypeError;
+		}
+		*numberOfValues += 3;
+	}
+
+	fclose(file);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static CommonConstantReturnType	parseInputDistribution(const char *  string, InputDistribution *  distribution);
+
+/**
+ *	@brief	Parse a truncated input distribution of the form `<lower>:<upper>:<distribution>`.
+ *		A truncated uniform is the uniform over the intersection of the two ranges, and a
+ *		truncated constant is the constant itself, so only mixtures keep their bounds.
+ *
+ *	@param	string		: String to parse.
+ *	@param	distribution	: Pointer to store the distribution.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseTruncatedInputDistribution(const char *  string, InputDistribution *  distribution)
+{
+	const char	kTruncatedPrefix[] = "truncated:";
+	char *		end;
+	double		lower;
+	double		upper;
+
+	lower = strtod(string, &end);
+	if ((end == string) || (*end != ':'))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	string = end + 1;
+	upper = strtod(string, &end);
+	if ((end == string) || (*end != ':') || !(lower < upper) ||
+		(strncmp(end + 1, kTruncatedPrefix, strlen(kTruncatedPrefix)) == 0) ||
+		(parseInputDistribution(end + 1, distribution) != kCommonConstantReturnTypeSuccess))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	switch (distribution->kind)
+	{
+		case kInputDistributionKindConstant:
+			return ((distribution->value >= lower) && (distribution->value <= upper)) ?
+				kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+
+		case kInputDistributionKindUniform:
+			distribution->min = fmax(distribution->min, lower);
+			distribution->max = fmin(distribution->max, upper);
+
+			return (distribution->min < distribution->max) ? kCommonConstantReturnTypeSuccess : kCommonConstantReturnTypeError;
+
+		case kInputDistributionKindGaussianMixture:
+			distribution->truncationLower = lower;
+			distribution->truncationUpper = upper;
+			if (!(inputDistributionGetTruncatedMass(distribution) > 0.0))
+			{
+				return kCommonConstantReturnTypeError;
+			}
+			distribution->isTruncated = true;
+
+			return kCommonConstantReturnTypeSuccess;
+	}
+
+	return kCommonConstantReturnTypeError;
+}
+
+/**
+ *	@brief	Parse one input distribution of the form `<kind>:<parameters>`, where the kind is
+ *		`constant:<value>`, `uniform:<min>:<max>`, `gauss:<mean>:<standardDeviation>`,
+ *		`mixture:<weight>:<mean>:<standardDeviation>:...` with one triple per Gaussian component,
+ *		`mixture-file:<path>` with the triples read from a file, or
+ *		`truncated:<lower>:<upper>:<distribution>` for any of these restricted to a range.
+ *
+ *	@param	string		: String to parse.
+ *	@param	distribution	: Pointer to store the distribution.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseInputDistribution(const char *  string, InputDistribution *  distribution)
+{
+	const char	kConstantPrefix[] = "constant:";
+	const char	kUniformPrefix[] = "uniform:";
+	const char	kGaussPrefix[] = "gauss:";
+	const char	kMixturePrefix[] = "mixture:";
+	const char	kMixtureFilePrefix[] = "mixture-file:";
+	const char	kTruncatedPrefix[] = "truncated:";
+	double		values[3 * kInputDistributionMaximumMixtureComponents];
+	size_t		numberOfValues;
+	double		totalWeight = 0.0;
+
+	if (strncmp(string, kTruncatedPrefix, strlen(kTruncatedPrefix)) == 0)
+	{
+		return parseTruncatedInputDistribution(string + strlen(kTruncatedPrefix), distribution);
+	}
+
+	memset(distribution, 0, sizeof(InputDistribution));
+
+	if (strncmp(string, kConstantPrefix, strlen(kConstantPrefix)) == 0)
+	{
+		if (parseColonSeparatedDoubles(string + strlen(kConstantPrefix), values, 1, &numberOfValues) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		distribution->kind = kInputDistributionKindConstant;
+		distribution->value = values[0];
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	if (strncmp(string, kUniformPrefix, strlen(kUniformPrefix)) == 0)
+	{
+		if ((parseColonSeparatedDoubles(string + strlen(kUniformPrefix), values, 2, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfValues != 2) || !(values[0] < values[1]))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		distribution->kind = kInputDistributionKindUniform;
+		distribution->min = values[0];
+		distribution->max = values[1];
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	if (strncmp(string, kGaussPrefix, strlen(kGaussPrefix)) == 0)
+	{
+		if ((parseColonSeparatedDoubles(string + strlen(kGaussPrefix), values + 1, 2, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfValues != 2))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		values[0] = 1.0;
+		numberOfValues = 3;
+	}
+	else if (strncmp(string, kMixturePrefix, strlen(kMixturePrefix)) == 0)
+	{
+		if ((parseColonSeparatedDoubles(string + strlen(kMixturePrefix), values, 3 * kInputDistributionMaximumMixtureComponents, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfValues % 3 != 0))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else if (strncmp(string, kMixtureFilePrefix, strlen(kMixtureFilePrefix)) == 0)
+	{
+		if ((parseMixtureFile(string + strlen(kMixtureFilePrefix), values, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+			(numberOfValues == 0))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	distribution->kind = kInputDistributionKindGaussianMixture;
+	distribution->numberOfComponents = numberOfValues / 3;
+	for (size_t k = 0; k < distribution->numberOfComponents; k++)
+	{
+		distribution->weights[k] = values[3 * k];
+		distribution->means[k] = values[3 * k + 1];
+		distribution->standardDeviations[k] = values[3 * k + 2];
+		totalWeight += values[3 * k];
+
+		if (!(distribution->weights[k] > 0) || !(distribution->standardDeviations[k] > 0))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (fabs(totalWeight - 1.0) > 1E-9)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parse a list of input distributions of the form `phi=uniform:0.3:0.4,G=constant:7e10`
+ *		and replace the sampling distributions of the listed inputs.
+ *
+ *	@param	string		: String to parse.
+ *	@param	distributions	: Array of `kInputDistributionIndexMax` distributions to update.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseInputDistributions(const char *  string, InputDistribution *  distributions)
+{
+	const char *	cursor = string;
+
+	while (*cursor != '\0')
+	{
+		const char *		equals = strchr(cursor, '=');
+		const char *		comma;
+		char			specification[512];
+		size_t			length;
+		InputDistributionIndex	index;
+
+		if (equals == NULL)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		comma = strchr(equals, ',');
+		length = (comma == NULL) ? strlen(equals + 1) : (size_t) (comma - equals - 1);
+		index = getInputDistributionIndexFromName(cursor, equals - cursor);
+		if ((index == kInputDistributionIndexMax) || (length >= sizeof(specification)))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		memcpy(specification, equals + 1, length);
+		specification[length] = '\0';
+		if (parseInputDistribution(specification, &distributions[index]) != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		cursor = (comma == NULL) ? (equals + 1 + length) : (comma + 1);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
 void
 printUsage(void)
 {
@@ -52,7 +509,31 @@ printUsage(void)
 		"\t[-R, --mean-particle-radius <Rs: double> (Default: UxHwDoubleMixture(Gauss(%"SignaloidParticleModifier".1le, %"SignaloidParticleModifier".1le), Gauss(%"SignaloidParticleModifier".1le, %"SignaloidParticleModifier".1le), %"SignaloidParticleModifier".1lf))] (Set `Rs` variable.)\n"
 		"\t[-G, --shear-modulus <G: double> (Default: Uniform(%"SignaloidParticleModifier".1le, %"SignaloidParticleModifier".1le))] (Set `G` variable.)\n"
 		"\t[-B, --burgers-vector <b: double> (Default: %"SignaloidParticleModifier".2le)] (Set `b` variable.)\n"
-		"\t[-m, --taylor-factor <M: double> (Default: Uniform(%"SignaloidParticleModifier".1lf, %"SignaloidParticleModifier".1lf))] (Set `M` variable.)\n",
+		"\t[-m, --taylor-factor <M: double> (Default: Uniform(%"SignaloidParticleModifier".1lf, %"SignaloidParticleModifier".1lf))] (Set `M` variable.)\n"
+		"\t[-k, --trace-every <k: int> (Default: %d)] (In verbose Monte Carlo mode, trace every k-th iteration.)\n"
+		"\t[-d, --trace-distributions] (In Monte Carlo mode, trace the distributions of the inputs and of the kernel's intermediate terms.)\n"
+		"\t[-s, --seed <seed: int> (Default: 0x%" PRIX64 ")] (Seed of the native Monte Carlo sampler.)\n"
+		"\t[-c, --correlations <pairs: str> (e.g., gamma:phi=0.5,G:M=0.3)] (In Monte Carlo mode, correlate inputs through a Gaussian copula.)\n"
+		"\t[-a, --alloy-specifications <Path to alloy specification CSV file : str>] (In Monte Carlo mode, evaluate every alloy specification in the file.)\n"
+		"\t[-t, --coarsening <tEnd:steps[:kMin:kMax]> (Default k: Uniform(%"SignaloidParticleModifier".1le, %"SignaloidParticleModifier".1le) m^3/s)] (In Monte Carlo mode, evolve Rs by LSW coarsening and report statistics at `steps` times in [0, tEnd] seconds.)\n"
+		"\t[-e, --temperature-sweep <Tmin:Tmax:count[:dGdTMin:dGdTMax]> (Default dG/dT: Uniform(%"SignaloidParticleModifier".1le, %"SignaloidParticleModifier".1le) Pa/K)] (In Monte Carlo mode, take `G` as the shear modulus at %"SignaloidParticleModifier".0lf K and report statistics at `count` temperatures in [Tmin, Tmax] K.)\n"
+		"\t[-r, --particle-size-distribution <lognormal:<shape>[:<nodes>] | Path to particle-size CSV file : str> (Default nodes: %d)] (In Monte Carlo mode, average the model over a distribution of particle radii with mean `Rs`.)\n"
+		"\t[-A, --append-to <Path to run file : str>] (In Monte Carlo mode, extend the run saved in the file with `-M` more samples, or start it if the file does not exist.)\n"
+		"\t[-C, --cache <Path to cache directory : str>] (In Monte Carlo mode, reuse the results of an identical earlier run from the cache, or add them to it.)\n"
+		"\t[-D, --partial-derivatives] (In Monte Carlo mode, compute the partial derivatives of `σc` with respect to each input, for every sample.)\n"
+		"\t[-I, --interval] (Interval mode: Print guaranteed bounds of `σc` over the supports of the input distributions, without sampling.)\n"
+		"\t[-K, --truncation-sigmas <k: double> (Default: %.1lf)] (In interval mode, truncate the Gaussian components of `Rs` at k standard deviations.)\n"
+		"\t[-P, --pce <degree[:q]> (Default q: %.2lf)] (In Monte Carlo mode, fit a polynomial chaos expansion of `σc`, report its mean, variance, and Sobol indices, and sample the expansion instead of the model.)\n"
+		"\t[-F, --pce-file <Path to surrogate file : str>] (In Monte Carlo mode, save the expansion fitted with `-P` to the file, or, without `-P`, load it from the file.)\n"
+		"\t[-U, --distributions <list: str> (e.g., phi=uniform:0.3:0.4,Rs=mixture:0.6:1e-8:2e-9:0.4:3e-8:2e-9)] (In Monte Carlo or interval mode, set the distributions of inputs to `constant:<v>`, `uniform:<min>:<max>`, `gauss:<mean>:<sd>`, `mixture:<weight>:<mean>:<sd>:...`, or `mixture-file:<path>`, optionally as `truncated:<lower>:<upper>:<distribution>`.)\n"
+		"\t[-J, --save-joint-samples <Path to joint sample file : str>] (In Monte Carlo mode, save the input and output samples for later reweighting with `-W`.)\n"
+		"\t[-W, --reweight <Path to joint sample file : str>] (In Monte Carlo mode, estimate the output statistics under the current input distributions by reweighting saved samples, or run `-M` fresh samples if the weights degenerate.)\n"
+		"\t[-E, --parameter-derivatives] (In Monte Carlo mode, also estimate the derivatives of the mean of `σc` with respect to the parameters of the input distributions, in the same pass.)\n"
+		"\t[-O, --out-of-core <memoryMiB[:directory]>] (In Monte Carlo mode, spill sorted runs of samples to files in the directory (Default: %s) and merge them for exact quantiles, using at most the given memory for samples.)\n"
+		"\t[-w, --coupling-regimes] (In Monte Carlo mode, use the strongly coupled pair expression where it applies instead of the weakly coupled one, and report the fraction of samples in each regime.)\n"
+		"\t[-n, --domain-policy <keep|drop|clamp|abort> (Default: keep)] (In Monte Carlo mode, keep, drop, or clamp to zero the non-finite and negative outputs, or fail the run if there are any. The numbers of such outputs are always reported when there are any.)\n"
+		"\t[-Z, --zip] (With inputs given as lists or ranges of values, evaluate the lists element by element instead of their Cartesian product.)\n"
+		"\t[-V, --voxels <phiVolume:RsVolume[:float32|float64]> (Default type: float32)] (In Monte Carlo mode, evaluate `σc` for every voxel of raw volumes of `phi` and `Rs`, averaged over `-M` samples of the other inputs that all voxels share, and write it as a raw volume of the same type and layout to the output file.)\n",
 		kDemoSpecificConstantGammaUniformMin,
 		kDemoSpecificConstantGammaUniformMax,
 		kDemoSpecificConstantPhiUniformMin,
@@ -66,7 +547,18 @@ printUsage(void)
 		kDemoSpecificConstantGUniformMax,
 		kDemoSpecificConstantB,
 		kDemoSpecificConstantMUniformMin,
-		kDemoSpecificConstantMUniformMax);
+		kDemoSpecificConstantMUniformMax,
+		kTraceDefaultSamplingInterval,
+		kSamplerDefaultSeed,
+		kDemoSpecificConstantCoarseningRateUniformMin,
+		kDemoSpecificConstantCoarseningRateUniformMax,
+		kDemoSpecificConstantShearModulusSlopeUniformMin,
+		kDemoSpecificConstantShearModulusSlopeUniformMax,
+		kDemoSpecificConstantReferenceTemperature,
+		kParticleSizeDistributionDefaultNumberOfNodes,
+		kIntervalDefaultTruncationSigmas,
+		kPolynomialChaosDefaultQNorm,
+		kExternalSortDefaultDirectory);
 	fprintf(stderr, "\n");
 
 	return;
@@ -104,6 +596,51 @@ setDefaultCommandLineArguments(CommandLineArguments *	arguments)
 		.G			= UxHwDoubleUniformDist(kDemoSpecificConstantGUniformMin, kDemoSpecificConstantGUniformMax),
 		.b			= kDemoSpecificConstantB,
 		.M			= UxHwDoubleUniformDist(kDemoSpecificConstantMUniformMin, kDemoSpecificConstantMUniformMax),
+		.traceSamplingInterval	= kTraceDefaultSamplingInterval,
+		.seed			= kSamplerDefaultSeed,
+		.coarseningRateMin	= kDemoSpecificConstantCoarseningRateUniformMin,
+		.coarseningRateMax	= kDemoSpecificConstantCoarseningRateUniformMax,
+		.shearModulusSlopeMin	= kDemoSpecificConstantShearModulusSlopeUniformMin,
+		.shearModulusSlopeMax	= kDemoSpecificConstantShearModulusSlopeUniformMax,
+		.particleSizeDistributionNumberOfNodes	= kParticleSizeDistributionDefaultNumberOfNodes,
+		.intervalTruncationSigmas	= kIntervalDefaultTruncationSigmas,
+		.polynomialChaosDegree	= kPolynomialChaosDefaultDegree,
+		.polynomialChaosQNorm	= kPolynomialChaosDefaultQNorm,
+	};
+
+	/*
+	 *	Parametric description of the default distributions, for native Monte Carlo.
+	 */
+	arguments->samplingDistributions[kInputDistributionIndexGamma] = (InputDistribution) {
+		.kind			= kInputDistributionKindUniform,
+		.min			= kDemoSpecificConstantGammaUniformMin,
+		.max			= kDemoSpecificConstantGammaUniformMax,
+	};
+	arguments->samplingDistributions[kInputDistributionIndexPhi] = (InputDistribution) {
+		.kind			= kInputDistributionKindUniform,
+		.min			= kDemoSpecificConstantPhiUniformMin,
+		.max			= kDemoSpecificConstantPhiUniformMax,
+	};
+	arguments->samplingDistributions[kInputDistributionIndexRs] = (InputDistribution) {
+		.kind			= kInputDistributionKindGaussianMixture,
+		.numberOfComponents	= 2,
+		.weights		= {kDemoSpecificConstantRsMixtureFirstGaussianWeight, 1.0 - kDemoSpecificConstantRsMixtureFirstGaussianWeight},
+		.means			= {kDemoSpecificConstantRsMixtureFirstGaussianMean, kDemoSpecificConstantRsMixtureSecondGaussianMean},
+		.standardDeviations	= {kDemoSpecificConstantRsMixtureFirstGaussianStandardDeviation, kDemoSpecificConstantRsMixtureSecondGaussianStandardDeviation},
+	};
+	arguments->samplingDistributions[kInputDistributionIndexG] = (InputDistribution) {
+		.kind			= kInputDistributionKindUniform,
+		.min			= kDemoSpecificConstantGUniformMin,
+		.max			= kDemoSpecificConstantGUniformMax,
+	};
+	arguments->samplingDistributions[kInputDistributionIndexB] = (InputDistribution) {
+		.kind			= kInputDistributionKindConstant,
+		.value			= kDemoSpecificConstantB,
+	};
+	arguments->samplingDistributions[kInputDistributionIndexM] = (InputDistribution) {
+		.kind			= kInputDistributionKindUniform,
+		.min			= kDemoSpecificConstantMUniformMin,
+		.max			= kDemoSpecificConstantMUniformMax,
 	};
 
 	return kCommonConstantReturnTypeSuccess;
@@ -118,6 +655,31 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 	const char *	GArg = NULL;
 	const char *	bArg = NULL;
 	const char *	MArg = NULL;
+	const char *	traceSamplingIntervalArg = NULL;
+	bool		isTraceDistributionsEnabled = false;
+	const char *	seedArg = NULL;
+	const char *	correlationsArg = NULL;
+	const char *	alloySpecificationsArg = NULL;
+	const char *	coarseningArg = NULL;
+	const char *	temperatureSweepArg = NULL;
+	const char *	particleSizeDistributionArg = NULL;
+	const char *	runFileArg = NULL;
+	const char *	resultCacheArg = NULL;
+	bool		isPartialsEnabled = false;
+	bool		isIntervalMode = false;
+	const char *	intervalTruncationSigmasArg = NULL;
+	const char *	polynomialChaosArg = NULL;
+	const char *	polynomialChaosFileArg = NULL;
+	const char *	inputDistributionsArg = NULL;
+	const char *	jointSamplesArg = NULL;
+	const char *	reweightingArg = NULL;
+	bool		isParameterDerivativesEnabled = false;
+	const char *	outOfCoreArg = NULL;
+	bool		isRegimeSwitchingEnabled = false;
+	const char *	outputDomainPolicyArg = NULL;
+	bool		isParameterStudyZipped = false;
+	const char *	voxelFieldArg = NULL;
+	const char *	inputArgs[kInputDistributionIndexMax];
 	const char	kConstantStringUx[] = "Ux";
 
 	if (arguments == NULL)
@@ -139,6 +701,30 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		{ .opt = "G", .optAlternative = "shear-modulus", .hasArg = true,.foundArg = &GArg,		.foundOpt = NULL },
 		{ .opt = "B", .optAlternative = "burgers-vector", .hasArg = true,.foundArg = &bArg,		.foundOpt = NULL },
 		{ .opt = "m", .optAlternative = "taylor-factor", .hasArg = true,.foundArg = &MArg,		.foundOpt = NULL },
+		{ .opt = "k", .optAlternative = "trace-every", .hasArg = true,.foundArg = &traceSamplingIntervalArg,	.foundOpt = NULL },
+		{ .opt = "d", .optAlternative = "trace-distributions", .hasArg = false,.foundArg = NULL,	.foundOpt = &isTraceDistributionsEnabled },
+		{ .opt = "s", .optAlternative = "seed", .hasArg = true,.foundArg = &seedArg,		.foundOpt = NULL },
+		{ .opt = "c", .optAlternative = "correlations", .hasArg = true,.foundArg = &correlationsArg,	.foundOpt = NULL },
+		{ .opt = "a", .optAlternative = "alloy-specifications", .hasArg = true,.foundArg = &alloySpecificationsArg,	.foundOpt = NULL },
+		{ .opt = "t", .optAlternative = "coarsening", .hasArg = true,.foundArg = &coarseningArg,	.foundOpt = NULL },
+		{ .opt = "e", .optAlternative = "temperature-sweep", .hasArg = true,.foundArg = &temperatureSweepArg,	.foundOpt = NULL },
+		{ .opt = "r", .optAlternative = "particle-size-distribution", .hasArg = true,.foundArg = &particleSizeDistributionArg,	.foundOpt = NULL },
+		{ .opt = "A", .optAlternative = "append-to", .hasArg = true,.foundArg = &runFileArg,	.foundOpt = NULL },
+		{ .opt = "C", .optAlternative = "cache", .hasArg = true,.foundArg = &resultCacheArg,	.foundOpt = NULL },
+		{ .opt = "D", .optAlternative = "partial-derivatives", .hasArg = false,.foundArg = NULL,	.foundOpt = &isPartialsEnabled },
+		{ .opt = "I", .optAlternative = "interval", .hasArg = false,.foundArg = NULL,	.foundOpt = &isIntervalMode },
+		{ .opt = "K", .optAlternative = "truncation-sigmas", .hasArg = true,.foundArg = &intervalTruncationSigmasArg,	.foundOpt = NULL },
+		{ .opt = "P", .optAlternative = "pce", .hasArg = true,.foundArg = &polynomialChaosArg,	.foundOpt = NULL },
+		{ .opt = "F", .optAlternative = "pce-file", .hasArg = true,.foundArg = &polynomialChaosFileArg,	.foundOpt = NULL },
+		{ .opt = "U", .optAlternative = "distributions", .hasArg = true,.foundArg = &inputDistributionsArg,	.foundOpt = NULL },
+		{ .opt = "J", .optAlternative = "save-joint-samples", .hasArg = true,.foundArg = &jointSamplesArg,	.foundOpt = NULL },
+		{ .opt = "W", .optAlternative = "reweight", .hasArg = true,.foundArg = &reweightingArg,	.foundOpt = NULL },
+		{ .opt = "E", .optAlternative = "parameter-derivatives", .hasArg = false,.foundArg = NULL,	.foundOpt = &isParameterDerivativesEnabled },
+		{ .opt = "O", .optAlternative = "out-of-core", .hasArg = true,.foundArg = &outOfCoreArg,	.foundOpt = NULL },
+		{ .opt = "w", .optAlternative = "coupling-regimes", .hasArg = false,.foundArg = NULL,	.foundOpt = &isRegimeSwitchingEnabled },
+		{ .opt = "n", .optAlternative = "domain-policy", .hasArg = true,.foundArg = &outputDomainPolicyArg,	.foundOpt = NULL },
+		{ .opt = "Z", .optAlternative = "zip", .hasArg = false,.foundArg = NULL,	.foundOpt = &isParameterStudyZipped },
+		{ .opt = "V", .optAlternative = "voxels", .hasArg = true,.foundArg = &voxelFieldArg,	.foundOpt = NULL },
 		{0},
 	};
 
@@ -171,6 +757,57 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		return kCommonConstantReturnTypeError;
 	}
 
+	if (isTraceDistributionsEnabled && !arguments->common.isMonteCarloMode)
+	{
+		fprintf(stderr, "Error: Tracing distributions requires Monte Carlo mode (`-M`).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+	arguments->isTraceDistributionsEnabled = isTraceDistributionsEnabled;
+
+	/*
+	 *	An input given as a list or a range of values makes a parameter study. Its
+	 *	first value also stands in as the constant value of the input.
+	 */
+	inputArgs[kInputDistributionIndexB] = bArg;
+	inputArgs[kInputDistributionIndexG] = GArg;
+	inputArgs[kInputDistributionIndexGamma] = gammaArg;
+	inputArgs[kInputDistributionIndexM] = MArg;
+	inputArgs[kInputDistributionIndexPhi] = phiArg;
+	inputArgs[kInputDistributionIndexRs] = RsArg;
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		if ((inputArgs[d] == NULL) || (strpbrk(inputArgs[d], ",:") == NULL) || (strstr(inputArgs[d], kConstantStringUx) != NULL))
+		{
+			continue;
+		}
+
+		if (parseParameterStudyValues(
+				inputArgs[d],
+				&arguments->parameterStudyValues[d],
+				&arguments->parameterStudyNumberOfValues[d]) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The values of %s must be a real number, or a comma-separated list of real numbers and `start:stop:count` ranges.\n",
+				kInputVariableNames[d]);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isParameterStudyMode = true;
+		arguments->samplingDistributions[d] = (InputDistribution) {
+			.kind	= kInputDistributionKindConstant,
+			.value	= arguments->parameterStudyValues[d][0],
+		};
+	}
+
+	gammaArg = (arguments->parameterStudyValues[kInputDistributionIndexGamma] != NULL) ? NULL : gammaArg;
+	phiArg = (arguments->parameterStudyValues[kInputDistributionIndexPhi] != NULL) ? NULL : phiArg;
+	RsArg = (arguments->parameterStudyValues[kInputDistributionIndexRs] != NULL) ? NULL : RsArg;
+	GArg = (arguments->parameterStudyValues[kInputDistributionIndexG] != NULL) ? NULL : GArg;
+	bArg = (arguments->parameterStudyValues[kInputDistributionIndexB] != NULL) ? NULL : bArg;
+	MArg = (arguments->parameterStudyValues[kInputDistributionIndexM] != NULL) ? NULL : MArg;
+
 	if (gammaArg != NULL)
 	{
 		double gamma;
@@ -196,6 +833,10 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		}
 
 		arguments->gamma = gamma;
+		arguments->samplingDistributions[kInputDistributionIndexGamma] = (InputDistribution) {
+			.kind	= kInputDistributionKindConstant,
+			.value	= gamma,
+		};
 	}
 
 	if (phiArg != NULL)
@@ -223,6 +864,10 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		}
 
 		arguments->phi = phi;
+		arguments->samplingDistributions[kInputDistributionIndexPhi] = (InputDistribution) {
+			.kind	= kInputDistributionKindConstant,
+			.value	= phi,
+		};
 	}
 
 	if (RsArg != NULL)
@@ -250,6 +895,10 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		}
 
 		arguments->Rs = Rs;
+		arguments->samplingDistributions[kInputDistributionIndexRs] = (InputDistribution) {
+			.kind	= kInputDistributionKindConstant,
+			.value	= Rs,
+		};
 	}
 
 	if (GArg != NULL)
@@ -277,6 +926,10 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		}
 
 		arguments->G = G;
+		arguments->samplingDistributions[kInputDistributionIndexG] = (InputDistribution) {
+			.kind	= kInputDistributionKindConstant,
+			.value	= G,
+		};
 	}
 
 	if (bArg != NULL)
@@ -304,6 +957,10 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		}
 
 		arguments->b = b;
+		arguments->samplingDistributions[kInputDistributionIndexB] = (InputDistribution) {
+			.kind	= kInputDistributionKindConstant,
+			.value	= b,
+		};
 	}
 
 	if (MArg != NULL)
@@ -331,22 +988,631 @@ getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  argume
 		}
 
 		arguments->M = M;
+		arguments->samplingDistributions[kInputDistributionIndexM] = (InputDistribution) {
+			.kind	= kInputDistributionKindConstant,
+			.value	= M,
+		};
 	}
 
-	return kCommonConstantReturnTypeSuccess;
-}
+	if (traceSamplingIntervalArg != NULL)
+	{
+		size_t	traceSamplingInterval;
 
-void
-loadInputs(
-	double *		gamma,
-	double *		phi,
-	double *		Rs,
-	double *		G,
-	double *		b,
-	double *		M,
-	double *		inputDistributions,
-	CommandLineArguments *	arguments)
-{
+		int ret = parseSizeChecked(traceSamplingIntervalArg, &traceSamplingInterval);
+
+		if ((ret != kCommonConstantReturnTypeSuccess) || (traceSamplingInterval == 0))
+		{
+			fprintf(stderr, "Error: The trace sampling interval must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->traceSamplingInterval = traceSamplingInterval;
+	}
+
+	if (seedArg != NULL)
+	{
+		if (parseUint64Checked(seedArg, &arguments->seed) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The seed must be a non-negative integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (correlationsArg != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Correlated inputs require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (parseCorrelations(correlationsArg, arguments->correlationMatrix) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The correlations must be a list of `<input>:<input>=<correlation>` with correlations in (-1, 1).\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isCorrelatedSamplingEnabled = true;
+	}
+
+	if (alloySpecificationsArg != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Alloy specification batches require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isCorrelatedSamplingEnabled || arguments->isTraceDistributionsEnabled)
+		{
+			fprintf(stderr, "Error: Alloy specification batches cannot be combined with correlations or traced distributions.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isAlloyBatchMode = true;
+		arguments->alloySpecificationsFilePath = alloySpecificationsArg;
+	}
+
+	if (coarseningArg != NULL)
+	{
+		double	values[4];
+		size_t	numberOfValues;
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Coarsening mode requires Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isTraceDistributionsEnabled)
+		{
+			fprintf(stderr, "Error: Coarsening mode cannot be combined with alloy specification batches or traced distributions.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if ((parseColonSeparatedDoubles(coarseningArg, values, 4, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+			((numberOfValues != 2) && (numberOfValues != 4)) ||
+			!(values[0] > 0) || !(values[1] >= 2) || (values[1] != floor(values[1])) || (values[1] > SIZE_MAX) ||
+			((numberOfValues == 4) && !((values[2] >= 0) && (values[3] >= values[2]))))
+		{
+			fprintf(stderr, "Error: The coarsening schedule must be `<tEnd>:<steps>[:<kMin>:<kMax>]` with tEnd > 0, an integer steps >= 2, and 0 <= kMin <= kMax.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isCoarseningMode = true;
+		arguments->coarseningEndTime = values[0];
+		arguments->coarseningNumberOfTimeSteps = (size_t) values[1];
+		if (numberOfValues == 4)
+		{
+			arguments->coarseningRateMin = values[2];
+			arguments->coarseningRateMax = values[3];
+		}
+	}
+
+	if (temperatureSweepArg != NULL)
+	{
+		double	values[5];
+		size_t	numberOfValues;
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Temperature sweeps require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTraceDistributionsEnabled)
+		{
+			fprintf(stderr, "Error: Temperature sweeps cannot be combined with alloy specification batches, coarsening mode, or traced distributions.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if ((parseColonSeparatedDoubles(temperatureSweepArg, values, 5, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+			((numberOfValues != 3) && (numberOfValues != 5)) ||
+			!(values[0] > 0) || !(values[1] >= values[0]) ||
+			!(values[2] >= 1) || (values[2] != floor(values[2])) || (values[2] > SIZE_MAX) ||
+			((numberOfValues == 5) && !(values[4] >= values[3])))
+		{
+			fprintf(stderr, "Error: The temperature sweep must be `<Tmin>:<Tmax>:<count>[:<dGdTMin>:<dGdTMax>]` with 0 < Tmin <= Tmax, an integer count >= 1, and dGdTMin <= dGdTMax.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isTemperatureSweepMode = true;
+		arguments->temperatureSweepMin = values[0];
+		arguments->temperatureSweepMax = values[1];
+		arguments->temperatureSweepNumberOfTemperatures = (size_t) values[2];
+		if (numberOfValues == 5)
+		{
+			arguments->shearModulusSlopeMin = values[3];
+			arguments->shearModulusSlopeMax = values[4];
+		}
+	}
+
+	if (particleSizeDistributionArg != NULL)
+	{
+		const char	kLognormalPrefix[] = "lognormal:";
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Particle-size distributions require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode)
+		{
+			fprintf(stderr, "Error: Particle-size distributions cannot be combined with alloy specification batches, coarsening mode, or temperature sweeps.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (strncmp(particleSizeDistributionArg, kLognormalPrefix, strlen(kLognormalPrefix)) == 0)
+		{
+			double	values[2];
+			size_t	numberOfValues;
+
+			if ((parseColonSeparatedDoubles(particleSizeDistributionArg + strlen(kLognormalPrefix), values, 2, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+				!(values[0] >= 0) ||
+				((numberOfValues == 2) &&
+					(!(values[1] >= 1) || (values[1] > kParticleSizeDistributionMaximumNumberOfNodes) || (values[1] != floor(values[1])))))
+			{
+				fprintf(stderr, "Error: The lognormal particle-size distribution must be `lognormal:<shape>[:<nodes>]` with shape >= 0 and 1 <= nodes <= %d.\n",
+					kParticleSizeDistributionMaximumNumberOfNodes);
+				printUsage();
+
+				return kCommonConstantReturnTypeError;
+			}
+
+			arguments->particleSizeDistributionKind = kParticleSizeDistributionKindLognormal;
+			arguments->particleSizeDistributionShape = values[0];
+			if (numberOfValues == 2)
+			{
+				arguments->particleSizeDistributionNumberOfNodes = (size_t) values[1];
+			}
+		}
+		else
+		{
+			arguments->particleSizeDistributionKind = kParticleSizeDistributionKindEmpirical;
+			arguments->particleSizeDistributionFilePath = particleSizeDistributionArg;
+		}
+	}
+
+	if (runFileArg != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Run files require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode)
+		{
+			fprintf(stderr, "Error: Run files cannot be combined with alloy specification batches, coarsening mode, or temperature sweeps.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->runFilePath = runFileArg;
+	}
+
+	if (resultCacheArg != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: The result cache requires Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode || (arguments->runFilePath != NULL))
+		{
+			fprintf(stderr, "Error: The result cache cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, or run files.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->resultCacheDirectory = resultCacheArg;
+	}
+
+	if (isPartialsEnabled)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Partial derivatives require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			(arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone))
+		{
+			fprintf(stderr, "Error: Partial derivatives cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, or particle-size distributions.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isPartialsEnabled = true;
+	}
+
+	if (isIntervalMode)
+	{
+		if (arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Interval mode cannot be combined with Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isIntervalMode = true;
+	}
+
+	if (intervalTruncationSigmasArg != NULL)
+	{
+		double	truncationSigmas;
+
+		if (!arguments->isIntervalMode)
+		{
+			fprintf(stderr, "Error: Truncation of the Gaussian components requires interval mode (`-I`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if ((parseDoubleChecked(intervalTruncationSigmasArg, &truncationSigmas) != kCommonConstantReturnTypeSuccess) || !(truncationSigmas > 0))
+		{
+			fprintf(stderr, "Error: The truncation must be a positive number of standard deviations.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->intervalTruncationSigmas = truncationSigmas;
+	}
+
+	if ((polynomialChaosArg != NULL) || (polynomialChaosFileArg != NULL))
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Polynomial chaos expansions require Monte Carlo mode (`-M`) for the number of samples of the expansion.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			(arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone) ||
+			arguments->isCorrelatedSamplingEnabled || arguments->isTraceDistributionsEnabled || arguments->isPartialsEnabled ||
+			(arguments->runFilePath != NULL) || (arguments->resultCacheDirectory != NULL))
+		{
+			fprintf(stderr, "Error: Polynomial chaos expansions cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, particle-size distributions, correlations, traced distributions, partial derivatives, run files, or the result cache.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isPolynomialChaosMode = true;
+		arguments->polynomialChaosFilePath = polynomialChaosFileArg;
+	}
+
+	if (polynomialChaosArg != NULL)
+	{
+		double	values[2];
+		size_t	numberOfValues;
+
+		if ((parseColonSeparatedDoubles(polynomialChaosArg, values, 2, &numberOfValues) != kCommonConstantReturnTypeSuccess) ||
+			!(values[0] >= 1) || !(values[0] <= kPolynomialChaosMaximumDegree) || (values[0] != floor(values[0])) ||
+			((numberOfValues == 2) && !((values[1] > 0) && (values[1] <= 1))))
+		{
+			fprintf(stderr, "Error: The polynomial chaos expansion must be `<degree>[:<q>]` with an integer 1 <= degree <= %d and 0 < q <= 1.\n",
+				kPolynomialChaosMaximumDegree);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isPolynomialChaosFitEnabled = true;
+		arguments->polynomialChaosDegree = (size_t) values[0];
+		if (numberOfValues == 2)
+		{
+			arguments->polynomialChaosQNorm = values[1];
+		}
+	}
+
+	if (inputDistributionsArg != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode && !arguments->isIntervalMode)
+		{
+			fprintf(stderr, "Error: Setting input distributions requires Monte Carlo mode (`-M`) or interval mode (`-I`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode)
+		{
+			fprintf(stderr, "Error: Input distributions cannot be combined with alloy specification batches, which set their own.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (parseInputDistributions(inputDistributionsArg, arguments->samplingDistributions) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The input distributions must be a list of `<input>=<distribution>` with distributions `constant:<v>`, `uniform:<min>:<max>` with min < max, `gauss:<mean>:<sd>`, `mixture:<weight>:<mean>:<sd>:...`, or `mixture-file:<path>` with one `<weight>,<mean>,<sd>` line per component, with at most %d components, positive standard deviations, and weights that sum to one, optionally as `truncated:<lower>:<upper>:<distribution>` with lower < upper and a range that the distribution puts probability in.\n",
+				kInputDistributionMaximumMixtureComponents);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((jointSamplesArg != NULL) || (reweightingArg != NULL))
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Joint sample files require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			(arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone) ||
+			arguments->isCorrelatedSamplingEnabled || arguments->isPolynomialChaosMode ||
+			(arguments->runFilePath != NULL) || (arguments->resultCacheDirectory != NULL))
+		{
+			fprintf(stderr, "Error: Joint sample files cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, particle-size distributions, correlations, polynomial chaos expansions, run files, or the result cache.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->jointSamplesFilePath = jointSamplesArg;
+	}
+
+	if (reweightingArg != NULL)
+	{
+		if (arguments->isTraceDistributionsEnabled || arguments->isPartialsEnabled)
+		{
+			fprintf(stderr, "Error: Reweighting cannot be combined with traced distributions or partial derivatives.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isReweightingMode = true;
+		arguments->reweightingFilePath = reweightingArg;
+	}
+
+	if (isParameterDerivativesEnabled)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Parameter derivatives require Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			(arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone) ||
+			arguments->isPolynomialChaosMode || arguments->isReweightingMode ||
+			(arguments->runFilePath != NULL) || (arguments->resultCacheDirectory != NULL))
+		{
+			fprintf(stderr, "Error: Parameter derivatives cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, particle-size distributions, polynomial chaos expansions, reweighting, run files, or the result cache.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+		{
+			if (arguments->samplingDistributions[i].isTruncated)
+			{
+				fprintf(stderr, "Error: Parameter derivatives do not support truncated input distributions.\n");
+
+				return kCommonConstantReturnTypeError;
+			}
+		}
+
+		arguments->isParameterDerivativesEnabled = true;
+	}
+
+	if (outOfCoreArg != NULL)
+	{
+		char		memoryLimitString[32];
+		const char *	separator = strchr(outOfCoreArg, ':');
+		size_t		length = (separator != NULL) ? (size_t) (separator - outOfCoreArg) : strlen(outOfCoreArg);
+		double		memoryLimitMiB;
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Out-of-core mode requires Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			arguments->isPolynomialChaosMode || arguments->isReweightingMode || (arguments->jointSamplesFilePath != NULL) ||
+			arguments->isTraceDistributionsEnabled || arguments->isPartialsEnabled || arguments->isParameterDerivativesEnabled ||
+			(arguments->runFilePath != NULL) || (arguments->resultCacheDirectory != NULL))
+		{
+			fprintf(stderr, "Error: Out-of-core mode cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, polynomial chaos expansions, joint sample files, traced distributions, partial or parameter derivatives, run files, or the result cache.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (length < sizeof(memoryLimitString))
+		{
+			memcpy(memoryLimitString, outOfCoreArg, length);
+			memoryLimitString[length] = '\0';
+		}
+
+		if ((length >= sizeof(memoryLimitString)) ||
+			(parseDoubleChecked(memoryLimitString, &memoryLimitMiB) != kCommonConstantReturnTypeSuccess) ||
+			!(memoryLimitMiB >= 1) || (memoryLimitMiB != floor(memoryLimitMiB)) ||
+			((separator != NULL) && (separator[1] == '\0')))
+		{
+			fprintf(stderr, "Error: The out-of-core mode must be `<memory limit in MiB>[:<directory>]` with an integer limit of at least 1 MiB.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isOutOfCoreMode = true;
+		arguments->outOfCoreMemoryLimit = (size_t) memoryLimitMiB << 20;
+		arguments->outOfCoreDirectory = (separator != NULL) ? (separator + 1) : kExternalSortDefaultDirectory;
+	}
+
+	if (isRegimeSwitchingEnabled)
+	{
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: Switching between pair-coupling regimes requires Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			(arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone) ||
+			arguments->isPolynomialChaosMode || arguments->isReweightingMode || arguments->isOutOfCoreMode ||
+			arguments->isTraceDistributionsEnabled || arguments->isPartialsEnabled || arguments->isParameterDerivativesEnabled ||
+			(arguments->resultCacheDirectory != NULL))
+		{
+			fprintf(stderr, "Error: Switching between pair-coupling regimes cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, particle-size distributions, polynomial chaos expansions, reweighting, out-of-core mode, traced distributions, partial or parameter derivatives, or the result cache.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isRegimeSwitchingEnabled = true;
+	}
+
+	if (outputDomainPolicyArg != NULL)
+	{
+		const char * const	kPolicyNames[] = {
+						[kOutputDomainPolicyKeep]	= "keep",
+						[kOutputDomainPolicyDrop]	= "drop",
+						[kOutputDomainPolicyClamp]	= "clamp",
+						[kOutputDomainPolicyAbort]	= "abort",
+					};
+		size_t			policy = 0;
+
+		while ((policy < sizeof(kPolicyNames) / sizeof(kPolicyNames[0])) && (strcmp(outputDomainPolicyArg, kPolicyNames[policy]) != 0))
+		{
+			policy++;
+		}
+
+		if (policy == sizeof(kPolicyNames) / sizeof(kPolicyNames[0]))
+		{
+			fprintf(stderr, "Error: The domain policy must be `keep`, `drop`, `clamp`, or `abort`.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: A domain policy requires Monte Carlo mode (`-M`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			arguments->isPolynomialChaosMode || arguments->isReweightingMode || arguments->isOutOfCoreMode ||
+			arguments->isParameterStudyMode)
+		{
+			fprintf(stderr, "Error: A domain policy cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, polynomial chaos expansions, reweighting, out-of-core mode, or parameter studies.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->outputDomainPolicy = (OutputDomainPolicy) policy;
+	}
+
+	if (isParameterStudyZipped && !arguments->isParameterStudyMode)
+	{
+		fprintf(stderr, "Error: Zipping (`-Z`) requires inputs given as lists or ranges of values.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+	arguments->isParameterStudyZipped = isParameterStudyZipped;
+
+	if (arguments->isParameterStudyMode)
+	{
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			(arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone) ||
+			arguments->isIntervalMode || arguments->isPolynomialChaosMode || arguments->isReweightingMode || arguments->isOutOfCoreMode ||
+			arguments->isTraceDistributionsEnabled || arguments->isPartialsEnabled || arguments->isParameterDerivativesEnabled ||
+			arguments->isRegimeSwitchingEnabled || (arguments->runFilePath != NULL) || (arguments->resultCacheDirectory != NULL) ||
+			(arguments->jointSamplesFilePath != NULL) || arguments->common.isVerbose || arguments->common.isInputFromFileEnabled)
+		{
+			fprintf(stderr, "Error: Inputs given as lists or ranges of values cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, particle-size distributions, interval mode, polynomial chaos expansions, reweighting, out-of-core mode, traced distributions, partial or parameter derivatives, pair-coupling regimes, run files, the result cache, joint sample files, verbose mode, or input files.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (parameterStudyGetNumberOfPoints(arguments) == 0)
+		{
+			fprintf(stderr, "Error: Zipped lists of values must have the same length, and a Cartesian product can have at most %" PRIu64 " points.\n",
+				kParameterStudyMaximumNumberOfPoints);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (voxelFieldArg != NULL)
+	{
+		if (!arguments->common.isMonteCarloMode || !arguments->common.isWriteToFileEnabled)
+		{
+			fprintf(stderr, "Error: Voxel mode requires Monte Carlo mode (`-M`), for the shared samples of the other inputs, and an output volume (`-o`).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->isAlloyBatchMode || arguments->isCoarseningMode || arguments->isTemperatureSweepMode ||
+			(arguments->particleSizeDistributionKind != kParticleSizeDistributionKindNone) ||
+			arguments->isIntervalMode || arguments->isPolynomialChaosMode || arguments->isReweightingMode || arguments->isOutOfCoreMode ||
+			arguments->isParameterStudyMode || arguments->isTraceDistributionsEnabled || arguments->isPartialsEnabled ||
+			arguments->isParameterDerivativesEnabled || arguments->isRegimeSwitchingEnabled ||
+			(arguments->outputDomainPolicy != kOutputDomainPolicyKeep) || (arguments->runFilePath != NULL) ||
+			(arguments->resultCacheDirectory != NULL) || (arguments->jointSamplesFilePath != NULL) ||
+			arguments->common.isVerbose || arguments->common.isInputFromFileEnabled)
+		{
+			fprintf(stderr, "Error: Voxel mode cannot be combined with alloy specification batches, coarsening mode, temperature sweeps, particle-size distributions, interval mode, polynomial chaos expansions, reweighting, out-of-core mode, parameter studies, traced distributions, partial or parameter derivatives, pair-coupling regimes, domain policies, run files, the result cache, joint sample files, verbose mode, or input files.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (parseVoxelFieldArgument(voxelFieldArg, arguments) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The voxel mode must be `<phi volume>:<Rs volume>[:float32|float64]`.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+loadInputs(
+	double *		gamma,
+	double *		phi,
+	double *		Rs,
+	double *		G,
+	double *		b,
+	double *		M,
+	double *		inputDistributions,
+	CommandLineArguments *	arguments)
+{
 	if (arguments->common.isInputFromFileEnabled)
 	{
 		*b	= inputDistributions[kInputDistributionIndexB];
@@ -369,46 +1635,231 @@ loadInputs(
 	return;
 }
 
+static char * const	kPartialJSONSymbols[kBrownHamModelPartialIndexMax] = {
+				[kBrownHamModelPartialIndexGamma]	= "dSigmaCMpa_dgamma",
+				[kBrownHamModelPartialIndexPhi]		= "dSigmaCMpa_dphi",
+				[kBrownHamModelPartialIndexRs]		= "dSigmaCMpa_dRs",
+				[kBrownHamModelPartialIndexG]		= "dSigmaCMpa_dG",
+				[kBrownHamModelPartialIndexB]		= "dSigmaCMpa_db",
+				[kBrownHamModelPartialIndexM]		= "dSigmaCMpa_dM",
+			};
+
+static char * const	kPartialJSONDescriptions[kBrownHamModelPartialIndexMax] = {
+				[kBrownHamModelPartialIndexGamma]	= "∂σc/∂γ (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+				[kBrownHamModelPartialIndexPhi]		= "∂σc/∂φ (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+				[kBrownHamModelPartialIndexRs]		= "∂σc/∂Rs (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+				[kBrownHamModelPartialIndexG]		= "∂σc/∂G (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+				[kBrownHamModelPartialIndexB]		= "∂σc/∂b (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+				[kBrownHamModelPartialIndexM]		= "∂σc/∂M (mean, standard deviation, 5th, 50th, and 95th percentiles)",
+			};
+
 void
 printJSONFormattedOutput(
-	double			sigmaCMpa,
-	double			cpuTimeUsedInSeconds,
-	CommandLineArguments *	arguments)
+	double				sigmaCMpa,
+	double				cpuTimeUsedInSeconds,
+	const StreamingHistogram *	partialDistributions,
+	const ParameterDerivative *	parameterDerivatives,
+	size_t				numberOfParameterDerivatives,
+	const double *			regimeFractions,
+	const uint64_t *		domainViolations,
+	CommandLineArguments *		arguments)
 {
+	JSONVariable	variables[4 + kBrownHamModelPartialIndexMax + kMaximumNumberOfParameterDerivatives];
+	double		partialStatistics[kBrownHamModelPartialIndexMax][5];
+	char		parameterDerivativeSymbols[kMaximumNumberOfParameterDerivatives][64];
+	size_t		numberOfVariables = 0;
+
+	variables[numberOfVariables++] = (JSONVariable) {
+		.variableSymbol = "sigmaCMpa",
+		.variableDescription = "Cutting stress (σc)",
+		.values = (JSONVariablePointer) { .asDouble = &sigmaCMpa},
+		.type = kJSONVariableTypeDouble,
+		.size = 1,
+	};
+
 	if (arguments->common.isTimingEnabled)
 	{
-		JSONVariable variables[2] = {
-			{
-				.variableSymbol = "sigmaCMpa",
-				.variableDescription = "Cutting stress (σc)",
-				.values = (JSONVariablePointer) { .asDouble = &sigmaCMpa},
-				.type = kJSONVariableTypeDouble,
-				.size = 1,
-			},
-			{
-				.variableSymbol = "cpuTimeUsed",
-				.variableDescription = "CPU time used (s)",
-				.values = (JSONVariablePointer) { .asDouble = &cpuTimeUsedInSeconds},
-				.type = kJSONVariableTypeDoubleParticle,
-				.size = 1,
-			}
+		variables[numberOfVariables++] = (JSONVariable) {
+			.variableSymbol = "cpuTimeUsed",
+			.variableDescription = "CPU time used (s)",
+			.values = (JSONVariablePointer) { .asDouble = &cpuTimeUsedInSeconds},
+			.type = kJSONVariableTypeDoubleParticle,
+			.size = 1,
 		};
+	}
 
-		printJSONVariables(variables, 2, "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	if (partialDistributions != NULL)
+	{
+		for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+		{
+			partialStatistics[j][0] = partialDistributions[j].mean;
+			partialStatistics[j][1] = sqrt(streamingHistogramVariance(&partialDistributions[j]));
+			partialStatistics[j][2] = streamingHistogramQuantile(&partialDistributions[j], 0.05);
+			partialStatistics[j][3] = streamingHistogramQuantile(&partialDistributions[j], 0.50);
+			partialStatistics[j][4] = streamingHistogramQuantile(&partialDistributions[j], 0.95);
+
+			variables[numberOfVariables++] = (JSONVariable) {
+				.variableSymbol = kPartialJSONSymbols[j],
+				.variableDescription = kPartialJSONDescriptions[j],
+				.values = (JSONVariablePointer) { .asDouble = partialStatistics[j]},
+				.type = kJSONVariableTypeDouble,
+				.size = 5,
+			};
+		}
 	}
-	else
+
+	if (parameterDerivatives != NULL)
 	{
-		JSONVariable variables[1] = {
-			{
-				.variableSymbol = "sigmaCMpa",
-				.variableDescription = "Cutting stress (σc)",
-				.values = (JSONVariablePointer) { .asDouble = &sigmaCMpa},
+		for (size_t j = 0; j < numberOfParameterDerivatives; j++)
+		{
+			snprintf(parameterDerivativeSymbols[j], sizeof(parameterDerivativeSymbols[j]), "dMeanSigmaCMpa_d%s%s",
+				kInputVariableNames[parameterDerivatives[j].inputIndex], parameterDerivatives[j].parameterName);
+
+			variables[numberOfVariables++] = (JSONVariable) {
+				.variableSymbol = parameterDerivativeSymbols[j],
+				.variableDescription = "Derivative of the mean of σc with respect to a parameter of an input distribution (estimate, standard error)",
+				.values = (JSONVariablePointer) { .asDouble = (double *) parameterDerivatives[j].values},
 				.type = kJSONVariableTypeDouble,
-				.size = 1,
-			}
+				.size = 2,
+			};
+		}
+	}
+
+	if (regimeFractions != NULL)
+	{
+		variables[numberOfVariables++] = (JSONVariable) {
+			.variableSymbol = "couplingRegimeFractions",
+			.variableDescription = "Fractions of the samples with weakly and strongly coupled pairs",
+			.values = (JSONVariablePointer) { .asDouble = (double *) regimeFractions},
+			.type = kJSONVariableTypeDouble,
+			.size = 2,
+		};
+	}
+
+	if (domainViolations != NULL)
+	{
+		variables[numberOfVariables++] = (JSONVariable) {
+			.variableSymbol = "outputDomainViolations",
+			.variableDescription = "Numbers of non-finite and of negative outputs",
+			.values = (JSONVariablePointer) { .asUint64 = (uint64_t *) domainViolations},
+			.type = kJSONVariableTypeUint64,
+			.size = 2,
 		};
-		printJSONVariables(variables, 1, "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+	}
+
+	printJSONVariables(variables, numberOfVariables, "Precipitate \\\"cutting\\\" dislocation model from Brown and Ham");
+
+	return;
+}
+
+void
+printPartialDistributions(
+	const StreamingHistogram *	partialDistributions,
+	FILE *				stream)
+{
+	const char * const	kPartialNames[kBrownHamModelPartialIndexMax] = {
+					[kBrownHamModelPartialIndexGamma]	= "dSigmaCMpa/dgamma",
+					[kBrownHamModelPartialIndexPhi]		= "dSigmaCMpa/dphi",
+					[kBrownHamModelPartialIndexRs]		= "dSigmaCMpa/dRs",
+					[kBrownHamModelPartialIndexG]		= "dSigmaCMpa/dG",
+					[kBrownHamModelPartialIndexB]		= "dSigmaCMpa/db",
+					[kBrownHamModelPartialIndexM]		= "dSigmaCMpa/dM",
+				};
+
+	fprintf(stream, "Partial derivatives:\n");
+	streamingHistogramPrintSummaryHeader(stream, "partial", false);
+	for (size_t j = 0; j < kBrownHamModelPartialIndexMax; j++)
+	{
+		streamingHistogramPrintSummaryRow(stream, kPartialNames[j], &partialDistributions[j], false);
+	}
+
+	return;
+}
+
+void
+printParameterDerivatives(
+	const ParameterDerivative *	parameterDerivatives,
+	size_t				numberOfParameterDerivatives,
+	FILE *				stream)
+{
+	fprintf(stream, "Derivatives of the mean cutting stress with respect to the input distribution parameters:\n");
+	fprintf(stream, "%-32s %14s %14s\n", "parameter", "derivative", "standardError");
+	for (size_t j = 0; j < numberOfParameterDerivatives; j++)
+	{
+		char	name[64];
+
+		snprintf(name, sizeof(name), "%s%s", kInputVariableNames[parameterDerivatives[j].inputIndex], parameterDerivatives[j].parameterName);
+		fprintf(stream, "%-32s %14le %14le\n", name, parameterDerivatives[j].values[0], parameterDerivatives[j].values[1]);
 	}
 
 	return;
 }
+
+static const char * const	kTraceDistributionNames[kTraceDistributionIndexMax] = {
+					[kTraceDistributionIndexGamma]		= "gamma",
+					[kTraceDistributionIndexPhi]		= "phi",
+					[kTraceDistributionIndexRs]		= "Rs",
+					[kTraceDistributionIndexG]		= "G",
+					[kTraceDistributionIndexB]		= "b",
+					[kTraceDistributionIndexM]		= "M",
+					[kTraceDistributionIndexPrefactor]	= "prefactor",
+					[kTraceDistributionIndexSqrtArgument]	= "sqrtArgument",
+					[kTraceDistributionIndexBracket]	= "bracket",
+					[kTraceDistributionIndexSigma]		= "sigmaCMpa",
+				};
+
+void
+printTraceDistributions(
+	const StreamingHistogram *	traceDistributions,
+	FILE *				stream)
+{
+	fprintf(stream, "Traced distributions:\n");
+	fprintf(stream, "%-14s %12s %14s %14s %14s %14s %14s %14s %14s\n",
+		"variable", "count", "mean", "stddev", "min", "p05", "p50", "p95", "max");
+
+	for (size_t i = 0; i < kTraceDistributionIndexMax; i++)
+	{
+		const StreamingHistogram *	histogram = &traceDistributions[i];
+
+		fprintf(stream, "%-14s %12" PRIu64 " %14le %14le %14le %14le %14le %14le %14le\n",
+			kTraceDistributionNames[i],
+			histogram->count,
+			histogram->mean,
+			sqrt(streamingHistogramVariance(histogram)),
+			histogram->min,
+			streamingHistogramQuantile(histogram, 0.05),
+			streamingHistogramQuantile(histogram, 0.50),
+			streamingHistogramQuantile(histogram, 0.95),
+			histogram->max);
+
+		if (histogram->nonFiniteCount > 0)
+		{
+			fprintf(stream, "%-14s %12" PRIu64 " non-finite samples excluded\n", "", histogram->nonFiniteCount);
+		}
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+saveTraceDistributionsToTracesDotOutFile(const StreamingHistogram *  traceDistributions)
+{
+	FILE *	file = fopen("traces.out", "w");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"traces.out\" for writing.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; i < kTraceDistributionIndexMax; i++)
+	{
+		fprintf(file, "# %s %" PRIu64 "\n", kTraceDistributionNames[i], traceDistributions[i].count);
+		streamingHistogramWriteBins(&traceDistributions[i], file);
+	}
+
+	fclose(file);
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -26,6 +26,10 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include "common.h"
+#include "histogram.h"
+#include "sampling.h"
+#include "particleSizeDistribution.h"
+#include "brownHamModel.h"
 
 
 #define	kDemoSpecificConstantGammaUniformMin				(0.15)
@@ -42,6 +46,11 @@
 #define	kDemoSpecificConstantB						(2.54E-10)
 #define	kDemoSpecificConstantMUniformMin				(1.9)
 #define	kDemoSpecificConstantMUniformMax				(4.1)
+#define	kDemoSpecificConstantCoarseningRateUniformMin			(5E-29)
+#define	kDemoSpecificConstantCoarseningRateUniformMax			(2E-28)
+#define	kDemoSpecificConstantReferenceTemperature			(293.0)
+#define	kDemoSpecificConstantShearModulusSlopeUniformMin		(-2.5E7)
+#define	kDemoSpecificConstantShearModulusSlopeUniformMax		(-1.5E7)
 
 typedef enum
 {
@@ -60,6 +69,55 @@ typedef enum
 	kOutputDistributionIndexMax,
 } OutputDistributionIndex;
 
+typedef enum
+{
+	kTraceDistributionIndexGamma	= 0,
+	kTraceDistributionIndexPhi,
+	kTraceDistributionIndexRs,
+	kTraceDistributionIndexG,
+	kTraceDistributionIndexB,
+	kTraceDistributionIndexM,
+	kTraceDistributionIndexPrefactor,
+	kTraceDistributionIndexSqrtArgument,
+	kTraceDistributionIndexBracket,
+	kTraceDistributionIndexSigma,
+	kTraceDistributionIndexMax,
+} TraceDistributionIndex;
+
+/*
+ *	What to do with outputs outside the physical domain of `σc`: non-finite
+ *	outputs (e.g., from a negative square-root argument) and negative stresses.
+ */
+typedef enum
+{
+	kOutputDomainPolicyKeep	= 0,
+	kOutputDomainPolicyDrop,
+	kOutputDomainPolicyClamp,
+	kOutputDomainPolicyAbort,
+} OutputDomainPolicy;
+
+/*
+ *	Element type of the raw volume files of voxel mode.
+ */
+typedef enum
+{
+	kVoxelFieldElementTypeFloat32	= 0,
+	kVoxelFieldElementTypeFloat64,
+} VoxelFieldElementType;
+
+#define	kMaximumNumberOfParameterDerivatives	(kInputDistributionIndexMax * 3 * kInputDistributionMaximumMixtureComponents)
+
+/*
+ *	Derivative of the mean output with respect to one parameter of the
+ *	distribution of one input, with its Monte Carlo standard error.
+ */
+typedef struct ParameterDerivative
+{
+	InputDistributionIndex	inputIndex;
+	char			parameterName[32];
+	double			values[2];
+} ParameterDerivative;
+
 typedef struct CommandLineArguments
 {
 	CommonCommandLineArguments	common;
@@ -69,6 +127,56 @@ typedef struct CommandLineArguments
 	double				G;
 	double				b;
 	double				M;
+	size_t				traceSamplingInterval;
+	bool				isTraceDistributionsEnabled;
+	InputDistribution		samplingDistributions[kInputDistributionIndexMax];
+	uint64_t			seed;
+	bool				isCorrelatedSamplingEnabled;
+	double				correlationMatrix[kInputDistributionIndexMax][kInputDistributionIndexMax];
+	bool				isAlloyBatchMode;
+	const char *			alloySpecificationsFilePath;
+	bool				isCoarseningMode;
+	double				coarseningEndTime;
+	size_t				coarseningNumberOfTimeSteps;
+	double				coarseningRateMin;
+	double				coarseningRateMax;
+	bool				isTemperatureSweepMode;
+	double				temperatureSweepMin;
+	double				temperatureSweepMax;
+	size_t				temperatureSweepNumberOfTemperatures;
+	double				shearModulusSlopeMin;
+	double				shearModulusSlopeMax;
+	ParticleSizeDistributionKind	particleSizeDistributionKind;
+	double				particleSizeDistributionShape;
+	size_t				particleSizeDistributionNumberOfNodes;
+	const char *			particleSizeDistributionFilePath;
+	const char *			runFilePath;
+	const char *			resultCacheDirectory;
+	bool				isPartialsEnabled;
+	bool				isIntervalMode;
+	double				intervalTruncationSigmas;
+	bool				isPolynomialChaosMode;
+	bool				isPolynomialChaosFitEnabled;
+	size_t				polynomialChaosDegree;
+	double				polynomialChaosQNorm;
+	const char *			polynomialChaosFilePath;
+	const char *			jointSamplesFilePath;
+	bool				isReweightingMode;
+	const char *			reweightingFilePath;
+	bool				isParameterDerivativesEnabled;
+	bool				isOutOfCoreMode;
+	size_t				outOfCoreMemoryLimit;
+	const char *			outOfCoreDirectory;
+	bool				isRegimeSwitchingEnabled;
+	OutputDomainPolicy		outputDomainPolicy;
+	bool				isParameterStudyMode;
+	bool				isParameterStudyZipped;
+	double *			parameterStudyValues[kInputDistributionIndexMax];
+	size_t				parameterStudyNumberOfValues[kInputDistributionIndexMax];
+	bool				isVoxelFieldMode;
+	const char *			voxelFieldPhiPath;
+	const char *			voxelFieldRsPath;
+	VoxelFieldElementType		voxelFieldElementType;
 } CommandLineArguments;
 
 /**
@@ -121,9 +229,64 @@ void	loadInputs(
  *
  *	@param	sigmaCMpa		: The cutting stress output of the application.
  *	@param	cpuTimeUsedInSeconds	: The measured CPU time in seconds.
+ *	@param	partialDistributions	: Array of `kBrownHamModelPartialIndexMax` histograms of the partial
+ *					  derivatives of the output, or NULL to leave them out.
+ *	@param	parameterDerivatives	: Array of derivatives of the mean output with respect to the
+ *					  parameters of the input distributions, or NULL to leave them out.
+ *	@param	numberOfParameterDerivatives	: Number of entries in `parameterDerivatives`.
+ *	@param	regimeFractions		: Fractions of the samples with weakly and strongly coupled pairs, or NULL to leave them out.
+ *	@param	domainViolations	: Numbers of non-finite and of negative outputs, or NULL to leave them out.
  *	@param	arguments		: Pointer to struct that stores command-line arguments.
  */
 void	printJSONFormattedOutput(
-		double			sigmaCMpa,
-		double			cpuTimeUsedInSeconds,
-		CommandLineArguments *	arguments);
+		double				sigmaCMpa,
+		double				cpuTimeUsedInSeconds,
+		const StreamingHistogram *	partialDistributions,
+		const ParameterDerivative *	parameterDerivatives,
+		size_t				numberOfParameterDerivatives,
+		const double *			regimeFractions,
+		const uint64_t *		domainViolations,
+		CommandLineArguments *		arguments);
+
+/**
+ *	@brief	Print a summary of the distributions of the partial derivatives of the output
+ *		with respect to each input.
+ *
+ *	@param	partialDistributions	: Array of `kBrownHamModelPartialIndexMax` histograms indexed by `BrownHamModelPartialIndex`.
+ *	@param	stream			: Stream to print to.
+ */
+void	printPartialDistributions(
+		const StreamingHistogram *	partialDistributions,
+		FILE *				stream);
+
+/**
+ *	@brief	Print the derivatives of the mean output with respect to the parameters of the
+ *		input distributions, with their standard errors.
+ *
+ *	@param	parameterDerivatives		: Array of derivatives.
+ *	@param	numberOfParameterDerivatives	: Number of entries in `parameterDerivatives`.
+ *	@param	stream				: Stream to print to.
+ */
+void	printParameterDerivatives(
+		const ParameterDerivative *	parameterDerivatives,
+		size_t				numberOfParameterDerivatives,
+		FILE *				stream);
+
+/**
+ *	@brief	Print a summary of the traced input, intermediate, and output distributions.
+ *
+ *	@param	traceDistributions	: Array of `kTraceDistributionIndexMax` histograms indexed by `TraceDistributionIndex`.
+ *	@param	stream			: Stream to print to.
+ */
+void	printTraceDistributions(
+		const StreamingHistogram *	traceDistributions,
+		FILE *				stream);
+
+/**
+ *	@brief	Save the histograms of the traced distributions to "traces.out". Each histogram
+ *		starts with a `# <variable> <count>` line followed by its bins.
+ *
+ *	@param	traceDistributions	: Array of `kTraceDistributionIndexMax` histograms indexed by `TraceDistributionIndex`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	saveTraceDistributionsToTracesDotOutFile(const StreamingHistogram *  traceDistributions);
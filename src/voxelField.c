@@ -0,0 +1,480 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "voxelField.h"
+#include "histogram.h"
+#include "sampling.h"
+#include "common.h"
+
+
+static const size_t	kVoxelFieldElementSizes[] = {
+				[kVoxelFieldElementTypeFloat32]	= sizeof(float),
+				[kVoxelFieldElementTypeFloat64]	= sizeof(double),
+			};
+
+/*
+ *	A raw volume file mapped into memory.
+ */
+typedef struct VoxelFieldVolume
+{
+	void *	mapping;
+	size_t	mappingSize;
+} VoxelFieldVolume;
+
+/*
+ *	Map a raw input volume into memory, read-only.
+ */
+static CommonConstantReturnType
+mapVoxelFieldInput(const char *  path, VoxelFieldVolume *  volume)
+{
+	int		fileDescriptor;
+	struct stat	status;
+
+	volume->mapping = NULL;
+	fileDescriptor = open(path, O_RDONLY);
+	if ((fileDescriptor < 0) || (fstat(fileDescriptor, &status) != 0) || (status.st_size == 0))
+	{
+		fprintf(stderr, "Error: Could not open \"%s\", or it is empty.\n", path);
+		if (fileDescriptor >= 0)
+		{
+			close(fileDescriptor);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	volume->mappingSize = (size_t) status.st_size;
+	volume->mapping = mmap(NULL, volume->mappingSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	close(fileDescriptor);
+	if (volume->mapping == MAP_FAILED)
+	{
+		fprintf(stderr, "Error: Could not map \"%s\" into memory.\n", path);
+		volume->mapping = NULL;
+
+		return kCommonConstantReturnTypeError;
+	}
+	madvise(volume->mapping, volume->mappingSize, MADV_SEQUENTIAL);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Create a raw output volume of `size` bytes and map it into memory, writable.
+ */
+static CommonConstantReturnType
+mapVoxelFieldOutput(const char *  path, size_t size, VoxelFieldVolume *  volume)
+{
+	int	fileDescriptor;
+
+	volume->mapping = NULL;
+	fileDescriptor = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if ((fileDescriptor < 0) || (ftruncate(fileDescriptor, (off_t) size) != 0))
+	{
+		fprintf(stderr, "Error: Could not create the output volume \"%s\".\n", path);
+		if (fileDescriptor >= 0)
+		{
+			close(fileDescriptor);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	volume->mappingSize = size;
+	volume->mapping = mmap(NULL, volume->mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+	close(fileDescriptor);
+	if (volume->mapping == MAP_FAILED)
+	{
+		fprintf(stderr, "Error: Could not map \"%s\" into memory.\n", path);
+		volume->mapping = NULL;
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static void
+unmapVoxelFieldVolume(VoxelFieldVolume *  volume)
+{
+	if (volume->mapping != NULL)
+	{
+		munmap(volume->mapping, volume->mappingSize);
+		volume->mapping = NULL;
+	}
+
+	return;
+}
+
+/*
+ *	Convert `count` elements of a volume, from element `first` on, to doubles.
+ */
+static void
+loadVoxelTile(const void *  mapping, VoxelFieldElementType elementType, size_t first, size_t count, double *  values)
+{
+	const float *	elements = (const float *) mapping + first;
+
+	if (elementType == kVoxelFieldElementTypeFloat64)
+	{
+		memcpy(values, (const double *) mapping + first, count * sizeof(double));
+
+		return;
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		values[i] = elements[i];
+	}
+
+	return;
+}
+
+/*
+ *	Convert `count` doubles to elements of a volume, from element `first` on.
+ */
+static void
+storeVoxelTile(void *  mapping, VoxelFieldElementType elementType, size_t first, size_t count, const double *  values)
+{
+	float *	elements = (float *) mapping + first;
+
+	if (elementType == kVoxelFieldElementTypeFloat64)
+	{
+		memcpy((double *) mapping + first, values, count * sizeof(double));
+
+		return;
+	}
+
+	#pragma omp simd
+	for (size_t i = 0; i < count; i++)
+	{
+		elements[i] = (float) values[i];
+	}
+
+	return;
+}
+
+/*
+ *	With `gamma`, `G`, `b`, and `M` fixed, the model is `σc = a (k √(φ Rs) - φ)`, with
+ *	`a = M γ / (2 b 10⁶)` and `k = √(8 γ / (π G b²))`. Draw the shared samples of these
+ *	inputs, from the same streams as a Monte Carlo run, and store `a` and `k` for each.
+ */
+static CommonConstantReturnType
+drawVoxelFieldSharedSamples(const CommandLineArguments *  arguments, double *  a, double *  k)
+{
+	InputSampler		sampler;
+	InputSampleBlock *	block;
+	size_t			numberOfSamples = arguments->common.numberOfMonteCarloIterations;
+	size_t			numberOfBlocks = (numberOfSamples + kInputSampleBlockSize - 1) / kInputSampleBlockSize;
+	bool			isFinite = true;
+
+	if (inputSamplerInit(
+			&sampler,
+			arguments->samplingDistributions,
+			kInputDistributionIndexMax,
+			arguments->isCorrelatedSamplingEnabled ? &arguments->correlationMatrix[0][0] : NULL) != kCommonConstantReturnTypeSuccess)
+	{
+		fprintf(stderr, "Error: The correlation matrix is not positive definite.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	block = (InputSampleBlock *) checkedMalloc(sizeof(InputSampleBlock), __FILE__, __LINE__);
+	for (size_t blockIndex = 0; blockIndex < numberOfBlocks; blockIndex++)
+	{
+		SamplerRandomNumberGenerator	generator;
+		size_t				first = blockIndex * kInputSampleBlockSize;
+		size_t				count = (numberOfSamples - first < kInputSampleBlockSize) ? (numberOfSamples - first) : kInputSampleBlockSize;
+		double (*			values)[kInputSampleBlockSize] = block->values;
+
+		samplerRandomNumberGeneratorInit(&generator, arguments->seed, blockIndex);
+		inputSamplerFillBlock(&sampler, &generator, block, count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			double	gamma = values[kInputDistributionIndexGamma][i];
+			double	G = values[kInputDistributionIndexG][i];
+			double	b = values[kInputDistributionIndexB][i];
+			double	M = values[kInputDistributionIndexM][i];
+
+			a[first + i] = (M * gamma) / (2.0 * b) / 1000000;
+			k[first + i] = sqrt((8.0 * gamma) / (M_PI * G * pow(b, 2)));
+			isFinite = isFinite && isfinite(a[first + i]) && isfinite(k[first + i]);
+		}
+	}
+	free(block);
+
+	if (!isFinite)
+	{
+		fprintf(stderr, "Error: In voxel mode, every shared sample of `gamma`, `G`, `b`, and `M` must give a finite σc for valid `phi` and `Rs`, i.e., a nonzero `b` and a non-negative, finite 8γ/(πGb²).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+parseVoxelFieldArgument(const char *  string, CommandLineArguments *  arguments)
+{
+	size_t	length = strlen(string);
+	char *	copy = (char *) checkedMalloc(length + 1, __FILE__, __LINE__);
+	char *	RsPath;
+	char *	elementType;
+
+	/*
+	 *	The paths point into `copy`, which lives as long as the arguments.
+	 */
+	memcpy(copy, string, length + 1);
+	RsPath = strchr(copy, ':');
+	if ((RsPath == NULL) || (RsPath == copy) || (RsPath[1] == '\0'))
+	{
+		free(copy);
+
+		return kCommonConstantReturnTypeError;
+	}
+	*RsPath++ = '\0';
+
+	arguments->voxelFieldElementType = kVoxelFieldElementTypeFloat32;
+	elementType = strchr(RsPath, ':');
+	if (elementType != NULL)
+	{
+		*elementType++ = '\0';
+		if (strcmp(elementType, "float64") == 0)
+		{
+			arguments->voxelFieldElementType = kVoxelFieldElementTypeFloat64;
+		}
+		else if (strcmp(elementType, "float32") != 0)
+		{
+			free(copy);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (*RsPath == '\0')
+	{
+		free(copy);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	arguments->isVoxelFieldMode = true;
+	arguments->voxelFieldPhiPath = copy;
+	arguments->voxelFieldRsPath = RsPath;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+runVoxelField(const CommandLineArguments *  arguments)
+{
+	VoxelFieldElementType	elementType = arguments->voxelFieldElementType;
+	size_t			elementSize = kVoxelFieldElementSizes[elementType];
+	size_t			numberOfSharedSamples = arguments->common.numberOfMonteCarloIterations;
+	VoxelFieldVolume	phiVolume = {0};
+	VoxelFieldVolume	RsVolume = {0};
+	VoxelFieldVolume	outputVolume = {0};
+	StreamingHistogram *	voxelHistograms;
+	StreamingHistogram *	voxelHistogram;
+	StreamingHistogram *	fieldHistogram;
+	double *		a;
+	double *		k;
+	double			meanA = 0.0;
+	double			meanAK = 0.0;
+	double			sumRoot = 0.0;
+	double			sumPhi = 0.0;
+	size_t			numberOfVoxels;
+	size_t			numberOfTiles;
+	size_t			numberOfThreads = 1;
+	clock_t			start = clock();
+	double			cpuTimeUsedInSeconds;
+
+	a = (double *) checkedMalloc(numberOfSharedSamples * sizeof(double), __FILE__, __LINE__);
+	k = (double *) checkedMalloc(numberOfSharedSamples * sizeof(double), __FILE__, __LINE__);
+	if ((drawVoxelFieldSharedSamples(arguments, a, k) != kCommonConstantReturnTypeSuccess) ||
+		(mapVoxelFieldInput(arguments->voxelFieldPhiPath, &phiVolume) != kCommonConstantReturnTypeSuccess) ||
+		(mapVoxelFieldInput(arguments->voxelFieldRsPath, &RsVolume) != kCommonConstantReturnTypeSuccess))
+	{
+		unmapVoxelFieldVolume(&phiVolume);
+		free(a);
+		free(k);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((phiVolume.mappingSize != RsVolume.mappingSize) || ((phiVolume.mappingSize % elementSize) != 0))
+	{
+		fprintf(stderr, "Error: The volumes \"%s\" and \"%s\" must have the same size, a multiple of %zu bytes.\n",
+			arguments->voxelFieldPhiPath, arguments->voxelFieldRsPath, elementSize);
+		unmapVoxelFieldVolume(&phiVolume);
+		unmapVoxelFieldVolume(&RsVolume);
+		free(a);
+		free(k);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (mapVoxelFieldOutput(arguments->common.outputFilePath, phiVolume.mappingSize, &outputVolume) != kCommonConstantReturnTypeSuccess)
+	{
+		unmapVoxelFieldVolume(&phiVolume);
+		unmapVoxelFieldVolume(&RsVolume);
+		free(a);
+		free(k);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The mean of σc over the shared samples is `⟨a k⟩ √(φ Rs) - ⟨a⟩ φ`, so each
+	 *	voxel costs one square root whatever the number of shared samples.
+	 */
+	for (size_t s = 0; s < numberOfSharedSamples; s++)
+	{
+		meanA += a[s];
+		meanAK += a[s] * k[s];
+	}
+	meanA /= numberOfSharedSamples;
+	meanAK /= numberOfSharedSamples;
+
+	numberOfVoxels = phiVolume.mappingSize / elementSize;
+	numberOfTiles = (numberOfVoxels + kVoxelFieldTileSize - 1) / kVoxelFieldTileSize;
+
+#ifdef _OPENMP
+	numberOfThreads = (size_t) omp_get_max_threads();
+#endif
+
+	/*
+	 *	One voxel histogram per thread, merged in thread order after the parallel
+	 *	region so that the summary does not depend on which thread finishes first.
+	 */
+	voxelHistograms = (StreamingHistogram *) checkedMalloc(numberOfThreads * sizeof(StreamingHistogram), __FILE__, __LINE__);
+	fieldHistogram = (StreamingHistogram *) checkedMalloc(sizeof(StreamingHistogram), __FILE__, __LINE__);
+	for (size_t t = 0; t < numberOfThreads; t++)
+	{
+		streamingHistogramInit(&voxelHistograms[t]);
+	}
+	streamingHistogramInit(fieldHistogram);
+
+	/*
+	 *	Tiles are whole pages of the volumes, so threads never write to the same page.
+	 */
+	#pragma omp parallel
+	{
+		size_t			threadIndex = 0;
+		double *		phi = (double *) checkedMalloc(3 * kVoxelFieldTileSize * sizeof(double), __FILE__, __LINE__);
+		double *		root = phi + kVoxelFieldTileSize;
+		double *		outputs = root + kVoxelFieldTileSize;
+		StreamingHistogram *	histogram;
+
+#ifdef _OPENMP
+		threadIndex = (size_t) omp_get_thread_num();
+#endif
+		histogram = &voxelHistograms[threadIndex];
+
+		#pragma omp for schedule(static) reduction(+:sumRoot, sumPhi)
+		for (size_t tile = 0; tile < numberOfTiles; tile++)
+		{
+			size_t	first = tile * kVoxelFieldTileSize;
+			size_t	count = (numberOfVoxels - first < kVoxelFieldTileSize) ? (numberOfVoxels - first) : kVoxelFieldTileSize;
+
+			loadVoxelTile(phiVolume.mapping, elementType, first, count, phi);
+			loadVoxelTile(RsVolume.mapping, elementType, first, count, root);
+
+			#pragma omp simd
+			for (size_t i = 0; i < count; i++)
+			{
+				root[i] = sqrt(phi[i] * root[i]);
+				outputs[i] = meanAK * root[i] - meanA * phi[i];
+			}
+
+			storeVoxelTile(outputVolume.mapping, elementType, first, count, outputs);
+			streamingHistogramAddArray(histogram, outputs, count);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				if (isfinite(outputs[i]))
+				{
+					sumRoot += root[i];
+					sumPhi += phi[i];
+				}
+			}
+		}
+
+		free(phi);
+	}
+
+	voxelHistogram = &voxelHistograms[0];
+	for (size_t t = 1; t < numberOfThreads; t++)
+	{
+		streamingHistogramMerge(voxelHistogram, &voxelHistograms[t]);
+	}
+
+	/*
+	 *	The average of σc over the voxels with a finite σc, for each shared sample.
+	 */
+	if (voxelHistogram->count > 0)
+	{
+		double	meanRoot = sumRoot / voxelHistogram->count;
+		double	meanPhi = sumPhi / voxelHistogram->count;
+
+		for (size_t s = 0; s < numberOfSharedSamples; s++)
+		{
+			streamingHistogramAdd(fieldHistogram, a[s] * (k[s] * meanRoot - meanPhi));
+		}
+	}
+
+	unmapVoxelFieldVolume(&phiVolume);
+	unmapVoxelFieldVolume(&RsVolume);
+	unmapVoxelFieldVolume(&outputVolume);
+
+	cpuTimeUsedInSeconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+	printf("Voxels: %zu, shared samples of the other inputs: %zu\n", numberOfVoxels, numberOfSharedSamples);
+	streamingHistogramPrintSummaryHeader(stdout, "sigmaCMpa", false);
+	streamingHistogramPrintSummaryRow(stdout, "voxel", voxelHistogram, false);
+	streamingHistogramPrintSummaryRow(stdout, "fieldAverage", fieldHistogram, false);
+
+	if (arguments->common.isTimingEnabled)
+	{
+		printf("CPU time used: %" SignaloidParticleModifier "lf seconds\n", cpuTimeUsedInSeconds);
+	}
+
+	free(voxelHistograms);
+	free(fieldHistogram);
+	free(a);
+	free(k);
+
+	return kCommonConstantReturnTypeSuccess;
+}
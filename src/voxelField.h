@@ -0,0 +1,59 @@
+/*
+ *	Copyright (c) 2022–2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "common.h"
+#include "utilities.h"
+
+
+/*
+ *	Number of voxels per tile. The `phi`, `Rs`, and output values of a tile take
+ *	96 KiB as doubles, which stays in the L2 cache.
+ */
+#define	kVoxelFieldTileSize	(4096)
+
+/**
+ *	@brief	Parse the argument of voxel mode, `<phi volume>:<Rs volume>[:float32|float64]`.
+ *
+ *	@param	string		: String to parse.
+ *	@param	arguments	: Pointer to struct that stores command-line arguments, whose
+ *				  voxel-mode fields are set.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	parseVoxelFieldArgument(const char *  string, CommandLineArguments *  arguments);
+
+/**
+ *	@brief	Evaluate the model for every voxel of raw volumes of `phi` and `Rs`, averaged over
+ *		`-M` samples of the other inputs that all voxels share, and write the results as a
+ *		raw volume of the same element type and layout to the output file. The volumes are
+ *		mapped into memory and processed in tiles of `kVoxelFieldTileSize` voxels across
+ *		threads. Prints the statistics of the voxel values and of the average over the
+ *		field for each shared sample.
+ *
+ *	@param	arguments	: Pointer to struct that stores command-line arguments.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	runVoxelField(const CommandLineArguments *  arguments);